@@ -0,0 +1,287 @@
+#ifndef WAVENET_BENCHMARK_H
+#define WAVENET_BENCHMARK_H
+
+/**
+ * @file   Benchmark.h
+ * @brief  Minimal, header-only harness for parameterised microbenchmarks.
+ */
+
+// STL include(s).
+#include <string> /* std::string */
+#include <vector> /* std::vector */
+#include <chrono> /* std::chrono::steady_clock */
+#include <functional> /* std::function */
+#include <fstream> /* std::ofstream */
+#include <iostream> /* std::cout */
+#include <sstream> /* std::stringstream */
+#include <algorithm> /* std::min, std::max */
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h" /* FCTINFO, FCTWARNING */
+
+/**
+ * Register a benchmark function, with signature 'void (bench::State&)', and the
+ * list of argument sets with which it should be run. E.g.
+ *
+ *   void myBenchmark (bench::State& state) {
+ *       // Setup, not timed.
+ *       while (state.keepRunning()) {
+ *           // Timed.
+ *       }
+ *   }
+ *   BENCHMARK(myBenchmark, bench::product({{2, 4}, {8, 16}}));
+ */
+#define BENCHMARK(fun, args) static bench::Registrar WAVENET_BENCH_CONCAT(registrar_, __LINE__) (#fun, fun, args)
+#define WAVENET_BENCH_CONCAT_(a, b) a ## b
+#define WAVENET_BENCH_CONCAT(a, b)  WAVENET_BENCH_CONCAT_(a, b)
+
+
+namespace bench {
+
+/// Utility function(s).
+/**
+ * Prevent the compiler from optimising away the computation of 'value'.
+ */
+template<class T>
+inline void doNotOptimize (const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * Powers of two, 2^{first}, ..., 2^{last}.
+ */
+inline std::vector<long> powersOfTwo (const unsigned& first, const unsigned& last) {
+    std::vector<long> values;
+    for (unsigned i = first; i <= last; i++) { values.push_back(1L << i); }
+    return values;
+}
+
+/**
+ * Cartesian product of lists of argument values.
+ */
+inline std::vector< std::vector<long> > product (const std::vector< std::vector<long> >& lists) {
+    std::vector< std::vector<long> > output = {{}};
+    for (const std::vector<long>& list : lists) {
+        std::vector< std::vector<long> > next;
+        for (const std::vector<long>& args : output) {
+            for (const long& value : list) {
+                next.push_back(args);
+                next.back().push_back(value);
+            }
+        }
+        output = next;
+    }
+    return output;
+}
+
+
+/**
+ * State passed to each benchmark function, controlling the timed loop.
+ */
+class State {
+
+public:
+
+    /// Constructor(s).
+    State (const std::vector<long>& args, const unsigned long long& iterations) :
+        m_args(args), m_iterations(iterations)
+    {};
+
+
+    /// Loop method(s).
+    // Returns true as long as the timed loop should continue. The timer is
+    // started on the first call, and stopped on the last.
+    inline bool keepRunning () {
+        if (m_count == 0) { m_start = std::chrono::steady_clock::now(); }
+        if (m_count++ < m_iterations) { return true; }
+        m_stop = std::chrono::steady_clock::now();
+        return false;
+    }
+
+
+    /// Get method(s).
+    // Returns the i'th argument.
+    inline long range (const unsigned& i) const { return m_args.at(i); }
+    // Returns all arguments.
+    inline const std::vector<long>& args () const { return m_args; }
+    // Returns the number of iterations of the timed loop.
+    inline unsigned long long iterations () const { return m_iterations; }
+    // Returns the time spent in the timed loop, in seconds.
+    inline double seconds () const { return std::chrono::duration<double>(m_stop - m_start).count(); }
+    // Returns the number of items processed per iteration.
+    inline double itemsPerIteration () const { return m_items; }
+
+
+    /// Set method(s).
+    // Set the number of items (e.g. matrix entries) processed per iteration,
+    // to report throughput.
+    inline void setItemsPerIteration (const double& items) { m_items = items; return; }
+
+
+private:
+
+    /// Data member(s).
+    std::vector<long> m_args;
+    unsigned long long m_iterations;
+    unsigned long long m_count = 0;
+    double m_items = 0;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_stop;
+
+};
+
+
+/**
+ * Single registered benchmark.
+ */
+struct Benchmark {
+    std::string name;
+    std::function<void(State&)> fun;
+    std::vector< std::vector<long> > args;
+};
+
+/**
+ * Result of running a benchmark for a single set of arguments.
+ */
+struct Result {
+    std::string name;
+    std::vector<long> args;
+    unsigned long long iterations;
+    double nsPerIteration;
+    double itemsPerSecond;
+};
+
+/**
+ * Global list of registered benchmarks.
+ */
+inline std::vector<Benchmark>& registry () {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+/**
+ * Helper class, registering a benchmark on construction.
+ */
+struct Registrar {
+    Registrar (const std::string& name, std::function<void(State&)> fun, const std::vector< std::vector<long> >& args) {
+        registry().push_back({name, fun, args});
+    }
+};
+
+/**
+ * Format a benchmark name with its arguments, e.g. 'name/16/4'.
+ */
+inline std::string fullName (const std::string& name, const std::vector<long>& args) {
+    std::string output = name;
+    for (const long& arg : args) { output += "/" + std::to_string(arg); }
+    return output;
+}
+
+/**
+ * Run a benchmark function for a single set of arguments. The number of
+ * iterations is increased until the timed loop runs for at least 'minTime'
+ * seconds.
+ */
+inline Result run (const Benchmark& benchmark, const std::vector<long>& args, const double& minTime) {
+    unsigned long long iterations = 1;
+    while (true) {
+        State state (args, iterations);
+        benchmark.fun(state);
+        const double seconds = state.seconds();
+        if (seconds >= minTime || iterations >= (1ULL << 30)) {
+            Result result;
+            result.name           = benchmark.name;
+            result.args           = args;
+            result.iterations     = iterations;
+            result.nsPerIteration = seconds * 1.0e9 / double(iterations);
+            result.itemsPerSecond = (seconds > 0 ? state.itemsPerIteration() * iterations / seconds : 0.);
+            return result;
+        }
+
+        // Estimate the number of iterations needed, with some margin.
+        const double scale = (seconds > 0 ? 1.4 * minTime / seconds : 10.);
+        iterations = (unsigned long long) std::max(double(iterations + 1), std::min(iterations * scale, iterations * 100.));
+    }
+}
+
+/**
+ * Main function of a benchmark executable. Accepts the command-line options:
+ *   --filter=<substring>      Only run benchmarks whose full name contains the
+ *                             substring.
+ *   --min-time=<seconds>      Minimal time of each timed loop (default: 0.1).
+ *   --format=<table|csv|json> Output format (default: table).
+ *   --out=<file>              Write the results to file instead of stdout.
+ */
+inline int main (int argc, char* argv[]) {
+
+    // Parse command-line options.
+    std::string filter = "";
+    std::string format = "table";
+    std::string out    = "";
+    double minTime     = 0.1;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if      (arg.find("--filter=")   == 0) { filter  = arg.substr(9); }
+        else if (arg.find("--min-time=") == 0) { minTime = std::stod(arg.substr(11)); }
+        else if (arg.find("--format=")   == 0) { format  = arg.substr(9); }
+        else if (arg.find("--out=")      == 0) { out     = arg.substr(6); }
+        else {
+            FCTWARNING("Unknown option '%s'.", arg.c_str());
+            return 1;
+        }
+    }
+
+    // Run benchmarks.
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : registry()) {
+        for (const std::vector<long>& args : benchmark.args) {
+            const std::string name = fullName(benchmark.name, args);
+            if (name.find(filter) == std::string::npos) { continue; }
+            results.push_back(run(benchmark, args, minTime));
+            if (format == "table" || !out.empty()) {
+                const Result& r = results.back();
+                FCTINFO("%-48s %12.0f ns %12llu it %12.3e items/s", name.c_str(), r.nsPerIteration, r.iterations, r.itemsPerSecond);
+            }
+        }
+    }
+    wavenet::Logger::flush();
+
+    // Write machine-readable output.
+    if (format == "table") { return 0; }
+    std::stringstream ss;
+    if (format == "csv") {
+        ss << "name,args,iterations,ns_per_iteration,items_per_second\n";
+        for (const Result& r : results) {
+            ss << r.name << "," << fullName("", r.args).substr(std::min<size_t>(1, r.args.size())) << ","
+               << r.iterations << "," << r.nsPerIteration << "," << r.itemsPerSecond << "\n";
+        }
+    } else if (format == "json") {
+        ss << "{\"benchmarks\": [\n";
+        for (unsigned i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            ss << "  {\"name\": \"" << fullName(r.name, r.args) << "\", \"args\": [";
+            for (unsigned j = 0; j < r.args.size(); j++) { ss << (j ? ", " : "") << r.args[j]; }
+            ss << "], \"iterations\": " << r.iterations
+               << ", \"ns_per_iteration\": " << r.nsPerIteration
+               << ", \"items_per_second\": " << r.itemsPerSecond << "}"
+               << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        ss << "]}\n";
+    } else {
+        FCTWARNING("Unknown format '%s'.", format.c_str());
+        return 1;
+    }
+
+    if (out.empty()) {
+        std::cout << ss.str();
+    } else {
+        std::ofstream stream (out);
+        stream << ss.str();
+    }
+
+    return 0;
+}
+
+} // namespace
+
+#endif // WAVENET_BENCHMARK_H
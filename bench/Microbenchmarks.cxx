@@ -0,0 +1,402 @@
+/**
+ * @file   Microbenchmarks.cxx
+ * @brief  Parameterised microbenchmarks of the core Wavenet kernels.
+ */
+
+// STL include(s).
+#include <string> /* std::string */
+#include <vector> /* std::vector */
+#include <cmath> /* log2 */
+#include <cstdio> /* remove */
+#include <thread> /* std::thread */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h" /* wavenet::PointOnNSphere */
+#include "Wavenet/LowpassOperator.h" /* wavenet::LowpassOperator */
+#include "Wavenet/HighpassOperator.h" /* wavenet::HighpassOperator */
+#include "Wavenet/CostFunctions.h" /* wavenet::SparseTerm, ... */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+#include "Wavenet/Snapshot.h" /* wavenet::Snapshot */
+#include "Wavenet/TransformPlan.h" /* wavenet::TransformPlan */
+#include "Wavenet/WavenetModel.h" /* wavenet::WavenetModel */
+#include "Wavenet/StreamingTransform.h" /* wavenet::StreamingTransform, ... */
+#include "Wavenet/TiledTransform.h" /* wavenet::TiledTransform */
+
+// Benchmark include(s).
+#include "Benchmark.h"
+
+/**
+ * Microbenchmarks of the core Wavenet kernels.
+ *
+ * Each benchmark is parametrised by the input size (the length of the signal,
+ * or the side of the square input matrix) and the number of filter
+ * coefficients, and reports the time per call along with the throughput in
+ * input entries per second. The sizes are swept over powers of two, 2^3 to 2^12,
+ * and the filter lengths over even numbers, 2 to 20. The 2D and backpropagation
+ * benchmarks are capped at smaller sizes, since the cached dense operators grow
+ * quadratically with the input size.
+ *
+ * Usage:
+ *   $ ./bin/bench/Microbenchmarks.exe [--filter=<substring>] [--min-time=<seconds>]
+ *                                     [--format=<table|csv|json>] [--out=<file>]
+ */
+
+
+/// Helper class(es).
+// Exposes the internal operator construction methods.
+template<class Operator>
+class ExposedOperator : public Operator {
+public:
+    ExposedOperator (const arma::Col<double>& filter, const unsigned& size) {
+        this->setSize(size);
+        this->setFilter(filter);
+        this->setComplete();
+    }
+    using Operator::constructByRows_;
+    using Operator::constructByIndices_;
+    using Operator::constructDirect_;
+};
+
+// Exposes the internal transform methods.
+class ExposedWavenet : public wavenet::Wavenet {
+public:
+    ExposedWavenet (const arma::Col<double>& filter) { setFilter(filter); }
+    using wavenet::Wavenet::forward_;
+    using wavenet::Wavenet::inverse_;
+    using wavenet::Wavenet::backpropagate_;
+};
+
+
+/// Argument list(s).
+const std::vector<long> filterLengths = {2, 4, 6, 8, 12, 16, 20};
+
+
+/// Operator construction.
+template<class Operator>
+void constructByRows (bench::State& state) {
+    const unsigned size = (unsigned) log2(state.range(0)) - 1;
+    ExposedOperator<Operator> op (wavenet::PointOnNSphere(state.range(1)), size);
+    state.setItemsPerIteration(state.range(0) * state.range(0) / 2.);
+    while (state.keepRunning()) {
+        op.constructByRows_();
+        bench::doNotOptimize(op);
+    }
+}
+BENCHMARK(constructByRows<wavenet::LowpassOperator>,  bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+BENCHMARK(constructByRows<wavenet::HighpassOperator>, bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+
+template<class Operator>
+void constructByIndices (bench::State& state) {
+    const unsigned size = (unsigned) log2(state.range(0)) - 1;
+    ExposedOperator<Operator> op (wavenet::PointOnNSphere(state.range(1)), size);
+    state.setItemsPerIteration(state.range(0) * state.range(0) / 2.);
+    while (state.keepRunning()) {
+        op.constructByIndices_();
+        bench::doNotOptimize(op);
+    }
+}
+BENCHMARK(constructByIndices<wavenet::LowpassOperator>,  bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+BENCHMARK(constructByIndices<wavenet::HighpassOperator>, bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+
+template<class Operator>
+void constructDirect (bench::State& state) {
+    const unsigned size = (unsigned) log2(state.range(0)) - 1;
+    ExposedOperator<Operator> op (wavenet::PointOnNSphere(state.range(1)), size);
+    state.setItemsPerIteration(state.range(0) * state.range(0) / 2.);
+    while (state.keepRunning()) {
+        op.constructDirect_();
+        bench::doNotOptimize(op);
+    }
+}
+BENCHMARK(constructDirect<wavenet::LowpassOperator>,  bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+BENCHMARK(constructDirect<wavenet::HighpassOperator>, bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+
+
+/// Transforms.
+void forward1D (bench::State& state) {
+    ExposedWavenet wn (wavenet::PointOnNSphere(state.range(1)));
+    const arma::Col<double> x (state.range(0), arma::fill::randn);
+    wn.forward_(x); // Cache operators.
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wn.forward_(x));
+    }
+}
+BENCHMARK(forward1D, bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+
+void inverse1D (bench::State& state) {
+    ExposedWavenet wn (wavenet::PointOnNSphere(state.range(1)));
+    const arma::Col<double> y (state.range(0), arma::fill::randn);
+    wn.inverse_(y); // Cache operators.
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wn.inverse_(y));
+    }
+}
+BENCHMARK(inverse1D, bench::product({bench::powersOfTwo(3, 12), filterLengths}));
+
+void forward2D (bench::State& state) {
+    ExposedWavenet wn (wavenet::PointOnNSphere(state.range(1)));
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    wn.forward_(X); // Cache operators.
+    state.setItemsPerIteration(X.n_elem);
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wn.forward_(X));
+    }
+}
+BENCHMARK(forward2D, bench::product({bench::powersOfTwo(3, 9), filterLengths}));
+
+void inverse2D (bench::State& state) {
+    ExposedWavenet wn (wavenet::PointOnNSphere(state.range(1)));
+    const arma::Mat<double> Y (state.range(0), state.range(0), arma::fill::randn);
+    wn.inverse_(Y); // Cache operators.
+    state.setItemsPerIteration(Y.n_elem);
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wn.inverse_(Y));
+    }
+}
+BENCHMARK(inverse2D, bench::product({bench::powersOfTwo(3, 9), filterLengths}));
+
+void backpropagate1D (bench::State& state) {
+    ExposedWavenet wn (wavenet::PointOnNSphere(state.range(1)));
+    const arma::Col<double> x (state.range(0), arma::fill::randn);
+    const Activations1D_t activations = wn.forward_(x);
+    const arma::Col<double> delta = wavenet::SparseTermDeriv(wavenet::coeffsFromActivations(activations));
+    wn.backpropagate_(delta, activations); // Cache weights.
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wn.backpropagate_(delta, activations));
+    }
+}
+BENCHMARK(backpropagate1D, bench::product({bench::powersOfTwo(3, 10), filterLengths}));
+
+void backpropagate2D (bench::State& state) {
+    ExposedWavenet wn (wavenet::PointOnNSphere(state.range(1)));
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    const Activations2D_t activations = wn.forward_(X);
+    const arma::Mat<double> Delta = wavenet::SparseTermDeriv(wavenet::coeffsFromActivations(activations));
+    wn.backpropagate_(Delta, activations); // Cache weights.
+    state.setItemsPerIteration(X.n_elem);
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wn.backpropagate_(Delta, activations));
+    }
+}
+BENCHMARK(backpropagate2D, bench::product({bench::powersOfTwo(3, 7), filterLengths}));
+
+
+/// Transform plans.
+void planForward2D (bench::State& state) {
+    wavenet::TransformPlan plan ({(unsigned) state.range(0), (unsigned) state.range(0)}, state.range(1));
+    plan.setFilter(wavenet::PointOnNSphere(state.range(1)));
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    arma::Mat<double> Y;
+    state.setItemsPerIteration(X.n_elem);
+    while (state.keepRunning()) {
+        plan.forward(X, Y);
+        bench::doNotOptimize(Y);
+    }
+}
+BENCHMARK(planForward2D, bench::product({bench::powersOfTwo(3, 10), filterLengths}));
+
+void planInverse2D (bench::State& state) {
+    wavenet::TransformPlan plan ({(unsigned) state.range(0), (unsigned) state.range(0)}, state.range(1), wavenet::TransformPlan::Mode::Transform);
+    plan.setFilter(wavenet::PointOnNSphere(state.range(1)));
+    const arma::Mat<double> Y (state.range(0), state.range(0), arma::fill::randn);
+    arma::Mat<double> X;
+    state.setItemsPerIteration(Y.n_elem);
+    while (state.keepRunning()) {
+        plan.inverse(Y, X);
+        bench::doNotOptimize(X);
+    }
+}
+BENCHMARK(planInverse2D, bench::product({bench::powersOfTwo(3, 10), filterLengths}));
+
+void planBackward2D (bench::State& state) {
+    wavenet::TransformPlan plan ({(unsigned) state.range(0), (unsigned) state.range(0)}, state.range(1));
+    plan.setFilter(wavenet::PointOnNSphere(state.range(1)));
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    arma::Mat<double> Y;
+    plan.forward(X, Y);
+    const arma::Mat<double> Delta = wavenet::SparseTermDeriv(Y);
+    arma::Col<double> gradient;
+    state.setItemsPerIteration(X.n_elem);
+    while (state.keepRunning()) {
+        plan.backward(Delta, gradient);
+        bench::doNotOptimize(gradient);
+    }
+}
+BENCHMARK(planBackward2D, bench::product({bench::powersOfTwo(3, 10), filterLengths}));
+
+// Forward and backward pass with checkpointing, for checkpoint intervals 1 (all
+// activations stored), 2, 4, and 0 (input only).
+void planCheckpoint2D (bench::State& state) {
+    wavenet::TransformPlan plan ({(unsigned) state.range(0), (unsigned) state.range(0)}, 8, wavenet::TransformPlan::Mode::Train, state.range(1));
+    plan.setFilter(wavenet::PointOnNSphere(8));
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    arma::Mat<double> Y;
+    plan.forward(X, Y);
+    const arma::Mat<double> Delta = wavenet::SparseTermDeriv(Y);
+    arma::Col<double> gradient;
+    state.setItemsPerIteration(X.n_elem);
+    while (state.keepRunning()) {
+        plan.forward(X, Y);
+        plan.backward(Delta, gradient);
+        bench::doNotOptimize(gradient);
+    }
+}
+BENCHMARK(planCheckpoint2D, bench::product({bench::powersOfTwo(6, 11), {1, 2, 4, 0}}));
+
+// Forward and backward pass reconstructing the activations from the wavelet
+// coefficients, using an orthonormal (Daubechies) filter.
+void planInvertible2D (bench::State& state) {
+    wavenet::TransformPlan plan ({(unsigned) state.range(0), (unsigned) state.range(0)}, 4, wavenet::TransformPlan::Mode::Invertible);
+    plan.setFilter(arma::Col<double>({0.48296291314469025, 0.83651630373746899, 0.22414386804185735, -0.12940952255092145}));
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    arma::Mat<double> Y;
+    plan.forward(X, Y);
+    const arma::Mat<double> Delta = wavenet::SparseTermDeriv(Y);
+    arma::Col<double> gradient;
+    state.setItemsPerIteration(X.n_elem);
+    while (state.keepRunning()) {
+        plan.forward(X, Y);
+        plan.backward(Y, Delta, gradient);
+        bench::doNotOptimize(gradient);
+    }
+}
+BENCHMARK(planInvertible2D, bench::product({bench::powersOfTwo(6, 11)}));
+
+// Concurrent inference: each of the given number of threads transforms one
+// input matrix per iteration, using a single, shared model.
+void modelTransform2D (bench::State& state) {
+    const wavenet::WavenetModel model (wavenet::PointOnNSphere(8), {(unsigned) state.range(0), (unsigned) state.range(0)});
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    state.setItemsPerIteration(X.n_elem * state.range(1));
+    while (state.keepRunning()) {
+        std::vector<std::thread> threads;
+        for (long t = 0; t < state.range(1); t++) {
+            threads.emplace_back([&model, &X] () {
+                arma::Mat<double> Y = model.transform(X);
+                bench::doNotOptimize(Y);
+            });
+        }
+        for (std::thread& thread : threads) { thread.join(); }
+    }
+}
+BENCHMARK(modelTransform2D, bench::product({bench::powersOfTwo(5, 10), {1, 8, 48}}));
+
+
+/// Streaming transforms.
+// Push a chunk of samples to the streaming transform, and the resulting
+// coefficients to the streaming inverse, for a number of levels.
+void streamingChunk (bench::State& state) {
+    const arma::Col<double> filter = wavenet::PointOnNSphere(8);
+    wavenet::StreamingTransform transform (filter, state.range(1));
+    wavenet::StreamingInverse   inverse   (filter, state.range(1));
+    const arma::Col<double> chunk (state.range(0), arma::fill::randn);
+    std::vector<wavenet::StreamingCoefficient> coefficients;
+    std::vector<double> samples;
+    state.setItemsPerIteration(chunk.n_elem);
+    while (state.keepRunning()) {
+        coefficients.clear();
+        samples.clear();
+        transform.push(chunk, coefficients);
+        inverse.push(coefficients, samples);
+        bench::doNotOptimize(samples);
+    }
+}
+BENCHMARK(streamingChunk, bench::product({bench::powersOfTwo(6, 12), {4, 8}}));
+
+/// Tiled transforms.
+// Forward transform a large image in tiles of 64 x 64, with three levels per
+// tile, for a number of threads.
+void tiledTransform2D (bench::State& state) {
+    wavenet::TiledTransform transform (wavenet::PointOnNSphere(8), 64, 3);
+    transform.setNumThreads(state.range(1));
+    const arma::Mat<double> X (state.range(0), state.range(0), arma::fill::randn);
+    arma::Mat<double> Y;
+    state.setItemsPerIteration(X.n_elem);
+    while (state.keepRunning()) {
+        transform.forward(X, Y);
+        bench::doNotOptimize(Y);
+    }
+}
+BENCHMARK(tiledTransform2D, bench::product({bench::powersOfTwo(9, 12), {1, 8, 48}}));
+
+/// Cost functions.
+void sparseTerm (bench::State& state) {
+    const arma::Col<double> c (state.range(0), arma::fill::randn);
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wavenet::SparseTerm(c));
+    }
+}
+BENCHMARK(sparseTerm, bench::product({bench::powersOfTwo(3, 12)}));
+
+void sparseTermDeriv (bench::State& state) {
+    const arma::Col<double> c (state.range(0), arma::fill::randn);
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wavenet::SparseTermDeriv(c));
+    }
+}
+BENCHMARK(sparseTermDeriv, bench::product({bench::powersOfTwo(3, 12)}));
+
+void regTerm (bench::State& state) {
+    const arma::Col<double> a = wavenet::PointOnNSphere(state.range(0));
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wavenet::RegTerm(a));
+    }
+}
+BENCHMARK(regTerm, bench::product({filterLengths}));
+
+void regTermDeriv (bench::State& state) {
+    const arma::Col<double> a = wavenet::PointOnNSphere(state.range(0));
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        bench::doNotOptimize(wavenet::RegTermDeriv(a));
+    }
+}
+BENCHMARK(regTermDeriv, bench::product({filterLengths}));
+
+
+/// Snapshots.
+// The argument is the number of entries in the filter log, which dominates the
+// size of the snapshot.
+void snapshotSave (bench::State& state) {
+    wavenet::Wavenet wn;
+    wn.setFilter(wavenet::PointOnNSphere(16));
+    for (long i = 0; i < state.range(0); i++) { wn.filterLog().push_back(wn.filter()); }
+    wavenet::Snapshot snap ("bench_snapshot.dat");
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        wn.save(snap);
+    }
+    std::remove(snap.file().c_str());
+}
+BENCHMARK(snapshotSave, bench::product({bench::powersOfTwo(3, 12)}));
+
+void snapshotLoad (bench::State& state) {
+    wavenet::Wavenet wn;
+    wn.setFilter(wavenet::PointOnNSphere(16));
+    for (long i = 0; i < state.range(0); i++) { wn.filterLog().push_back(wn.filter()); }
+    wavenet::Snapshot snap ("bench_snapshot.dat");
+    wn.save(snap);
+    state.setItemsPerIteration(state.range(0));
+    while (state.keepRunning()) {
+        wavenet::Wavenet other;
+        other.load(snap);
+        bench::doNotOptimize(other);
+    }
+    std::remove(snap.file().c_str());
+}
+BENCHMARK(snapshotLoad, bench::product({bench::powersOfTwo(3, 12)}));
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return bench::main(argc, argv);
+}
@@ -0,0 +1,446 @@
+/**
+ * @file   Training.cxx
+ * @brief  End-to-end training benchmark, with comparison to a stored baseline.
+ */
+
+// STL include(s).
+#include <string> /* std::string */
+#include <vector> /* std::vector */
+#include <map> /* std::map */
+#include <fstream> /* std::ifstream, std::ofstream */
+#include <cstdlib> /* strtod */
+#include <cstdio> /* std::remove */
+#include <cstring> /* strerror */
+#include <algorithm> /* std::max, std::find_if */
+#include <cmath> /* std::abs, std::isfinite */
+#include <limits> /* std::numeric_limits */
+#include <memory> /* std::unique_ptr */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h" /* FCTINFO, FCTWARNING */
+#include "Wavenet/Generators.h" /* wavenet::NeedleGenerator, ... */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+#include "Wavenet/Coach.h" /* wavenet::Coach */
+
+/**
+ * End-to-end training benchmark.
+ *
+ * Runs the Coach on fixed-seed needle, gaussian, and CSV input at several
+ * shapes, and reports for each case the throughput (examples per second) and
+ * the time-to-target-cost. The target cost of each case is fixed, and stored in
+ * the baseline: it is set, when the case is first added to the baseline, to
+ * the cost at which 90% of the total reduction in (smoothed) cost has been 
+ * achieved, and kept when the baseline is updated. The time at which the 
+ * smoothed cost reaches the target is estimated from the number of updates 
+ * needed, assuming constant throughput during the training. Changes which 
+ * slow down the convergence thus increase the time-to-target, even if the 
+ * throughput is unchanged.
+ *
+ * The results are compared to a baseline JSON file. A case is flagged if the
+ * throughput drops, or the time-to-target grows, by more than the relative
+ * tolerance, or if the final filter coefficients differ from the baseline by
+ * more than the filter tolerance, such that optimisations which silently change
+ * the results of the training are caught. Since the order of the updates of 
+ * cases trained asynchronously by several workers (@see Coach::setNumWorkers)
+ * depends on the scheduling of the threads, their final filter coefficients 
+ * are not compared. Instead, their final (smoothed) cost is compared to that 
+ * of the synchronous case on the same input, and flagged if it differs by more
+ * than the relative asynchronous tolerance.
+ * If the baseline file doesn't exist, or with --update-baseline, the current
+ * results are merged into the baseline: the cases which were run replace 
+ * their entries, and the entries of the remaining cases (e.g. with --filter)
+ * are kept. Since throughput depends on the machine, the throughput and 
+ * time-to-target should be compared to a baseline generated on the same
+ * machine. The target costs, final costs, and final filter coefficients don't
+ * depend on the machine; a baseline holding only these, which can be shared
+ * between machines, is written with --reference-only. The throughput and
+ * time-to-target of cases in such a baseline are not compared.
+ *
+ * Usage:
+ *   $ ./bin/bench/Training.exe [--baseline=<file>] [--update-baseline] [--reference-only]
+ *                              [--tolerance=<relative>] [--filter-tolerance=<absolute>]
+ *                              [--async-tolerance=<relative>]
+ *                              [--filter=<substring>] [--out=<file>]
+ *
+ * Returns 0 if no regressions were found, and 1 otherwise.
+ */
+
+
+/// Benchmark configuration(s).
+struct Case {
+    std::string name;
+    std::string generator; // "needle", "gaussian", or "csv".
+    std::vector<unsigned> shape;
+    unsigned numCoeffs;
+    int numEvents;
+    unsigned numWorkers;
+    std::string reference; // Synchronous case on the same input, if any.
+};
+
+struct Result {
+    std::string name;
+    double examplesPerSecond = 0;
+    double timeToTarget = 0;
+    double targetCost = 0;
+    double finalCost = 0;
+    arma::Col<double> filter;
+    bool deterministic = true;
+    bool timed = true; // Whether the throughput and time-to-target are set.
+    std::string reference;
+
+    // Smoothed cost log, the number of updates averaged in each entry, and 
+    // the time per update, from which the time-to-target is computed.
+    std::vector<double> smooth;
+    unsigned window = 1;
+    double secondsPerUpdate = 0;
+};
+
+const std::vector<Case> cases = {
+    {"needle-64",            "needle",   {64},     4, 2000, 1, ""},
+    {"needle-16x16",         "needle",   {16, 16}, 4,  500, 1, ""},
+    {"needle-64x64",         "needle",   {64, 64}, 8,  100, 1, ""},
+    {"gaussian-64",          "gaussian", {64},     4, 2000, 1, ""},
+    {"gaussian-32x32",       "gaussian", {32, 32}, 4,  300, 1, ""},
+    {"gaussian-32x32-async", "gaussian", {32, 32}, 4,  300, 4, "gaussian-32x32"},
+    {"csv-64",               "csv",      {64},     4, 2000, 1, ""},
+};
+
+// Seed used for both the generators and the initial filter coefficients.
+const int seed = 42;
+
+
+/// Helper function(s).
+// Write a reproducible CSV input file, with needle-like signals on top of
+// low-level gaussian noise.
+bool writeCSV (const std::string& filename, const unsigned& length, const unsigned& lines) {
+    arma::arma_rng::set_seed(seed);
+    std::ofstream stream (filename);
+    if (!stream.good()) { return false; }
+    for (unsigned i = 0; i < lines; i++) {
+        arma::Col<double> x = arma::randn< arma::Col<double> >(length) * 0.01;
+        x((unsigned) (arma::as_scalar(arma::randu(1)) * length) % length) += 1.;
+        for (unsigned j = 0; j < length; j++) {
+            stream << (j ? "," : "") << x(j);
+        }
+        stream << "\n";
+    }
+    return true;
+}
+
+// Time at which the smoothed cost of a run first reaches the target cost. 
+// Infinite if the target cost isn't reached.
+double timeToTarget (const Result& result, const double& target) {
+    for (unsigned i = 0; i < result.smooth.size(); i++) {
+        if (result.smooth[i] <= target) { return result.secondsPerUpdate * double(i + result.window); }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+// Run the training for a single benchmark case. The target cost is set from
+// the run, to be replaced by that of the baseline, if any.
+bool run (const Case& c, Result& result) {
+
+    // Configure generator.
+    const std::string filename = "bench_" + c.name + ".csv";
+    std::unique_ptr<wavenet::GeneratorBase> generator;
+    if (c.generator == "needle") {
+        generator.reset(new wavenet::NeedleGenerator());
+        generator->setShape(c.shape);
+    } else if (c.generator == "gaussian") {
+        generator.reset(new wavenet::GaussianGenerator());
+        generator->setShape(c.shape);
+    } else if (c.generator == "csv") {
+        if (!writeCSV(filename, c.shape[0], c.numEvents)) {
+            FCTWARNING("Could not write input file '%s'.", filename.c_str());
+            return false;
+        }
+        generator.reset(new wavenet::CSVGenerator({filename}));
+    } else {
+        FCTWARNING("Generator '%s' not recognised.", c.generator.c_str());
+        return false;
+    }
+    generator->setSeed(seed);
+
+    // Configure wavenet and coach.
+    wavenet::Wavenet wn;
+    wavenet::Coach coach ("bench-" + c.name);
+    coach.setGenerator(generator.get());
+    coach.setWavenet(&wn);
+    coach.setNumEvents(c.numEvents);
+    coach.setNumCoeffs(c.numCoeffs);
+    coach.setPrintLevel(0);
+    coach.setSeed(seed);
+    coach.setNumWorkers(c.numWorkers);
+
+    // Run the training.
+    if (!coach.run()) { return false; }
+
+    // Compute the smoothed cost log.
+    const std::vector<double>& costLog = wn.costLog();
+    const unsigned window = std::max(1u, unsigned(costLog.size() / 20));
+    std::vector<double> smooth;
+    double sum = 0;
+    for (unsigned i = 0; i < costLog.size(); i++) {
+        sum += costLog[i];
+        if (i >= window) { sum -= costLog[i - window]; }
+        if (i + 1 >= window) { smooth.push_back(sum / window); }
+    }
+    if (smooth.empty()) {
+        FCTWARNING("No updates were performed for case '%s'.", c.name.c_str());
+        return false;
+    }
+
+    // Store results.
+    const wavenet::Metrics& metrics = wn.metrics();
+    result.name              = c.name;
+    result.examplesPerSecond = metrics.examplesPerSecond();
+    result.smooth            = smooth;
+    result.window            = window;
+    result.secondsPerUpdate  = metrics.elapsed() / double(costLog.size());
+    result.targetCost        = smooth.front() - 0.9 * (smooth.front() - smooth.back());
+    result.timeToTarget      = timeToTarget(result, result.targetCost);
+    result.finalCost         = smooth.back();
+    result.filter            = wn.filter();
+    result.deterministic     = (c.numWorkers == 1);
+    result.reference         = c.reference;
+
+    // Clean up.
+    if (c.generator == "csv") { std::remove(filename.c_str()); }
+
+    return true;
+}
+
+// Read a number following '"key": ' in a line of JSON. Returns false if the key
+// isn't present.
+bool readNumber (const std::string& line, const std::string& key, double& value) {
+    const std::size_t pos = line.find("\"" + key + "\": ");
+    if (pos == std::string::npos) { return false; }
+    value = strtod(line.c_str() + pos + key.size() + 4, nullptr);
+    return true;
+}
+
+// Read an array of numbers following '"key": ' in a line of JSON. Returns false
+// if the key isn't present.
+bool readArray (const std::string& line, const std::string& key, arma::Col<double>& values) {
+    const std::size_t pos = line.find("\"" + key + "\": [");
+    if (pos == std::string::npos) { return false; }
+    std::vector<double> entries;
+    const char* ptr = line.c_str() + pos + key.size() + 5;
+    char* end = nullptr;
+    while (true) {
+        const double value = strtod(ptr, &end);
+        if (end == ptr) { break; }
+        entries.push_back(value);
+        ptr = end;
+        while (*ptr == ',' || *ptr == ' ') { ptr++; }
+    }
+    values = arma::Col<double>(entries);
+    return true;
+}
+
+// Read the baseline results, written by 'writeResults', one case per line.
+std::map<std::string, Result> readResults (const std::string& filename) {
+    std::map<std::string, Result> results;
+    std::ifstream stream (filename);
+    std::string line;
+    while (std::getline(stream, line)) {
+        const std::size_t pos = line.find("\"name\": \"");
+        if (pos == std::string::npos) { continue; }
+        Result result;
+        result.name = line.substr(pos + 9, line.find("\"", pos + 9) - pos - 9);
+        result.timed = (readNumber(line, "examples_per_s",   result.examplesPerSecond) &&
+                        readNumber(line, "time_to_target_s", result.timeToTarget));
+        if (!readNumber(line, "target_cost", result.targetCost)) {
+            result.targetCost = std::numeric_limits<double>::quiet_NaN();
+        }
+        readNumber(line, "final_cost", result.finalCost);
+        readArray (line, "filter",     result.filter);
+        results[result.name] = result;
+    }
+    return results;
+}
+
+// Write results to JSON file, one case per line. With 'referenceOnly', the
+// machine-dependent throughput and time-to-target are omitted.
+bool writeResults (const std::string& filename, const std::vector<Result>& results, const bool& referenceOnly = false) {
+    std::ofstream stream (filename);
+    if (!stream.good()) { return false; }
+    stream.precision(17);
+    stream << "{\"cases\": [\n";
+    for (unsigned i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        stream << "  {\"name\": \"" << r.name << "\", ";
+        if (r.timed && !referenceOnly) {
+            stream << "\"examples_per_s\": "   << r.examplesPerSecond << ", "
+                   << "\"time_to_target_s\": " << r.timeToTarget      << ", ";
+        }
+        stream << "\"target_cost\": "      << r.targetCost        << ", "
+               << "\"final_cost\": "       << r.finalCost         << ", "
+               << "\"filter\": [";
+        for (unsigned j = 0; j < r.filter.n_elem; j++) { stream << (j ? ", " : "") << r.filter(j); }
+        stream << "]}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    stream << "]}\n";
+    return true;
+}
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+
+    // Parse command-line options.
+    std::string baseline   = "bench/baseline/Training.json";
+    std::string filter     = "";
+    std::string out        = "";
+    bool   updateBaseline  = false;
+    bool   referenceOnly   = false;
+    double tolerance       = 0.2;
+    double filterTolerance = 1.0e-6;
+    double asyncTolerance  = 0.2;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if      (arg.find("--baseline=")         == 0) { baseline        = arg.substr(11); }
+        else if (arg.find("--update-baseline")   == 0) { updateBaseline  = true; }
+        else if (arg.find("--reference-only")    == 0) { referenceOnly   = true; }
+        else if (arg.find("--tolerance=")        == 0) { tolerance       = std::stod(arg.substr(12)); }
+        else if (arg.find("--filter-tolerance=") == 0) { filterTolerance = std::stod(arg.substr(19)); }
+        else if (arg.find("--async-tolerance=")  == 0) { asyncTolerance  = std::stod(arg.substr(18)); }
+        else if (arg.find("--filter=")           == 0) { filter          = arg.substr(9); }
+        else if (arg.find("--out=")              == 0) { out             = arg.substr(6); }
+        else {
+            FCTWARNING("Unknown option '%s'.", arg.c_str());
+            return 1;
+        }
+    }
+
+    // Suppress the per-run output of the coach.
+    wavenet::Logger::setGlobalLevel(WAVENET_LEVEL_WARNING);
+
+    // Run benchmarks.
+    std::vector<Result> results;
+    for (const Case& c : cases) {
+        if (c.name.find(filter) == std::string::npos) { continue; }
+        Result result;
+        if (!run(c, result)) {
+            FCTWARNING("Case '%s' failed.", c.name.c_str());
+            return 1;
+        }
+        results.push_back(result);
+    }
+
+    // Run the synchronous reference cases of the selected asynchronous cases,
+    // unless already selected themselves.
+    std::map<std::string, Result> synchronous;
+    for (const Result& r : results) {
+        if (!r.reference.empty()) { synchronous[r.reference] = Result(); }
+    }
+    for (const Case& c : cases) {
+        if (!synchronous.count(c.name)) { continue; }
+        auto it = std::find_if(results.begin(), results.end(), [&] (const Result& r) { return r.name == c.name; });
+        if (it != results.end()) {
+            synchronous[c.name] = *it;
+        } else if (!run(c, synchronous[c.name])) {
+            FCTWARNING("Case '%s' failed.", c.name.c_str());
+            return 1;
+        }
+    }
+    wavenet::Logger::setGlobalLevel(WAVENET_LEVEL_VERBOSE);
+
+    // Read the baseline, if any, and use its target costs, which are kept 
+    // fixed, also when updating the baseline.
+    const bool exists = wavenet::fileExists(baseline);
+    const std::map<std::string, Result> stored = (exists ? readResults(baseline) : std::map<std::string, Result>());
+    for (Result& r : results) {
+        auto it = stored.find(r.name);
+        if (it != stored.end() && std::isfinite(it->second.targetCost)) {
+            r.targetCost   = it->second.targetCost;
+            r.timeToTarget = timeToTarget(r, r.targetCost);
+        }
+    }
+
+    // Compare to baseline.
+    const bool haveBaseline = exists && !updateBaseline;
+    const std::map<std::string, Result> reference = (haveBaseline ? stored : std::map<std::string, Result>());
+    unsigned regressions = 0;
+    FCTINFO("%-16s %14s %14s %12s %12s  %s", "case", "examples/s", "baseline", "t_target [s]", "baseline", "filter");
+    for (const Result& r : results) {
+        auto it = reference.find(r.name);
+        if (it == reference.end()) {
+            FCTINFO("%-16s %14.1f %14s %12.3f %12s  %s", r.name.c_str(), r.examplesPerSecond, "-", r.timeToTarget, "-", "-");
+            continue;
+        }
+        const Result& b = it->second;
+
+        // Check throughput and time-to-target, unless the baseline only holds
+        // the machine-independent results, and final filter coefficients.
+        const bool reached = std::isfinite(r.timeToTarget);
+        const bool slower  = b.timed && r.examplesPerSecond < (1. - tolerance) * b.examplesPerSecond;
+        const bool later   = (b.timed && r.timeToTarget > (1. + tolerance) * b.timeToTarget) || !reached;
+        const bool changed = r.deterministic && (r.filter.n_elem != b.filter.n_elem ||
+                             arma::max(arma::abs(r.filter - b.filter)) > filterTolerance);
+
+        if (b.timed) {
+            FCTINFO("%-16s %14.1f %14.1f %12.3f %12.3f  %s", r.name.c_str(), r.examplesPerSecond, b.examplesPerSecond,
+                    r.timeToTarget, b.timeToTarget, changed ? "CHANGED" : "ok");
+        } else {
+            FCTINFO("%-16s %14.1f %14s %12.3f %12s  %s", r.name.c_str(), r.examplesPerSecond, "-",
+                    r.timeToTarget, "-", changed ? "CHANGED" : "ok");
+        }
+        if (slower)  { FCTWARNING("Case '%s': throughput dropped by %.1f%%.", r.name.c_str(), 100. * (1. - r.examplesPerSecond / b.examplesPerSecond)); }
+        if (!reached) {
+            FCTWARNING("Case '%s': target cost %.4e not reached (final cost %.4e).", r.name.c_str(), r.targetCost, r.finalCost);
+        } else if (later) {
+            FCTWARNING("Case '%s': time-to-target grew by %.1f%%.", r.name.c_str(), 100. * (r.timeToTarget / b.timeToTarget - 1.));
+        }
+        if (changed) { FCTWARNING("Case '%s': final filter differs from the baseline.", r.name.c_str()); }
+        regressions += (slower || later || changed);
+    }
+
+    // Compare the final cost of asynchronous cases to that of the synchronous
+    // case on the same input.
+    for (const Result& r : results) {
+        if (r.reference.empty()) { continue; }
+        const Result& sync = synchronous.at(r.reference);
+        const double difference = std::abs(r.finalCost - sync.finalCost) / std::abs(sync.finalCost);
+        const bool   diverged   = !(difference <= asyncTolerance);
+        FCTINFO("%-16s final cost %.4e vs. %.4e for synchronous case '%s'  %s", r.name.c_str(), r.finalCost,
+                sync.finalCost, sync.name.c_str(), diverged ? "DIFFERS" : "ok");
+        if (diverged) { FCTWARNING("Case '%s': final cost differs from the synchronous case by %.1f%%.", r.name.c_str(), 100. * difference); }
+        regressions += diverged;
+    }
+
+    // Write results, merged into the existing baseline, in the order of the
+    // cases, followed by any entries of cases no longer run.
+    if (!haveBaseline) {
+        FCTINFO("Writing results to baseline '%s'.", baseline.c_str());
+        const std::string dir = baseline.substr(0, baseline.find_last_of("/"));
+        if (baseline.find("/") != std::string::npos && !wavenet::makeDir(dir)) {
+            FCTERROR("Failed to create directory '%s': %s.", dir.c_str(), strerror(errno));
+            return 1;
+        }
+        std::map<std::string, Result> merged = stored;
+        for (const Result& r : results) { merged[r.name] = r; }
+        std::vector<Result> ordered;
+        for (const Case& c : cases) {
+            auto it = merged.find(c.name);
+            if (it == merged.end()) { continue; }
+            ordered.push_back(it->second);
+            merged.erase(it);
+        }
+        for (const auto& entry : merged) { ordered.push_back(entry.second); }
+        writeResults(baseline, ordered, referenceOnly);
+    }
+    if (!out.empty()) {
+        writeResults(out, results);
+    }
+
+    if (regressions) {
+        FCTWARNING("Found regressions in %d case(s).", regressions);
+    }
+    wavenet::Logger::flush();
+
+    return regressions ? 1 : 0;
+}
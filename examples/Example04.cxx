@@ -0,0 +1,116 @@
+/**
+ * @file   Example04.cxx
+ * @brief  Distributed, data-parallel training on localhost.
+ */
+
+// STL include(s).
+#include <string> /* std::string, std::stoi */
+#include <vector> /* std::vector */
+
+// POSIX include(s).
+#include <unistd.h> /* fork */
+#include <sys/wait.h> /* waitpid */
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h" /* FCTINFO, FCTERROR */
+#include "Wavenet/Generators.h" /* wavenet::NeedleGenerator */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+#include "Wavenet/Coach.h" /* wavevent::Coach */
+#include "Wavenet/Communicator.h" /* wavenet::Communicator */
+
+/**
+ * Print the header of the example.
+ */
+void header () {
+    FCTINFO("===========================================================");
+    FCTINFO("Running Wavenet Example04.");
+    FCTINFO("-----------------------------------------------------------");
+    return;
+}
+
+/**
+ * Train as one rank of a distributed run, returning 0 on success.
+ */
+int train (const unsigned& rank, const std::vector<std::string>& addresses) {
+
+    // Connect to the other ranks.
+    wavenet::Communicator communicator (rank, addresses);
+    if (!communicator.initialised()) { return 1; }
+
+    // Each rank has its own shard of the input; here, a differently seeded
+    // NeedleGenerator.
+    wavenet::NeedleGenerator ng;
+    ng.setShape({16,16});
+    ng.setSeed(1000 + rank);
+
+    wavenet::Wavenet wn;
+
+    // Only rank 0 writes the output. The batches of all ranks are combined,
+    // such that the effective batch size is that of each rank times the number
+    // of ranks.
+    wavenet::Coach coach ("Example04");
+    coach.setGenerator   (&ng);
+    coach.setWavenet     (&wn);
+    coach.setCommunicator(&communicator);
+    coach.setNumCoeffs(4);
+    coach.setNumEvents(1024);
+    coach.setPrintLevel(rank == 0 ? 2 : 0);
+
+    return coach.run() ? 0 : 1;
+}
+
+/**
+ * Example04: Distributed, data-parallel training on localhost.
+ *
+ * Requirements: None
+ *
+ * This example shows how to train a single wavenet using several processes
+ * (ranks), each of which has its own generator, connected in a ring by a
+ * Communicator. The batch gradients are averaged over all ranks before each
+ * update, such that the wavenets on all ranks stay identical.
+ *
+ * Run as
+ *   $ ./bin/Example04.exe <numRanks> [<rank> <port>]
+ * If only the number of ranks is given (default: 2), all ranks are started on
+ * localhost as child processes. Otherwise, each rank is started separately,
+ * e.g. on different machines, in which case the addresses would be given as
+ * "host:port" for each rank instead of those on localhost.
+ */
+int main (int argc, char* argv[]) {
+
+    // Get the number of ranks, and the port of rank 0.
+    const unsigned numRanks = (argc > 1 ? std::stoi(argv[1]) : 2);
+    const unsigned port     = (argc > 3 ? std::stoi(argv[3]) : 47300);
+    const std::vector<std::string> addresses = wavenet::Communicator::localhost(numRanks, port);
+
+    // Run a single rank.
+    if (argc > 2) {
+        header();
+        return train(std::stoi(argv[2]), addresses);
+    }
+
+    // Run all ranks, as child processes. These are started before anything is
+    // logged, such that they don't inherit the log writer of the parent.
+    std::vector<pid_t> children;
+    for (unsigned rank = 0; rank < numRanks; rank++) {
+        const pid_t pid = fork();
+        if (pid == 0) { return train(rank, addresses); }
+        children.push_back(pid);
+    }
+    header();
+
+    int failed = 0;
+    for (const pid_t& pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        failed += (WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : 1);
+    }
+
+    if (failed) {
+        FCTERROR("%d of %d rank(s) failed.", failed, numRanks);
+        return 1;
+    }
+
+    FCTINFO("Done.");
+    return 0;
+}
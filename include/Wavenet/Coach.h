@@ -12,18 +12,28 @@
 #include <iostream> /* std::cout */
 #include <string> /* std::string */
 #include <fstream> /* std::ofstream */
-#include <cmath> /* log10 */
+#include <cmath> /* log10, ceil, sqrt */
 #include <cstdlib> /* system */
+#include <vector> /* std::vector */
+#include <thread> /* std::thread */
+#include <mutex> /* std::mutex, std::lock_guard */
+#include <functional> /* std::ref */
+#include <algorithm> /* std::max, std::min, std::count_if */
 
 // Wavenet include(s).
 #include "Wavenet/Utilities.h"
 #include "Wavenet/Logger.h"
+#include "Wavenet/Profiler.h"
 #include "Wavenet/Wavenet.h"
 #include "Wavenet/GeneratorBase.h"
+#include "Wavenet/Communicator.h"
 
 
 namespace wavenet {
 
+// Forward declaration(s).
+class PoolingGenerator;
+
 /**
  * Class for managing the training of Wavenet objects.
  *
@@ -33,6 +43,48 @@ namespace wavenet {
  *
  * A few adaptive learning methods may be enabled in order to improve 
  * optimisation speed and/or quality.
+ *
+ * To compare several configurations (e.g. filter lengths or regularisation 
+ * constants) without reading the input several times, additional Wavenet 
+ * objects can be added using 'addWavenet'. The Coach then takes each example 
+ * from the generator once, and trains all wavenets on it, each in its own 
+ * thread, in blocks of 'blockSize' examples. Each wavenet keeps its own 
+ * adaptive learning state, and saves its snapshots, metrics, and run 
+ * configuration under its own name, as if trained by a separate Coach.
+ *
+ * Using 'setCurriculum', the training may follow a coarse-to-fine curriculum,
+ * in which the wavenets are first trained on input pooled over blocks of 
+ * several entries (@see PoolingGenerator), and the filter coefficients found
+ * at each resolution are handed over as the starting point at the next, finer
+ * resolution, either after a fixed number of events or once the training has
+ * converged at the current resolution.
+ *
+ * Since random initialisations often converge to the same solution, up to the
+ * symmetries of the filter coefficients (@see FilterDistance), initialisations
+ * may be stopped early once they enter the basin of a solution found by a 
+ * previous initialisation ('setDeduplication'), and the worst initialisations
+ * may be pruned at checkpoints by successive halving ('setPruning').
+ *
+ * For distributed, data-parallel training, each of several processes runs a
+ * Coach with its own generator (i.e. shard of the input) and a Communicator
+ * connecting the processes ('setCommunicator'). The initial filter 
+ * coefficients are broadcast from rank 0, and the batch gradients are averaged
+ * over all ranks before each update, such that the wavenets on all ranks stay
+ * identical. The ranks agree on the number of examples in each block of 
+ * 'blockSize' examples, such that the batches line up, and only rank 0 writes
+ * snapshots, metrics, and the run configuration. Fan-out mode is not supported
+ * in distributed training.
+ *
+ * Alternatively, using 'setNumWorkers', a single wavenet may be trained 
+ * asynchronously by several threads within one process (@see 
+ * Wavenet::trainAsync), without synchronising at each batch. The adaptive 
+ * learning methods, pruning, and deduplication, which act on individual 
+ * examples, are not used in asynchronous training.
+ *
+ * Using 'setNewtonSteps', the solution found by each initialisation may be 
+ * refined by damped Newton steps on a sample of the most recent examples 
+ * (@see Wavenet::newtonStep), after which the gradient and the eigenvalues of
+ * the Hessian are used to certify whether the solution is a local minimum.
  */
 class Coach : Logger  {
 
@@ -77,8 +129,15 @@ public:
 
     // Specify wavenet instance to be trained.
     inline void setWavenet (Wavenet* wavenet) { m_wavenet = wavenet; return; }
+    // Add a wavenet instance to be trained on the same examples as the member
+    // wavenet instance (fan-out mode), with output saved under the given name
+    // in the base directory, and initialised with the given number of filter
+    // coefficients (0 meaning the number set for the Coach).
+    void addWavenet (Wavenet* wavenet, const std::string& name, const unsigned& numCoeffs = 0);
     // Specify generator instance to provide training data.
     inline void setGenerator (GeneratorBase* generator) { m_generator = generator; return; }
+    // Specify communicator instance for distributed training.
+    inline void setCommunicator (Communicator* communicator) { m_communicator = communicator; return; }
     
     // Set the number of events.
     void setNumEvents (const int& numEvents);
@@ -97,9 +156,52 @@ public:
     inline void setUseSimulatedAnnealing (const unsigned& useSimulatedAnnealing = true) { m_useSimulatedAnnealing = useSimulatedAnnealing; return; }
     // Set the target filter coefficient space precision.
     void setTargetPrecision (const double& );
+    // Set the tolerance of the norm test used with adaptive batch size.
+    void setBatchSizeTheta (const double& batchSizeTheta);
+    
+    // Set the number of examples taken from the generator at a time, and 
+    // dispatched to all wavenets, in fan-out mode, or synchronised between 
+    // ranks, in distributed training.
+    inline void setBlockSize (const unsigned& blockSize) { m_blockSize = blockSize; return; }
+
+    // Set the coarse-to-fine curriculum, as the sequence of (radix 2) pooling 
+    // factors of the input, with a final factor of 1 appended if not given. 
+    // The training proceeds to the next stage after 'numEventsPerStage' events,
+    // or once the mean step size falls below 'precision', whichever comes 
+    // first. Negative values disable the respective criterion.
+    void setCurriculum (const std::vector<unsigned>& factors, const int& numEventsPerStage = -1, const double& precision = -1);
+
+    // Set the distance, modulo filter symmetries, within which an 
+    // initialisation is deemed to have entered the basin of a previously found
+    // solution, and is stopped. A negative radius disables deduplication.
+    void setDeduplication (const double& radius);
+    // Set the successive halving pruning of initialisations, with the first 
+    // checkpoint after 'checkpointEvents' events, and each subsequent one 
+    // 'factor' times later, at each of which only the best 1/'factor' of the 
+    // initialisations are kept. A negative number of events disables pruning.
+    void setPruning (const int& checkpointEvents, const unsigned& factor = 2);
+
+    // Set the number of worker threads training the wavenet asynchronously. 
+    // With a single worker (default), the training is synchronous.
+    void setNumWorkers (const unsigned& numWorkers);
+
+    // Set the (maximal) number of damped Newton steps taken at the end of each
+    // initialisation, using the last 'numExamples' examples, after which the
+    // solution is certified as a local minimum or not. Zero (default) disables
+    // these.
+    void setNewtonSteps (const unsigned& numSteps, const unsigned& numExamples = 64);
     
     // Set the print level.
     inline void setPrintLevel (const bool& printLevel) { m_printLevel = printLevel; return; }
+
+    // Set the interval, in seconds, at which to append the metrics of the
+    // wavenet instance to 'metrics.csv' in the output directory.
+    inline void setMetricsInterval (const double& metricsInterval) { m_metricsInterval = metricsInterval; return; }
+
+    // Set the seed used to generate the initial filter coefficients, such that
+    // the training is reproducible. Initialisation i uses seed + i. A negative
+    // seed means that a random seed is used.
+    inline void setSeed (const int& seed) { m_seed = seed; return; }
     
 
 /// Get method(s).
@@ -110,13 +212,17 @@ public:
     // Returns the full output directory.
     inline std::string outdir () const { return m_basedir + m_name + "/"; }
     // If the output directory, and optional subdirectory, does't exist, create 
-    // it.
-    void checkMakeOutdir (const std::string& subdir = "") const;
+    // it. Returns false if the directory doesn't exist and couldn't be created.
+    bool checkMakeOutdir (const std::string& subdir = "") const;
     
     // Returns the member wavenet instance.
     inline Wavenet* wavenet () const { return m_wavenet; }
+    // Returns the number of wavenet instances added for fan-out training.
+    inline unsigned numFanout () const { return m_fanout.size(); }
     // Returns the member generator instance.
     inline GeneratorBase* generator () const { return m_generator; }
+    // Returns the member communicator instance.
+    inline Communicator* communicator () const { return m_communicator; }
 
     // Returns the number of events.
     inline int numEvents () const { return m_numEvents; }
@@ -135,9 +241,45 @@ public:
     inline bool useSimulatedAnnealing () const { return m_useSimulatedAnnealing; }
     // Returns the filtee coefficient space target precision.
     inline double targetPrecision () const { return m_targetPrecision; }
+    // Returns the tolerance of the norm test used with adaptive batch size.
+    inline double batchSizeTheta () const { return m_batchSizeTheta; }
+    
+    // Returns the number of examples dispatched at a time, in fan-out mode.
+    inline unsigned blockSize () const { return m_blockSize; }
+
+    // Returns the pooling factors of the coarse-to-fine curriculum.
+    inline std::vector<unsigned> curriculum () const { return m_curriculum; }
+    // Returns the number of events per curriculum stage.
+    inline int curriculumEvents () const { return m_curriculumEvents; }
+    // Returns the precision at which to proceed to the next curriculum stage.
+    inline double curriculumPrecision () const { return m_curriculumPrecision; }
+
+    // Returns the radius within which initialisations are deemed duplicates.
+    inline double deduplicationRadius () const { return m_dedupRadius; }
+    // Returns the number of events before the first pruning checkpoint.
+    inline int pruningEvents () const { return m_pruneEvents; }
+    // Returns the successive halving factor.
+    inline unsigned pruningFactor () const { return m_pruneFactor; }
+
+    // Returns the number of worker threads used for asynchronous training.
+    inline unsigned numWorkers () const { return m_numWorkers; }
+
+    // Returns the number of Newton steps taken at the end of each 
+    // initialisation, and the number of examples used for these.
+    inline unsigned newtonSteps    () const { return m_newtonSteps; }
+    inline unsigned newtonExamples () const { return m_newtonExamples; }
     
     // Returns the print level.
     inline unsigned printLevel () const { return m_printLevel; }
+
+    // Returns the interval at which metrics are written to file.
+    inline double metricsInterval () const { return m_metricsInterval; }
+    // Returns the metrics of the member wavenet instance, combined with those
+    // of the instances added for fan-out training (@see Metrics::merge).
+    Metrics metrics () const;
+
+    // Returns the seed used to generate the initial filter coefficients.
+    inline int seed () const { return m_seed; }
     
     
 /// High-level training method(s).
@@ -151,6 +293,93 @@ public:
 
 private:
 
+/// Internal type(s).
+    /**
+     * A wavenet instance being trained, along with its output name and its
+     * adaptive learning state for the current initialisation.
+     */
+    struct Trainee {
+        Trainee (Wavenet* wavenet_, const std::string& name_, const unsigned& numCoeffs_) :
+            wavenet(wavenet_), name(name_), numCoeffs(numCoeffs_)
+        {};
+
+        Wavenet* wavenet = nullptr;
+        std::string name = "";
+        unsigned numCoeffs = 0;
+        std::string label = ""; // Prefix for progress information.
+
+        double lambdaBare = 0; // Bare regularisation constant.
+        Snapshot baseSnap;     // Snapshot of the initial condition.
+        Snapshot snap;         // Snapshot of the final configurations.
+
+        bool done = false;     // Whether the training is done.
+        bool failed = false;   // Whether the training failed.
+        unsigned tail = 0;     // Number of updates since last adaptation.
+        unsigned currentCostLogSize  = 0;
+        unsigned previousCostLogSize = 0;
+        int eventPrint = 1;    // Interval at which to print progress.
+        double lastMetricsWrite = 0;
+
+        bool converged = false;  // Whether converged at the current stage.
+        unsigned stageStart = 0; // Size of the filter log at stage start.
+
+        unsigned events = 0;            // Number of events in initialisation.
+        unsigned long nextCheckpoint = 0; // Event of the next checkpoint.
+        unsigned checkpoint = 0;        // Index of the next checkpoint.
+        unsigned filterLogSize = 0;     // Size of the filter log at last check.
+        bool stopped = false;           // Whether pruned, or a duplicate.
+        std::vector< std::vector<double> > checkpointCosts; // Across inits.
+        std::vector< arma::Col<double> > solutions; // Canonical filters found.
+        unsigned numPruned = 0;
+        unsigned numDuplicates = 0;
+
+        unsigned numPolished  = 0; // Number of solutions refined by Newton steps.
+        unsigned numCertified = 0; // Number of these certified as minima.
+    };
+
+
+/// Internal method(s).
+    // Returns the output directory of a trainee.
+    inline std::string outdir_ (const Trainee& trainee) const { return m_basedir + trainee.name + "/"; }
+
+    // If the directory doesn't exist, create it. Returns false if the directory
+    // doesn't exist and couldn't be created.
+    bool checkMakeDir_ (const std::string& dir) const;
+
+    // Train a wavenet instance on a single example (or multi-channel example,
+    // if 'channels' is set), applying simulated annealing and adaptive 
+    // learning, and printing progress.
+    void step_ (Trainee& trainee, const arma::Mat<double>* example, const arma::Cube<double>* channels,
+                const int& event, const unsigned& epoch);
+
+    // Whether the training is done for all trainees.
+    bool allDone_ (const std::vector<Trainee>& trainees) const;
+
+    // Proceed to the given stage of the coarse-to-fine curriculum, setting the
+    // pooling factor of the input accordingly.
+    void setStage_ (const unsigned& stage, PoolingGenerator& pooling, std::vector<Trainee>& trainees);
+
+    // Whether the current stage is the last of the curriculum (or no 
+    // curriculum is used).
+    inline bool finalStage_ () const { return m_stage + 1 >= m_curriculum.size(); }
+
+    // Whether the training has converged, or is done, at the current stage of
+    // the curriculum for all trainees.
+    bool allConverged_ (const std::vector<Trainee>& trainees) const;
+
+    // Stop the current initialisation of a trainee if it has entered the basin
+    // of a previously found solution, or if it is pruned at a checkpoint.
+    void checkRestart_ (Trainee& trainee, const unsigned& useLastN);
+
+    // Train a wavenet instance asynchronously on the examples of one epoch, 
+    // using the member number of worker threads. Returns the number of events.
+    int trainAsync_ (Trainee& trainee, GeneratorBase* generator);
+
+    // Refine the solution of a trainee using damped Newton steps on the given
+    // examples, and certify whether it is a local minimum.
+    void polish_ (Trainee& trainee, const std::vector< arma::Mat<double> >& examples);
+
+
 /// Data member(s).
     // Directory structure member(s).
     /**
@@ -180,6 +409,111 @@ private:
      * Pointer to the generator object providing the input for the training.
      */
     GeneratorBase* m_generator = nullptr;
+
+    /**
+     * Pointer to the communicator object connecting the processes in 
+     * distributed training, if any.
+     */
+    Communicator* m_communicator = nullptr;
+
+    /**
+     * Additional wavenet objects to train on the same input (fan-out mode).
+     */
+    std::vector<Trainee> m_fanout;
+
+    /**
+     * Number of examples taken from the generator at a time, and dispatched to
+     * all wavenet objects, in fan-out mode, or after which the ranks agree on
+     * whether to continue, in distributed training. Larger blocks reduce the 
+     * synchronisation between threads and processes, at the cost of memory for
+     * the copies.
+     */
+    unsigned m_blockSize = 64;
+
+    // Curriculum member(s).
+    /**
+     * Pooling factors of the input for each stage of the coarse-to-fine 
+     * curriculum, ending with 1, i.e. the full resolution. If empty, the 
+     * training uses the full resolution throughout.
+     *
+     * At coarse resolution, each example is smaller, so the training steps are
+     * cheaper, and the cost landscape is smoother, with fewer of the local 
+     * minima arising from fine-scale structure in the input. Since the filter
+     * coefficients don't depend on the input size, they carry over between
+     * stages as they are.
+     */
+    std::vector<unsigned> m_curriculum = {};
+
+    /**
+     * Number of events, across epochs, after which to proceed to the next stage
+     * of the curriculum. If negative, the stages are only changed on 
+     * convergence (@see m_curriculumPrecision).
+     */
+    int m_curriculumEvents = -1;
+
+    /**
+     * Mean step size, over the last updates, below which the training is 
+     * deemed converged at the current stage of the curriculum, and proceeds to
+     * the next one. In fan-out mode, all wavenets must have converged. If 
+     * negative, the stages are only changed on schedule (@see 
+     * m_curriculumEvents). At stages before the last, reaching the target 
+     * precision (@see m_targetPrecision) likewise proceeds to the next stage,
+     * rather than ending the training.
+     */
+    double m_curriculumPrecision = -1;
+
+    /**
+     * Current stage of the curriculum, during training.
+     */
+    unsigned m_stage = 0;
+
+    // Restart member(s).
+    /**
+     * Distance, modulo sign flip and time reversal of the filter coefficients
+     * (@see FilterDistance), within which an initialisation is 
+     * deemed to have entered the basin of a solution found by a previous, 
+     * completed initialisation. Such initialisations are stopped, since they 
+     * are expected to converge to the same solution. If negative, all 
+     * initialisations are run to completion.
+     */
+    double m_dedupRadius = -1;
+
+    /**
+     * Number of events, within each initialisation, before the first 
+     * successive halving checkpoint. At each checkpoint, the mean cost over the
+     * last updates is compared to that of all previous initialisations at the
+     * same checkpoint, and the initialisation is stopped unless it is among the
+     * best 1/m_pruneFactor of these. Subsequent checkpoints are m_pruneFactor 
+     * times later. Since the initialisations run one after another, this is 
+     * the asynchronous variant of successive halving. If negative, no 
+     * initialisations are pruned.
+     */
+    int m_pruneEvents = -1;
+
+    /**
+     * Successive halving factor (@see m_pruneEvents).
+     */
+    unsigned m_pruneFactor = 2;
+
+    // Asynchronous training member(s).
+    /**
+     * Number of worker threads training the wavenet asynchronously, each 
+     * pulling examples from the generator and updating the shared filter 
+     * coefficients without locking (@see Wavenet::trainAsync). If 1, the 
+     * training is synchronous.
+     */
+    unsigned m_numWorkers = 1;
+
+    // Second-order member(s).
+    /**
+     * Maximal number of damped Newton steps taken at the end of each 
+     * initialisation, and the number of most recent examples used for these 
+     * (@see Wavenet::newtonStep). Since the filter coefficient space is small,
+     * the full Hessian is affordable, and a few Newton steps replace the long 
+     * tail of stochastic gradient descent close to a minimum. 
+     */
+    unsigned m_newtonSteps    = 0;
+    unsigned m_newtonExamples = 64;
     
     // Training schedule member(s).
     /**
@@ -238,11 +572,22 @@ private:
     /**
      * Whether to make the batch size adaptive.
      *
-     * If the learning rate is adaptive, the Coach keeps track of the mean and 
-     * total learning step size during the last N ('useLastN' in Coach.cxx) 
-     * update steps. If the total step size is smaller than the mean step size, 
-     * the batch size is increase by a factor of two. This allows for finding a
-     * more precise minimum.
+     * If the batch size is adaptive, the Coach uses the statistics of each 
+     * batch to check whether it is large enough (the "norm test"): the 
+     * variance of the batch-averaged gradient, i.e. the summed variance of the
+     * gradients of single examples divided by the batch size, should be at 
+     * most theta^2 (@see m_batchSizeTheta) times the squared norm of the 
+     * batch-averaged gradient. Otherwise, the batch size is increased to the
+     * smallest size for which the test would have passed. The batch size thus
+     * grows as the gradient noise starts to dominate close to the minimum, 
+     * allowing for finding a more precise minimum, without spending examples 
+     * on large batches while the gradient is still large.
+     *
+     * Since the variance can't be estimated from batches of a single example,
+     * the Coach then instead keeps track of the mean and total learning step 
+     * size during the last N ('useLastN' in Coach.cxx) update steps. If the 
+     * total step size is smaller than the mean step size, the batch size is 
+     * increased by a factor of two.
      *
      * If a target precision is set (@see m_targetPrecision), the training may
      * break early if the mean step size is smaller than the target precision. 
@@ -295,6 +640,14 @@ private:
      * is disabled if simulated annealing is also enabled.
      */
     double m_targetPrecision = -1;
+
+    /**
+     * Tolerance of the norm test used with adaptive batch size.
+     *
+     * Smaller values require the batch-averaged gradients to be more precise,
+     * and hence lead to larger batches. @see m_useAdaptiveBatchSize
+     */
+    double m_batchSizeTheta = 0.9;
     
     // Printing member(s).
     /**
@@ -307,6 +660,23 @@ private:
      * .. >= 3,    -     -   -     -  -  events is printed.
      */
     unsigned m_printLevel = 3;
+
+    // Monitoring member(s).
+    /**
+     * The interval, in seconds, at which the metrics of the wavenet instance 
+     * are appended to 'metrics.csv' in the output directory. If non-positive,
+     * the metrics are only written to 'metrics.json' at the end of training.
+     */
+    double m_metricsInterval = -1;
+
+    // Reproducibility member(s).
+    /**
+     * The seed used to generate the initial filter coefficients for each 
+     * initialisation. If negative, a random seed is used. To make the training 
+     * fully reproducible, the generator should be seeded as well (@see 
+     * GeneratorBase::setSeed).
+     */
+    int m_seed = -1;
     
 };
 
@@ -0,0 +1,144 @@
+#ifndef WAVENET_COMMUNICATOR_H
+#define WAVENET_COMMUNICATOR_H
+
+/**
+ * @file   Communicator.h
+ * @brief  Class for collective communication between training processes.
+ */
+
+// STL include(s).
+#include <string> /* std::string */
+#include <vector> /* std::vector */
+#include <cstddef> /* std::size_t */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h"
+#include "Wavenet/Logger.h"
+#include "Wavenet/Profiler.h"
+
+
+namespace wavenet {
+
+/**
+ * Class for collective communication between training processes.
+ *
+ * The processes (ranks) are connected in a ring, in which each rank sends to
+ * the next rank and receives from the previous one, over TCP sockets (address
+ * "host:port") or Unix domain sockets (address "unix:/path/to/socket"). Each
+ * rank listens on its own address, given by its index in the list of
+ * addresses, which must be identical on all ranks. TCP sockets are bound to
+ * the interface of the host in the address, such that e.g. "localhost:port"
+ * only accepts connections from the same machine.
+ * Each rank identifies itself to the next by its rank and the ring size, and
+ * connections from processes which don't identify as the previous rank in a
+ * ring of the same size are rejected.
+ *
+ * Vectors are summed across ranks using ring all-reduce: the vector is split
+ * into one chunk per rank, each of which is reduced as it is passed once
+ * around the ring (reduce-scatter), after which the reduced chunks are passed
+ * once more around the ring (all-gather). Each rank thus sends and receives
+ * about twice the size of the vector, regardless of the number of ranks.
+ * Since each chunk is reduced in the same order, and then copied, the result
+ * is bit-wise identical on all ranks, such that wavenets applying the same
+ * updates stay identical.
+ *
+ * All ranks must call the collective methods in the same order, with vectors
+ * of the same size. The ranks are assumed to share the same byte order.
+ *
+ * If a collective call fails on any rank, e.g. because a connection is lost,
+ * that rank closes its sockets, such that its neighbours fail their current or
+ * next collective call, and the failure propagates around the ring. After
+ * this, 'initialised' returns false on all ranks.
+ */
+class Communicator : public Logger {
+
+public:
+
+    /// Reduction operation(s).
+    enum class Reduction { Sum, Min, Max };
+
+
+    /// Constructor(s).
+    Communicator () {};
+
+    Communicator (const unsigned& rank, const std::vector<std::string>& addresses, const double& timeout = 60.)
+    { init(rank, addresses, timeout); };
+
+    // The sockets are owned by the instance, so it cannot be copied.
+    Communicator (const Communicator& other) = delete;
+    Communicator& operator= (const Communicator& other) = delete;
+
+
+    /// Destructor.
+    ~Communicator () { close(); };
+
+
+    /// Initialisation method(s).
+    // Connect the ring, as rank 'rank' of the processes with the given
+    // addresses, waiting at most 'timeout' seconds for the neighbouring ranks.
+    bool init (const unsigned& rank, const std::vector<std::string>& addresses, const double& timeout = 60.);
+
+    // Close all sockets.
+    void close ();
+
+    // Returns the addresses "localhost:port", ..., "localhost:port + size - 1",
+    // for testing on a single machine.
+    static std::vector<std::string> localhost (const unsigned& size, const unsigned& port);
+
+
+    /// Get method(s).
+    inline unsigned rank () const { return m_rank; }
+    inline unsigned size () const { return m_size; }
+    inline bool initialised () const { return m_initialised; }
+
+
+    /// Collective method(s).
+    // Reduce the vector element-wise across all ranks, in place.
+    bool allReduce (arma::Col<double>& values, const Reduction& reduction = Reduction::Sum);
+
+    // Copy the vector from rank 'root' to all ranks, in place.
+    bool broadcast (arma::Col<double>& values, const unsigned& root = 0);
+
+    // Wait until all ranks have called this method.
+    bool barrier ();
+
+
+private:
+
+    /// Internal method(s).
+    // Open a socket listening on the given address.
+    int listen_ (const std::string& address);
+
+    // Connect to the given address, retrying until the deadline.
+    int connect_ (const std::string& address, const double& deadline);
+
+    // Simultaneously send 'nSend' bytes to the next rank, and receive 'nRecv'
+    // bytes from the previous rank, such that neighbouring ranks sending to
+    // each other cannot dead-lock on full socket buffers.
+    bool sendRecv_ (const char* send, const std::size_t& nSend, char* recv, const std::size_t& nRecv);
+
+
+private:
+
+    /// Data member(s).
+    unsigned m_rank = 0;
+    unsigned m_size = 1;
+    bool m_initialised = false;
+
+    // Socket file descriptors: listening, to the next rank, and from the
+    // previous rank.
+    int m_listen = -1;
+    int m_next   = -1;
+    int m_prev   = -1;
+
+    // Path of the listening Unix domain socket, if any, to be removed on close.
+    std::string m_unixPath = "";
+
+};
+
+} // namespace
+
+#endif // WAVENET_COMMUNICATOR_H
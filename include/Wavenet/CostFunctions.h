@@ -13,6 +13,7 @@
 
 // Wavenet include(s).
 #include "Wavenet/MatrixOperator.h"
+#include "Wavenet/Profiler.h"
 
 
 namespace wavenet {
@@ -120,6 +121,67 @@ double RegTerm (const arma::Col<double>& a, const bool& doWavelet = true);
  */
 arma::Col<double> RegTermDeriv (const arma::Col<double>& a, const bool& doWavelet = true);
 
+/**
+ * @brief Compute the Hessian of the regularisation term on filter coefficients.
+ *
+ * This method computes the matrix of second derivatives of the regularisation
+ * terms with respect to the filter coefficients, i.e. the Jacobian of 
+ * RegTermDeriv, such that it is consistent with the gradient used in the 
+ * stochastic gradient descent. Since each term is a polynomial in the filter
+ * coefficients, the Hessian is computed exactly:
+ *   \nabla^{2} (t - \delta)^{2} = 2 \nabla t \nabla t^{T} + 2 (t - \delta) \nabla^{2} t
+ * for each of the quadratic terms t entering the conditions. (C3) is identical
+ * to (C2), since 
+ *   \sum_{k} b_{k} b_{k + 2m} = \sum_{k} a_{k} a_{k - 2m}
+ * for b_{k} = (-1)^{k} a_{N - k - 1}.
+ *
+ * @see RegTermDeriv(arma::Col<double>)
+ *
+ * @param a Vector of filter coefficients.
+ * @param doWavelet Whether to impose wavelet-specific regularisation.
+ * @return Symmetric matrix of second derivatives in filter coefficient space.
+ */
+arma::Mat<double> RegTermHessian (const arma::Col<double>& a, const bool& doWavelet = true);
+
+
+/// Constraint function(s).
+/**
+ * @brief Project filter coefficients onto the set of valid wavelets.
+ *
+ * Rather than imposing the wavelet conditions softly, through the 
+ * regularisation term, this method maps the filter coefficients onto the set
+ * of filters satisfying these exactly, using Newton iterations on the 
+ * constraints
+ *   c_{m}(\{a\}) = \sum_{k} a_{k} a_{k + 2m} - \delta_{0,m} = 0, m = 0, ..., N/2 - 1   (C2)
+ *   c_{N/2}(\{a\}) = \sum_{k} (-1)^{k} a_{k} = 0   (C4, wavelet-specific)
+ * Each iteration takes the minimum-norm step, 
+ *   a \rightarrow a - J^{T} (J J^{T})^{-1} c(a)
+ * where J is the Jacobian of the constraints, such that, warm-started from a 
+ * nearby filter (e.g. the filter before a gradient step), the iterations 
+ * converge quadratically to a nearby point on the constraint set.
+ *
+ * Condition (C1) is not imposed directly, since \sqrt{2} is the largest sum of
+ * any orthonormal filter, such that the constraint is degenerate on the 
+ * constraint set. Instead, (C2) and (C4) imply that the sum is \pm\sqrt{2}, 
+ * and the sign of the filter coefficients is flipped if necessary. (C3) 
+ * follows from (C2).
+ *
+ * Far from the constraint set, e.g. from a random initialisation, the 
+ * iterations take longer to reach the quadratic regime, and more so for 
+ * larger N (for N = 8, up to about 20 iterations), so the default maximal 
+ * number of iterations scales with N.
+ *
+ * @param a Vector of filter coefficients, projected in place.
+ * @param doWavelet Whether to impose the wavelet-specific conditions.
+ * @param tolerance Target maximal absolute deviation from the constraints.
+ * @param maxIterations Maximal number of Newton iterations. If zero, 
+ *        max(20, 4N) iterations are used.
+ * @return Whether the iterations converged to the target tolerance. If not,
+ *         'a' holds the last iterate.
+ */
+bool ProjectFilter (arma::Col<double>& a, const bool& doWavelet = true,
+                    const double& tolerance = 1.0e-12, const unsigned& maxIterations = 0);
+
 } // namespace
 
 #endif // WAVENET_COSTFUNCTIONS_H
@@ -45,6 +45,16 @@ public:
     // Get the next input from the generator.
     virtual const arma::Mat<double>& next () = 0;
 
+    // Get the next multi-channel input from the generator, with one slice per
+    // channel, e.g. for several co-registered images of the same event. The
+    // default implementation yields the input from 'next' as a single channel.
+    // Generators producing several channels should overwrite this method as
+    // well as 'numChannels', and decode each input only once for all channels.
+    virtual const arma::Cube<double>& nextChannels ();
+
+    // Get the number of channels of the generator input.
+    virtual unsigned numChannels () const { return 1; }
+
     // Whether the generator is in a good condition, i.e. whether we can safely 
     // produce the next generator input.
     virtual bool good () = 0;
@@ -64,6 +74,13 @@ public:
     bool setShape (const std::vector<unsigned>& shape);
 
 
+    /// Seed method(s).
+    // Set the seed used for the random number generator each time the generator
+    // is (re-)opened, such that the generated input is reproducible. A negative
+    // seed means that a random seed is used.
+    inline void setSeed (const int& seed) { m_seed = seed; return; }
+
+
     /// Get method(s)
     // Get the shape of the generator input.
     std::vector<unsigned> shape () const { return m_shape; }
@@ -75,6 +92,9 @@ public:
     // Whether the current GeneratorBase instance is properly intialised.
     inline bool initialised () const { return m_initialised; }
 
+    // Get the seed of the random number generator.
+    inline int seed () const { return m_seed; }
+
 
 protected:
 
@@ -87,6 +107,10 @@ protected:
     // is properly configured.
     bool check_ ();
 
+    // Seed the (Armadillo) random number generator, using the fixed seed if 
+    // one is set and a random seed otherwise.
+    void seed_ ();
+
 
 protected:
 
@@ -100,6 +124,13 @@ protected:
     // Armadillo matrix, holding the input produced by the generator.
     arma::Mat<double> m_data = {};
 
+    // Armadillo cube, holding the multi-channel input produced by the 
+    // generator.
+    arma::Cube<double> m_channels = {};
+
+    // The seed of the random number generator. Negative means random.
+    int m_seed = -1;
+
 };
 
 } // namespace
@@ -63,7 +63,7 @@ public:
 
     virtual inline bool good () { return true; }
 
-    virtual inline bool open () { arma::arma_rng::set_seed_random(); return true; }
+    virtual inline bool open () { seed_(); return true; }
   
 };
 
@@ -97,7 +97,7 @@ public:
 
     virtual inline bool good () { return true; }
 
-    virtual inline bool open () { arma::arma_rng::set_seed_random(); return true; }
+    virtual inline bool open () { seed_(); return true; }
     
 };
 
@@ -167,11 +167,122 @@ public:
 
     virtual inline bool good () { return true; }
 
-    virtual inline bool open () { arma::arma_rng::set_seed_random(); return true; }
+    virtual inline bool open () { seed_(); return true; }
     
 };
 
 
+/**
+ * Derived class pooling the input from another generator.
+ *
+ * Wraps around another generator, and sums the input over blocks of 'factor'
+ * entries along each axis of size larger than one, yielding input of lower 
+ * resolution, e.g. for coarse-to-fine training curricula (@see Coach). The 
+ * pooling factor can be changed between calls to 'next'. With a factor of 1,
+ * the input of the wrapped generator is passed through unchanged. The wrapper
+ * doesn't own the wrapped generator.
+ */
+class PoolingGenerator : public GeneratorBase {
+
+public:
+
+    /// Constructor(s).
+    PoolingGenerator (GeneratorBase* source, const unsigned& factor = 1) :
+        m_source(source)
+    {
+        m_initialised = (source != nullptr && source->initialised());
+        setFactor(factor);
+    }
+
+
+    /// Destructor.
+    ~PoolingGenerator () {}
+
+
+    /// Generator method(s).
+    virtual inline const arma::Mat<double>& next () {
+
+        // Get the next input from the wrapped generator, and pool it.
+        const arma::Mat<double>& data = m_source->next();
+        if (m_factor == 1) { return data; }
+        pool_(data, m_data);
+        m_shape = {(unsigned) m_data.n_rows, (unsigned) m_data.n_cols};
+
+        return m_data;
+    }
+
+    virtual inline const arma::Cube<double>& nextChannels () {
+
+        // Get the next multi-channel input from the wrapped generator, and 
+        // pool each channel.
+        const arma::Cube<double>& data = m_source->nextChannels();
+        if (m_factor == 1) { return data; }
+        arma::Mat<double> pooled;
+        for (unsigned c = 0; c < data.n_slices; c++) {
+            pool_(data.slice(c), pooled);
+            if (c == 0) { m_channels.set_size(pooled.n_rows, pooled.n_cols, data.n_slices); }
+            m_channels.slice(c) = pooled;
+        }
+
+        return m_channels;
+    }
+
+    virtual inline unsigned numChannels () const { return m_source->numChannels(); }
+
+    virtual inline bool good () { return m_source->good(); }
+
+    virtual inline bool open () { return m_source->open(); }
+
+    virtual inline bool close () { return m_source->close(); }
+
+
+    /// Set method(s).
+    // Set the pooling factor, which must be radix 2.
+    inline bool setFactor (const unsigned& factor) {
+        if (!isRadix2(factor)) {
+            WARNING("Pooling factor (%d) is not radix 2.", factor);
+            return false;
+        }
+        m_factor = factor;
+        return true;
+    }
+
+
+    /// Get method(s).
+    // Returns the pooling factor.
+    inline unsigned factor () const { return m_factor; }
+    
+
+private:
+
+    /// Internal method(s).
+    // Sum the input over blocks of 'm_factor' entries along each axis of size
+    // larger than one (and at most the size of the axis).
+    inline void pool_ (const arma::Mat<double>& in, arma::Mat<double>& out) const {
+        const unsigned fr = (in.n_rows > 1 ? std::min(m_factor, (unsigned) in.n_rows) : 1);
+        const unsigned fc = (in.n_cols > 1 ? std::min(m_factor, (unsigned) in.n_cols) : 1);
+        out.zeros(in.n_rows / fr, in.n_cols / fc);
+        for (unsigned j = 0; j < in.n_cols; j++) {
+            for (unsigned i = 0; i < in.n_rows; i++) {
+                out(i / fr, j / fc) += in(i, j);
+            }
+        }
+        return;
+    }
+
+
+private:
+
+    /// Data member(s).
+    // The wrapped generator.
+    GeneratorBase* m_source = nullptr;
+
+    // The pooling factor.
+    unsigned m_factor = 1;
+
+};
+
+
 /**
  *  Derived class generating input from CSV files.
  */
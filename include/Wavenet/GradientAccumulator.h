@@ -0,0 +1,102 @@
+#ifndef WAVENET_GRADIENTACCUMULATOR_H
+#define WAVENET_GRADIENTACCUMULATOR_H
+
+/**
+ * @file   GradientAccumulator.h
+ * @brief  Class for accumulating the gradients of a batch of examples.
+ */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h"
+
+
+namespace wavenet {
+
+/**
+ * Class for accumulating the gradients of a batch of examples.
+ *
+ * The gradients are added one at a time to a running sum, using compensated
+ * (Kahan) summation, such that the rounding error of the sum doesn't grow with
+ * the number of examples. At the same time, the running mean and sum of
+ * squared deviations from the mean are updated using Welford's algorithm, from
+ * which the sample variance of each gradient component is computed.
+ *
+ * The memory used is a fixed number of vectors of the size of the gradient,
+ * regardless of the number of examples in the batch.
+ */
+class GradientAccumulator : public Logger {
+
+public:
+
+    /// Constructor(s).
+    GradientAccumulator () {};
+
+
+    /// Destructor.
+    ~GradientAccumulator () {};
+
+
+    /// Update method(s).
+    // Add the gradient from a single example. Returns false if the size of the
+    // gradient differs from that of the ones already added.
+    bool add (const arma::Col<double>& gradient);
+
+    // Set the state of the accumulator directly, e.g. when reading snapshots
+    // or combining accumulators across processes. 'm2' is the sum of squared
+    // deviations from the mean.
+    bool set (const unsigned& count, const arma::Col<double>& sum, const arma::Col<double>& mean, const arma::Col<double>& m2);
+
+    // Remove all gradients.
+    void clear ();
+
+
+    /// Get method(s).
+    inline unsigned count () const { return m_count; }
+    inline bool     empty () const { return m_count == 0; }
+
+    // Sum of the gradients.
+    inline const arma::Col<double>& sum  () const { return m_sum; }
+    // Mean of the gradients.
+    inline const arma::Col<double>& mean () const { return m_mean; }
+    // Sum of squared deviations of the gradients from their mean.
+    inline const arma::Col<double>& m2   () const { return m_m2; }
+
+    // Unbiased sample variance of each gradient component. Vanishes for fewer
+    // than two gradients.
+    arma::Col<double> variance () const;
+
+    // Sum of squares of the gradients about zero, m2 + count * mean^2. Unlike
+    // the squared deviations from the mean, these can be summed across
+    // accumulators with different means, e.g. across processes.
+    arma::Col<double> squares () const;
+
+
+    /// Static method(s).
+    // Sum of squared deviations from the mean of 'count' gradients, given
+    // their sum and their sum of squares about zero (@see squares). Negative
+    // values, from rounding errors, are set to zero.
+    static arma::Col<double> deviations (const double& count, const arma::Col<double>& sum,
+                                         const arma::Col<double>& squares);
+
+
+private:
+
+    /// Data member(s).
+    unsigned m_count = 0;
+
+    // Compensated sum, and the running compensation for lost low-order bits.
+    arma::Col<double> m_sum;
+    arma::Col<double> m_compensation;
+
+    // Running mean and sum of squared deviations.
+    arma::Col<double> m_mean;
+    arma::Col<double> m_m2;
+
+};
+
+} // namespace
+
+#endif // WAVENET_GRADIENTACCUMULATOR_H
@@ -0,0 +1,76 @@
+#ifndef WAVENET_LATTICE_H
+#define WAVENET_LATTICE_H
+
+/**
+ * @file   Lattice.h
+ * @brief  Orthonormal lattice parameterisation of filter coefficients.
+ */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h"
+#include "Wavenet/Profiler.h"
+
+
+namespace wavenet {
+
+/**
+ * Orthonormal lattice parameterisation.
+ *
+ * Any set of N filter coefficients satisfying the orthonormality condition
+ * (C2) can be written as a paraunitary lattice of N/2 rotations, with angles
+ * \theta_{0}, ..., \theta_{N/2 - 1}. Starting from h = (cos \theta_{0},
+ * sin \theta_{0}) and g = (-sin \theta_{0}, cos \theta_{0}), each subsequent
+ * angle \theta_{j} rotates the pair as
+ *   h' = cos \theta_{j} h + sin \theta_{j} z^{-2} g
+ *   g' = -sin \theta_{j} h + cos \theta_{j} z^{-2} g
+ * where z^{-2} g is g delayed by two entries, and the filter coefficients are
+ * given by the final h. The sum of the filter coefficients is then
+ * \sqrt{2} sin(\pi/4 + \sum_{j} \theta_{j}), such that the dilation condition
+ * (C1), and with it (C3) and (C4), is satisfied if the angles sum to \pi/4.
+ *
+ * The parameterisation therefore uses the N/2 - 1 free angles \theta_{0}, ...,
+ * \theta_{N/2 - 2}, with the last angle fixed to \pi/4 minus the sum of these,
+ * such that every point in angle space is a valid wavelet, and the
+ * regularisation terms vanish identically.
+ */
+
+/**
+ * @brief Compute the filter coefficients from lattice angles.
+ *
+ * @param angles Vector of N/2 - 1 free lattice angles.
+ * @return Vector of N filter coefficients.
+ */
+arma::Col<double> LatticeFilter (const arma::Col<double>& angles);
+
+/**
+ * @brief Compute the lattice angles from filter coefficients.
+ *
+ * For filter coefficients satisfying the wavelet conditions, this is the
+ * inverse of LatticeFilter, up to multiples of 2\pi. Otherwise, the angles
+ * correspond to a nearby valid wavelet, such that LatticeFilter(LatticeAngles(a))
+ * projects any filter onto the set of valid wavelets.
+ *
+ * @param filter Vector of N filter coefficients.
+ * @return Vector of N/2 - 1 free lattice angles.
+ */
+arma::Col<double> LatticeAngles (const arma::Col<double>& filter);
+
+/**
+ * @brief Compute gradient on lattice angles from gradient on filter
+ *        coefficients.
+ *
+ * Applies the chain rule through the lattice, by backpropagating the gradient
+ * through the rotations in reverse order.
+ *
+ * @param angles Vector of N/2 - 1 free lattice angles.
+ * @param gradient Vector gradient on the N corresponding filter coefficients.
+ * @return Vector gradient on the free lattice angles.
+ */
+arma::Col<double> LatticeGradient (const arma::Col<double>& angles, const arma::Col<double>& gradient);
+
+} // namespace
+
+#endif // WAVENET_LATTICE_H
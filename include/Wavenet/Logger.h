@@ -9,27 +9,78 @@
  */
 
 // STL include(s).
-#include <iostream> /* std::cout, std::left */
 #include <string> /* std::string */
-#include <stdio.h> /* vprintf */
+#include <typeinfo> /* std::type_info */
+#include <stdio.h> /* snprintf, vsnprintf */
 #include <stdarg.h> /* variadic functions */
-#include <iomanip> /* std::setw */
+#include <atomic> /* std::atomic */
 
 // Wavenet include(s).
 #include "Wavenet/Type.h"
 
 
+/// Print levels, in increasing order of severity.
+#define WAVENET_LEVEL_VERBOSE 0
+#define WAVENET_LEVEL_DEBUG   1
+#define WAVENET_LEVEL_INFO    2
+#define WAVENET_LEVEL_WARNING 3
+#define WAVENET_LEVEL_ERROR   4
+#define WAVENET_LEVEL_NONE    5
+
+/// Compile-time minimum print level.
+// Print statements below this level compile to nothing. Set e.g. using 
+// '-DWAVENET_LOG_LEVEL=2' (or '$ make LOGLEVEL=2') to remove all 'DEBUG' and 
+// 'VERBOSE' statements from the build.
+#ifndef WAVENET_LOG_LEVEL
+#define WAVENET_LOG_LEVEL WAVENET_LEVEL_VERBOSE
+#endif
+
 /// Printing macros, with signature similar to 'printf'.
+// The 'if (...) {} else ...' construction, with the trailing semicolon 
+// supplied by the caller, is used so as to make the macros safe to use in 
+// unbraced if-else statements: the macro's own 'else' is taken, such that an 
+// 'else' following it binds to the enclosing 'if'. Compiled-out statements
+// use 'do {} while (0)' for the same reason.
+#define WAVENET_PRINT_(level, cond, ...)    if (!(wavenet::Logger::enabled(WAVENET_LEVEL_##level) && (cond))) {} else this->print_(typeid(*this), __FUNCTION__, #level, __VA_ARGS__)
+#define WAVENET_FCTPRINT_(level, ...)       if (!wavenet::Logger::enabled(WAVENET_LEVEL_##level)) {} else wavenet::Logger::fctprint_(__FUNCTION__, #level, __VA_ARGS__)
+#define WAVENET_NOPRINT_()                  do {} while (0)
+
 // Macros only to be called from classes inheriting from Logger.
-#define ERROR(...)                  {this->print_(type(*this),  __FUNCTION__, "ERROR",   __VA_ARGS__);}
-#define WARNING(...)                {this->print_(type(*this),  __FUNCTION__, "WARNING", __VA_ARGS__);}
-#define INFO(...)                   {this->print_(type(*this),  __FUNCTION__, "INFO",    __VA_ARGS__);}
-#define DEBUG(...)   if (debug())   {this->print_(type(*this),  __FUNCTION__, "DEBUG",   __VA_ARGS__);}
-#define VERBOSE(...) if (verbose()) {this->print_(type(*this),  __FUNCTION__, "VERBOSE", __VA_ARGS__);}
-// Macros to be called from wherever.
-#define FCTERROR(...)               {wavenet::Logger::fctprint_(__FUNCTION__, "ERROR",   __VA_ARGS__);}
-#define FCTWARNING(...)             {wavenet::Logger::fctprint_(__FUNCTION__, "WARNING", __VA_ARGS__);}
-#define FCTINFO(...)                {wavenet::Logger::fctprint_(__FUNCTION__, "INFO",    __VA_ARGS__);}
+#if WAVENET_LOG_LEVEL <= WAVENET_LEVEL_ERROR
+#define ERROR(...)                  WAVENET_PRINT_(ERROR,   true,      __VA_ARGS__)
+#define FCTERROR(...)               WAVENET_FCTPRINT_(ERROR,           __VA_ARGS__)
+#else
+#define ERROR(...)                  WAVENET_NOPRINT_()
+#define FCTERROR(...)               WAVENET_NOPRINT_()
+#endif
+
+#if WAVENET_LOG_LEVEL <= WAVENET_LEVEL_WARNING
+#define WARNING(...)                WAVENET_PRINT_(WARNING, true,      __VA_ARGS__)
+#define FCTWARNING(...)             WAVENET_FCTPRINT_(WARNING,         __VA_ARGS__)
+#else
+#define WARNING(...)                WAVENET_NOPRINT_()
+#define FCTWARNING(...)             WAVENET_NOPRINT_()
+#endif
+
+#if WAVENET_LOG_LEVEL <= WAVENET_LEVEL_INFO
+#define INFO(...)                   WAVENET_PRINT_(INFO,    true,      __VA_ARGS__)
+#define FCTINFO(...)                WAVENET_FCTPRINT_(INFO,            __VA_ARGS__)
+#else
+#define INFO(...)                   WAVENET_NOPRINT_()
+#define FCTINFO(...)                WAVENET_NOPRINT_()
+#endif
+
+#if WAVENET_LOG_LEVEL <= WAVENET_LEVEL_DEBUG
+#define DEBUG(...)                  WAVENET_PRINT_(DEBUG,   debug(),   __VA_ARGS__)
+#else
+#define DEBUG(...)                  WAVENET_NOPRINT_()
+#endif
+
+#if WAVENET_LOG_LEVEL <= WAVENET_LEVEL_VERBOSE
+#define VERBOSE(...)                WAVENET_PRINT_(VERBOSE, verbose(), __VA_ARGS__)
+#else
+#define VERBOSE(...)                WAVENET_NOPRINT_()
+#endif
 
 
 namespace wavenet {
@@ -43,10 +94,27 @@ namespace wavenet {
  * addition to 'ERROR', 'WARNING', and 'INFO' levels, which always print, each 
  * instance inheriting from Logger can be set to print 'DEBUG' and 'VERBOSE' 
  * statements as well.
+ *
+ * On top of this, a global print level can be set at run time, below which no 
+ * statements are printed, and a minimum print level can be set at compile time
+ * (WAVENET_LOG_LEVEL), below which the print statements are removed entirely.
  * 
  * Any function not called from within an instance inheriting from Logger can 
  * still print formatted 'ERROR', 'WARNING', and 'INFO' statements using the 
  * 'FCT...' macros.
+ *
+ * Statements are formatted into a thread-local buffer on the calling thread 
+ * and handed to a single background writer thread, which performs the actual 
+ * (blocking) output. The calling thread therefore never waits on the terminal, 
+ * and statements from several threads are never interleaved mid-line. The 
+ * demangled class names are cached per thread, so the demangling is only done
+ * once for each class. 'ERROR' statements, as well as calls to Logger::flush, 
+ * block until all pending statements have been written.
+ *
+ * The writer is fork-safe: a child process starts its own writer on first use,
+ * rather than queueing statements for the parent's writer thread, which doesn't
+ * exist in the child. After Logger::shutdown, statements are written 
+ * synchronously.
  */
 class Logger {
     
@@ -79,11 +147,40 @@ public:
     inline bool verbose () const { return m_verbose; }
 
 
+    /// Global print level method(s).
+    // Set the global, run-time print level. Statements below this level are 
+    // not printed, regardless of the instance-specific print levels.
+    static inline void setGlobalLevel (const int& level) {
+        s_globalLevel.store(level, std::memory_order_relaxed);
+        return;
+    }
+
+    // Returns the global, run-time print level.
+    static inline int globalLevel () {
+        return s_globalLevel.load(std::memory_order_relaxed);
+    }
+
+    // Whether statements at the given print level are printed.
+    static inline bool enabled (const int& level) {
+        return level >= WAVENET_LOG_LEVEL && level >= globalLevel();
+    }
+
+
     /// Public print method(s).
     // Variadic function, formatting the printed statment (format, ...) using 
     // the calling non-member function (fct) as well as the print level.
-    static void fctprint_ (std::string fun, std::string level, 
-                           std::string format, ...);
+    static void fctprint_ (const char* fun, const char* level, 
+                           const char* format, ...);
+
+    // Block until all statements handed to the background writer have been 
+    // written to stdout.
+    static void flush ();
+
+    // Write all pending statements and stop the background writer. Any later 
+    // statements are written synchronously by the calling thread. Called 
+    // automatically at exit, but can be called explicitly, e.g. before other
+    // static objects which may still log are destroyed.
+    static void shutdown ();
 
 
 protected:
@@ -92,8 +189,8 @@ protected:
     // Variadic function, formatting the printed statment (format, ...) using 
     // the calling class (cls) and member function (fct) as well as the print 
     // level.
-    void print_ (std::string cls, std::string fun, std::string level, 
-                 std::string format, ...) const;
+    void print_ (const std::type_info& cls, const char* fun, const char* level, 
+                 const char* format, ...) const;
     
 
 protected:
@@ -101,6 +198,9 @@ protected:
     /// Data member(s).
     bool m_debug   = false;
     bool m_verbose = false;
+
+    // Global, run-time print level. 
+    static std::atomic<int> s_globalLevel;
     
 };
 
@@ -12,6 +12,11 @@
 #include <cmath> /* pow */
 #include <cstdlib> /* abs */
 #include <algorithm> /* std::rotate */
+#include <string> /* std::string */
+#include <map> /* std::map */
+#include <utility> /* std::pair */
+#include <mutex> /* std::mutex */
+#include <atomic> /* std::atomic */
 
 // Armadillo include(s).
 #include <armadillo>
@@ -30,10 +35,23 @@ namespace wavenet {
  * from arma::Mat) given a set of filter coefficients. The methods for 
  * specifying the filter coefficients in purely virtual and need to be 
  * implemented by derived classes (low- and high-pass operators).
+ *
+ * The matrix operator can be constructed using one of several equivalent 
+ * strategies, the fastest of which depends on the operator size, the number 
+ * of filter coefficients, and the machine. By default, the strategy is chosen 
+ * by a process-wide autotuner, which times each strategy the first time a 
+ * given (number of filter coefficients, size) pair is constructed, and caches
+ * the fastest one as the plan for all subsequent constructions. The plans can 
+ * be persisted to, and loaded from, a tuning file, so as to skip the timing at
+ * start-up.
  */
 class MatrixOperator : public arma::Mat<double>, public Logger {
     
 public:
+
+    /// Construction strategies.
+    enum class Strategy { Rows, Indices, Direct };
+
     
     /// Constructor(s).
     MatrixOperator () {};
@@ -58,6 +76,8 @@ public:
     /// Get method(s).
     inline unsigned size () const { return m_size; }
     inline bool complete () const { return m_complete; }
+    // The strategy used for the latest construction of the matrix operator.
+    inline Strategy strategy () const { return m_strategy; }
 
 
     /// Operator construction method(s).
@@ -66,6 +86,42 @@ public:
     void construct ();
 
 
+    /// Autotuning method(s).
+    // Enable or disable the autotuner. If disabled, the construction strategy
+    // is chosen from fixed, empirical thresholds.
+    static inline void setAutotune (const bool& autotune) { s_autotune.store(autotune); return; }
+    static inline bool autotune () { return s_autotune.load(); }
+
+    // Get the construction strategy for operators with N filter coefficients
+    // and 2^size rows, timing the available strategies if no plan exists yet.
+    static Strategy plan (const unsigned& N, const unsigned& size);
+
+    // Time the available construction strategies for operators with N filter
+    // coefficients and 2^size rows, and store the fastest one as the plan.
+    static Strategy tune (const unsigned& N, const unsigned& size);
+
+    // Get all current plans, keyed by (N, size).
+    static std::map< std::pair<unsigned, unsigned>, Strategy > plans ();
+
+    // Remove all current plans.
+    static void clearPlans ();
+
+    // Print all current plans.
+    static void printPlans ();
+
+    // Load plans from, and save plans to, a tuning file. Each line in the file
+    // is of the form '<N> <size> <strategy>'.
+    static bool loadTuning (const std::string& filename);
+    static bool saveTuning (const std::string& filename);
+
+    // Set a tuning file, from which plans are loaded (if it exists), and to 
+    // which plans are saved whenever a new plan is found.
+    static void setTuningFile (const std::string& filename);
+
+    // Get the name of a construction strategy.
+    static std::string strategyName (const Strategy& strategy);
+
+
 protected:
 
     /// Internal set method(s).
@@ -83,6 +139,18 @@ protected:
 
     // Construct matrix operator by iterating filter indices.
     void constructByIndices_ ();
+
+    // Construct matrix operator by directly filling the (circulant) band of 
+    // non-zero entries in each row.
+    void constructDirect_ ();
+
+    // Construct matrix operator using the given strategy.
+    void construct_ (const Strategy& strategy);
+
+
+    /// Internal autotuning method(s).
+    // The construction strategy given by fixed, empirical thresholds.
+    static Strategy heuristic_ (const unsigned& N, const unsigned& size);
     
     
 protected:
@@ -99,6 +167,25 @@ protected:
     // and therefore whether it is ready to be constructed.
     bool m_complete = false;
 
+    // The strategy used for the latest construction of the matrix operator.
+    Strategy m_strategy = Strategy::Indices;
+
+
+private:
+
+    /// Static data member(s).
+    // Whether to use the autotuner when choosing the construction strategy.
+    static std::atomic<bool> s_autotune;
+
+    // The construction plans found by the autotuner, keyed by (N, size).
+    static std::map< std::pair<unsigned, unsigned>, Strategy > s_plans;
+
+    // Mutex protecting the plans and tuning file.
+    static std::mutex s_mutex;
+
+    // The tuning file to which plans are saved, if any.
+    static std::string s_tuningFile;
+
 
 };
 
@@ -0,0 +1,152 @@
+#ifndef WAVENET_METRICS_H
+#define WAVENET_METRICS_H
+
+/**
+ * @file   Metrics.h
+ * @brief  Class for collecting throughput and memory metrics during training.
+ */
+
+// STL include(s).
+#include <string> /* std::string */
+#include <atomic> /* std::atomic */
+#include <chrono> /* std::chrono::steady_clock */
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h"
+
+
+namespace wavenet {
+
+/**
+ * Class for collecting throughput and memory metrics during training.
+ *
+ * All counters are atomic and updated with relaxed memory ordering, such that
+ * the metrics can be updated from the hot training loop (and from several
+ * threads) at the cost of a single uncontended atomic operation, and be read at
+ * any time, e.g. to be written periodically to a CSV or JSON file. Rates are
+ * computed with respect to the time of construction, or the last reset.
+ *
+ * Each Wavenet instance owns a Metrics instance, which is updated by the
+ * Wavenet itself (examples, updates, activation memory, cache usage, snapshot
+ * writes, and roll-backs of diverging updates) and by the Coach (generator 
+ * wait time).
+ */
+class Metrics : public Logger {
+
+public:
+
+    /// Constructor(s).
+    Metrics () :
+        m_start(std::chrono::steady_clock::now())
+    {};
+
+    Metrics (const Metrics& other) { *this = other; };
+
+
+    /// Destructor.
+    ~Metrics () {};
+
+
+    /// Assignment operator(s).
+    Metrics& operator= (const Metrics& other);
+
+
+    /// Update method(s).
+    // Count a single training example.
+    inline void addExample () { m_examples.fetch_add(1, std::memory_order_relaxed); return; }
+    // Count a single update of the filter coefficients.
+    inline void addUpdate () { m_updates.fetch_add(1, std::memory_order_relaxed); return; }
+    // Add time spent waiting for the generator.
+    inline void addGeneratorWait (const unsigned long long& ns) { m_generatorWaitNs.fetch_add(ns, std::memory_order_relaxed); return; }
+    // Count a single look-up of cached operators or weights which didn't
+    // trigger a rebuild.
+    inline void addCacheHit () { m_cacheHits.fetch_add(1, std::memory_order_relaxed); return; }
+    // Count a single (re-)build of the cached operators or weights.
+    inline void addCacheRebuild () { m_cacheRebuilds.fetch_add(1, std::memory_order_relaxed); return; }
+    // Add a single snapshot write, with its latency.
+    inline void addSnapshotWrite (const unsigned long long& ns) {
+        m_snapshotWrites.fetch_add(1, std::memory_order_relaxed);
+        m_snapshotWriteNs.fetch_add(ns, std::memory_order_relaxed);
+        return;
+    }
+    // Count a single roll-back of a diverging update, with the number of 
+    // examples in the discarded batch.
+    inline void addRollback (const unsigned long long& discarded) {
+        m_rollbacks.fetch_add(1, std::memory_order_relaxed);
+        m_discardedExamples.fetch_add(discarded, std::memory_order_relaxed);
+        return;
+    }
+    // Register the number of bytes currently held in activations, and update
+    // the peak value accordingly.
+    void setActivationBytes (const unsigned long long& bytes);
+
+    // Reset all counters and the reference time.
+    void reset ();
+
+    // Add the counters of another instance, trained on the same examples, e.g.
+    // in fan-out training. The generator wait time, which is shared by all 
+    // instances, is the largest of the two, and the reference time is the 
+    // earliest. The activation bytes are summed, such that the peak value is 
+    // an upper bound.
+    void merge (const Metrics& other);
+
+
+    /// Get method(s).
+    inline unsigned long long examples        () const { return m_examples       .load(std::memory_order_relaxed); }
+    inline unsigned long long updates         () const { return m_updates        .load(std::memory_order_relaxed); }
+    inline unsigned long long generatorWaitNs () const { return m_generatorWaitNs.load(std::memory_order_relaxed); }
+    inline unsigned long long cacheHits       () const { return m_cacheHits      .load(std::memory_order_relaxed); }
+    inline unsigned long long cacheRebuilds   () const { return m_cacheRebuilds  .load(std::memory_order_relaxed); }
+    inline unsigned long long snapshotWrites  () const { return m_snapshotWrites .load(std::memory_order_relaxed); }
+    inline unsigned long long snapshotWriteNs () const { return m_snapshotWriteNs.load(std::memory_order_relaxed); }
+    inline unsigned long long activationBytes () const { return m_activationBytes.load(std::memory_order_relaxed); }
+    inline unsigned long long peakActivationBytes () const { return m_peakActivationBytes.load(std::memory_order_relaxed); }
+    inline unsigned long long rollbacks         () const { return m_rollbacks        .load(std::memory_order_relaxed); }
+    inline unsigned long long discardedExamples () const { return m_discardedExamples.load(std::memory_order_relaxed); }
+
+    // Seconds elapsed since construction or the last reset.
+    double elapsed () const;
+    // Training examples processed per second.
+    double examplesPerSecond () const;
+    // Filter coefficient updates per second.
+    double updatesPerSecond () const;
+    // Mean snapshot write latency, in milliseconds.
+    double meanSnapshotWriteMs () const;
+
+
+    /// Output method(s).
+    // Print all metrics.
+    void print () const;
+
+    // Append a single line with the current metrics to a CSV file. A header
+    // line is written if the file doesn't already exist.
+    bool writeCSV (const std::string& filename) const;
+
+    // Write the current metrics to a JSON file.
+    bool writeJSON (const std::string& filename) const;
+
+
+private:
+
+    /// Data member(s).
+    // Reference time point, for computing rates.
+    std::chrono::steady_clock::time_point m_start;
+
+    // Counters.
+    std::atomic<unsigned long long> m_examples            {0};
+    std::atomic<unsigned long long> m_updates             {0};
+    std::atomic<unsigned long long> m_generatorWaitNs     {0};
+    std::atomic<unsigned long long> m_cacheHits           {0};
+    std::atomic<unsigned long long> m_cacheRebuilds       {0};
+    std::atomic<unsigned long long> m_snapshotWrites      {0};
+    std::atomic<unsigned long long> m_snapshotWriteNs     {0};
+    std::atomic<unsigned long long> m_activationBytes     {0};
+    std::atomic<unsigned long long> m_peakActivationBytes {0};
+    std::atomic<unsigned long long> m_rollbacks           {0};
+    std::atomic<unsigned long long> m_discardedExamples   {0};
+
+};
+
+} // namespace
+
+#endif // WAVENET_METRICS_H
@@ -0,0 +1,202 @@
+#ifndef WAVENET_PROFILER_H
+#define WAVENET_PROFILER_H
+
+/**
+ * @file   Profiler.h
+ * @brief  Scoped timers for profiling the main stages of the training.
+ */
+
+// STL include(s).
+#include <string> /* std::string */
+#include <vector> /* std::vector */
+#include <memory> /* std::unique_ptr */
+#include <mutex> /* std::mutex */
+#include <atomic> /* std::atomic */
+#include <chrono> /* std::chrono::steady_clock */
+#include <unordered_map> /* std::unordered_map */
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h"
+
+
+/// Profiling macro(s).
+// Time the enclosing scope under 'name', which must be a string literal. The
+// timers are only compiled in if USE_PROFILER is defined (e.g. through
+// '$ make PROFILE=1'); otherwise the macro compiles to nothing.
+#define WAVENET_CONCAT_(a, b) a ## b
+#define WAVENET_CONCAT(a, b)  WAVENET_CONCAT_(a, b)
+#ifdef USE_PROFILER
+#define PROFILE(name) wavenet::ScopedTimer WAVENET_CONCAT(scopedTimer_, __LINE__) (name)
+#else
+#define PROFILE(name)
+#endif // USE_PROFILER
+
+
+namespace wavenet {
+
+/**
+ * Singleton class collecting the timing information from all scoped timers.
+ *
+ * Each thread accumulates the number of calls and the total, minimal, and
+ * maximal time spent in each timed scope in its own set of counters, such that
+ * the threads never contend with each other. The counters are merged when the
+ * summary is printed or exported. If tracing is enabled, each individual timed
+ * scope is furthermore stored as an event, such that the full timeline can be
+ * exported to the Chrome trace format (chrome://tracing).
+ *
+ * The profiler is disabled by default. When disabled, each scoped timer costs a
+ * single branch.
+ */
+class Profiler : public Logger {
+
+public:
+
+    /// Utility struct(s).
+    // Accumulated timing information for a single timed scope.
+    struct Counter {
+        unsigned long long calls   = 0;
+        unsigned long long totalNs = 0;
+        unsigned long long minNs   = (unsigned long long)(-1);
+        unsigned long long maxNs   = 0;
+    };
+
+    // Single timed scope, for tracing.
+    struct Event {
+        const char* name;
+        unsigned long long startNs;
+        unsigned long long durationNs;
+    };
+
+    // Counters and events for a single thread.
+    struct ThreadData {
+        unsigned id = 0;
+        std::mutex mutex;
+        std::unordered_map<const char*, Counter> counters;
+        std::vector<Event> events;
+    };
+
+
+    /// Get method(s).
+    // Returns the singleton instance.
+    static Profiler& instance ();
+
+    // Whether the scoped timers are recording.
+    static inline bool enabled () { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Whether individual events are stored for tracing.
+    static inline bool tracing () { return s_tracing.load(std::memory_order_relaxed); }
+
+
+    /// Set method(s).
+    // Enable or disable the scoped timers.
+    static inline void setEnabled (const bool& enabled = true) { s_enabled.store(enabled); return; }
+
+    // Enable or disable the storing of individual events. Note that this grows
+    // memory linearly with the number of timed scopes.
+    static inline void setTracing (const bool& tracing = true) { s_tracing.store(tracing); return; }
+
+
+    /// Recording method(s).
+    // Add a single timed scope to the counters of the calling thread.
+    void record (const char* name, const unsigned long long& startNs, const unsigned long long& durationNs);
+
+    // Clear all counters and events.
+    void reset ();
+
+    // Nanoseconds since the construction of the profiler.
+    unsigned long long now () const;
+
+
+    /// Output method(s).
+    // Counters merged across all threads, ordered by decreasing total time.
+    std::vector< std::pair<std::string, Counter> > merged ();
+
+    // Print a summary table of the merged counters.
+    void summary ();
+
+    // Write the merged counters to a JSON file.
+    bool exportJSON (const std::string& filename);
+
+    // Write the stored events to a file in the Chrome trace format.
+    bool exportChromeTrace (const std::string& filename);
+
+
+private:
+
+    /// Constructor(s).
+    // Private, since the class is a singleton.
+    Profiler () :
+        m_start(std::chrono::steady_clock::now())
+    {};
+
+
+    /// Internal method(s).
+    // Returns the counters and events of the calling thread, registering these
+    // with the profiler on first use.
+    ThreadData& threadData_ ();
+
+
+private:
+
+    /// Data member(s).
+    // Whether the scoped timers are recording.
+    static std::atomic<bool> s_enabled;
+
+    // Whether individual events are stored for tracing.
+    static std::atomic<bool> s_tracing;
+
+    // Reference time point.
+    std::chrono::steady_clock::time_point m_start;
+
+    // Mutex guarding the list of threads.
+    std::mutex m_mutex;
+
+    // Counters and events for all threads which have recorded timings.
+    std::vector< std::unique_ptr<ThreadData> > m_threads;
+
+};
+
+
+/**
+ * RAII timer, recording the time spent between its construction and
+ * destruction with the Profiler.
+ *
+ * Should be used through the PROFILE(name) macro, such that the timers can be
+ * compiled out entirely.
+ */
+class ScopedTimer {
+
+public:
+
+    /// Constructor(s).
+    ScopedTimer (const char* name) :
+        m_name(Profiler::enabled() ? name : nullptr)
+    {
+        if (m_name) { m_start = Profiler::instance().now(); }
+    };
+
+
+    /// Destructor.
+    ~ScopedTimer () {
+        if (m_name) {
+            Profiler& profiler = Profiler::instance();
+            profiler.record(m_name, m_start, profiler.now() - m_start);
+        }
+    };
+
+
+private:
+
+    /// Data member(s).
+    // Name of the timed scope. Null if the profiler was disabled on
+    // construction.
+    const char* m_name;
+
+    // Start time, in nanoseconds since the construction of the profiler.
+    unsigned long long m_start = 0;
+
+};
+
+} // namespace
+
+#endif // WAVENET_PROFILER_H
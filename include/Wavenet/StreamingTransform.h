@@ -0,0 +1,243 @@
+#ifndef WAVENET_STREAMINGTRANSFORM_H
+#define WAVENET_STREAMINGTRANSFORM_H
+
+/**
+ * @file   StreamingTransform.h
+ * @brief  Classes for the online 1D wavenet transform of continuous streams.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <deque> /* std::deque */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h"
+#include "Wavenet/Logger.h"
+#include "Wavenet/Wavenet.h"
+
+
+namespace wavenet {
+
+/**
+ * Single wavelet coefficient emitted by the StreamingTransform.
+ *
+ * Scale 0 is the finest scale, at which one high-pass coefficient is emitted
+ * for every two input samples; at scale s, one is emitted for every 2^{s + 1}
+ * input samples. Low-pass coefficients are only emitted at the coarsest scale.
+ */
+struct StreamingCoefficient {
+    unsigned scale;  // Scale of the coefficient, 0 being the finest.
+    long     index;  // Index of the coefficient within its scale.
+    double   value;  // Value of the coefficient.
+    bool     lowpass; // Whether this is a low-pass (average) coefficient.
+};
+
+
+/**
+ * Online 1D wavenet transform of a continuous stream of samples.
+ *
+ * Rather than the periodic transform of independent, fixed-size examples,
+ * the stream is transformed by the non-periodic cascade of low- and high-pass
+ * filters, using the same filter coefficients and the same indexing as the
+ * level operators: the output r at each scale is sum_k g_k u(2r + N/2 - k),
+ * where u is the input at that scale (the stream itself, or the low-pass
+ * output of the finer scale), and samples before the start of the stream are
+ * zero. Away from the boundaries of a window, the coefficients are therefore
+ * identical to those of the periodic transform.
+ *
+ * Samples are pushed in chunks of any size, and each coefficient is emitted
+ * as soon as the dyadic window on which it depends is complete. Only the
+ * latest N inputs at each scale are kept, such that the state is O(N * levels)
+ * and the latency at each scale is fixed, independently of the length of the
+ * stream. When the stream ends, 'flush' pads it with zeros until all
+ * coefficients depending on the stream have been emitted.
+ */
+class StreamingTransform : public Logger {
+
+public:
+
+    /// Constructor(s).
+    StreamingTransform () {};
+
+    StreamingTransform (const arma::Col<double>& filter, const unsigned& numLevels)
+    { init(filter, numLevels); };
+
+    StreamingTransform (const Wavenet& wavenet, const unsigned& numLevels)
+    { init(wavenet.filter(), numLevels); };
+
+
+    /// Destructor.
+    ~StreamingTransform () {};
+
+
+    /// Initialisation method(s).
+    // (Re-)initialise the transform with the given filter coefficients and
+    // number of levels (scales).
+    bool init (const arma::Col<double>& filter, const unsigned& numLevels);
+
+    // Reset the transform to the beginning of a new stream.
+    void reset ();
+
+
+    /// Get method(s).
+    inline bool     valid      () const { return m_valid; }
+    inline unsigned numLevels  () const { return m_scales.size(); }
+    // Returns the number of samples pushed since the beginning of the stream.
+    inline long     numSamples () const { return m_numSamples; }
+
+
+    /// Streaming method(s).
+    // Push a chunk of samples to the stream, appending the completed
+    // coefficients to 'coefficients'.
+    bool push (const arma::Col<double>& samples, std::vector<StreamingCoefficient>& coefficients);
+
+    // End the stream, appending all remaining coefficients to 'coefficients',
+    // and reset the transform.
+    bool flush (std::vector<StreamingCoefficient>& coefficients);
+
+
+protected:
+
+    /// Internal type(s).
+    // State of the transform at a single scale.
+    struct Scale {
+        std::vector<double> history; // The latest N inputs, indexed by t mod N.
+        long start = 0;              // Index of the first input.
+        long next  = 0;              // Index of the next input.
+    };
+
+
+    /// Internal method(s).
+    // Push a single input to the given scale, propagating low-pass outputs to
+    // coarser scales.
+    void push_ (const unsigned& s, const double& value, std::vector<StreamingCoefficient>& coefficients);
+
+
+private:
+
+    /// Data member(s).
+    bool m_valid = false;
+    long m_numSamples = 0;
+
+    // The low- and high-pass filter coefficients.
+    std::vector<double> m_lowpass;
+    std::vector<double> m_highpass;
+
+    // The state at each scale.
+    std::vector<Scale> m_scales;
+
+};
+
+
+/**
+ * Online inverse of the StreamingTransform.
+ *
+ * Coefficients are pushed in the order in which they are emitted by the
+ * StreamingTransform, and reconstructed samples are appended to the output as
+ * soon as all coefficients contributing to them, and to the following sample,
+ * have been received. (The additional sample of delay ensures that no samples
+ * reconstructing the zero padding of a flushed transform are emitted before
+ * the total number of samples is given in 'flush'.) For
+ * orthonormal filters, the reconstruction is exact. The high-pass
+ * coefficients at each scale are buffered until the corresponding low-pass
+ * inputs have been reconstructed from the coarser scales, such that the state,
+ * like the latency, is O(N * 2^{levels}), independently of the length of the
+ * stream.
+ */
+class StreamingInverse : public Logger {
+
+public:
+
+    /// Constructor(s).
+    StreamingInverse () {};
+
+    StreamingInverse (const arma::Col<double>& filter, const unsigned& numLevels)
+    { init(filter, numLevels); };
+
+    StreamingInverse (const Wavenet& wavenet, const unsigned& numLevels)
+    { init(wavenet.filter(), numLevels); };
+
+
+    /// Destructor.
+    ~StreamingInverse () {};
+
+
+    /// Initialisation method(s).
+    // (Re-)initialise the inverse with the given filter coefficients and
+    // number of levels (scales).
+    bool init (const arma::Col<double>& filter, const unsigned& numLevels);
+
+    // Reset the inverse to the beginning of a new stream.
+    void reset ();
+
+
+    /// Get method(s).
+    inline bool     valid      () const { return m_valid; }
+    inline unsigned numLevels  () const { return m_scales.size(); }
+    // Returns the number of samples reconstructed since the beginning of the
+    // stream.
+    inline long     numSamples () const { return m_numSamples; }
+
+
+    /// Streaming method(s).
+    // Push coefficients, appending the completed, reconstructed samples to
+    // 'samples'.
+    bool push (const std::vector<StreamingCoefficient>& coefficients, std::vector<double>& samples);
+
+    // End the stream, appending all remaining samples to 'samples', up to a
+    // total of 'numSamples' since the beginning of the stream (if
+    // non-negative), and reset the inverse. Without this limit, the samples
+    // reconstructing the zero padding of the flushed transform are included.
+    bool flush (std::vector<double>& samples, const long& numSamples = -1);
+
+
+protected:
+
+    /// Internal type(s).
+    // State of the inverse at a single scale.
+    struct Scale {
+        std::deque<double> low;  // Pending low-pass inputs.
+        std::deque<double> high; // Pending high-pass coefficients.
+        std::deque<double> accumulated; // Partially reconstructed outputs.
+        long start = 0;       // Index of the first output.
+        long next  = 0;       // Index of the next pair of low- and high-pass inputs.
+        long accumulatedStart = 0; // Index of the first partially reconstructed output.
+    };
+
+
+    /// Internal method(s).
+    // Process all complete pairs of inputs at the given scale, emitting the
+    // completed outputs to the finer scale, or to 'samples'.
+    void process_ (const unsigned& s, std::vector<double>& samples);
+
+    // Emit a single, completed output at the given scale.
+    void emit_ (const unsigned& s, const long& index, const double& value, std::vector<double>& samples);
+
+
+private:
+
+    /// Data member(s).
+    bool m_valid = false;
+    long m_numSamples = 0;
+    long m_maxSamples = -1;
+
+    // The latest reconstructed sample, held back until the next one is
+    // completed.
+    bool   m_hasPending = false;
+    double m_pending    = 0;
+
+    // The low- and high-pass filter coefficients.
+    std::vector<double> m_lowpass;
+    std::vector<double> m_highpass;
+
+    // The state at each scale.
+    std::vector<Scale> m_scales;
+
+};
+
+} // namespace
+
+#endif // WAVENET_STREAMINGTRANSFORM_H
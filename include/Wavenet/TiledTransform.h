@@ -0,0 +1,158 @@
+#ifndef WAVENET_TILEDTRANSFORM_H
+#define WAVENET_TILEDTRANSFORM_H
+
+/**
+ * @file   TiledTransform.h
+ * @brief  Class for the tiled 2D wavenet transform of oversized images.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <functional> /* std::function */
+#include <algorithm> /* std::max */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h"
+#include "Wavenet/Logger.h"
+#include "Wavenet/Wavenet.h"
+
+
+namespace wavenet {
+
+/**
+ * Class for the tiled 2D wavenet transform of oversized images.
+ *
+ * The 2D transform is performed, as in Wavenet, by transforming all rows and
+ * then all columns of the result. Along each axis, the image is split into
+ * tiles of 'tileSize' x 'tileSize' entries, and the first 'tileLevels' levels
+ * of the 1D transforms are computed independently for each tile. Since the
+ * outputs of each level depend on N/2 - 1 inputs on either side, each tile is
+ * extended by a halo of (N/2 - 1) * (2^{tileLevels} - 1) entries, which are
+ * read from the neighbouring tiles (or the boundary). The high-pass
+ * coefficients are written directly to their positions in the global
+ * coefficient matrix, and the remaining low-pass coefficients, a factor
+ * 2^{tileLevels} fewer, are gathered and transformed through the remaining
+ * levels.
+ *
+ * The stitched coefficients are identical to those of the global transform
+ * for the chosen boundary mode:
+ *   Periodic: The image wraps around at the boundary, as in Wavenet and
+ *             TransformPlan.
+ *   Zero:     The image, and the low-pass outputs at each level, are zero
+ *             outside the boundary, i.e. the level operators are truncated
+ *             rather than wrapped.
+ *
+ * The tiles along each axis are processed in parallel, using up to
+ * 'numThreads' threads, each of which only needs a working set of about one
+ * tile, plus halo. Since the threads are started for each pass along an axis,
+ * a pass only uses as many threads as it has blocks of s_minWorkPerThread
+ * input entries, such that small images are transformed on the calling
+ * thread, without the cost of starting threads.
+ */
+class TiledTransform : public Logger {
+
+public:
+
+    /// Boundary mode(s).
+    enum class Boundary { Periodic, Zero };
+
+
+    /// Constructor(s).
+    TiledTransform () {};
+
+    TiledTransform (const arma::Col<double>& filter, const unsigned& tileSize, const unsigned& tileLevels,
+                    const Boundary& boundary = Boundary::Periodic)
+    { init(filter, tileSize, tileLevels, boundary); };
+
+    TiledTransform (const Wavenet& wavenet, const unsigned& tileSize, const unsigned& tileLevels,
+                    const Boundary& boundary = Boundary::Periodic)
+    { init(wavenet.filter(), tileSize, tileLevels, boundary); };
+
+
+    /// Destructor.
+    ~TiledTransform () {};
+
+
+    /// Initialisation method(s).
+    // (Re-)initialise the transform with the given filter coefficients, tile
+    // size, number of levels computed per tile, and boundary mode.
+    bool init (const arma::Col<double>& filter, const unsigned& tileSize, const unsigned& tileLevels,
+               const Boundary& boundary = Boundary::Periodic);
+
+
+    /// Get method(s).
+    inline bool     valid      () const { return m_valid; }
+    inline unsigned tileSize   () const { return m_tileSize; }
+    inline unsigned tileLevels () const { return m_tileLevels; }
+    inline Boundary boundary   () const { return m_boundary; }
+    inline unsigned numThreads () const { return m_numThreads; }
+
+    // Returns the width of the halo on either side of each tile.
+    unsigned halo () const;
+
+
+    /// Set method(s).
+    // Set the number of threads used to process tiles.
+    inline void setNumThreads (const unsigned& numThreads) { m_numThreads = std::max(numThreads, 1u); return; }
+
+
+    /// Transform method(s).
+    // Forward transform the image X, yielding the matrix of wavelet
+    // coefficients Y. Both dimensions of X must be radix 2.
+    bool forward (const arma::Mat<double>& X, arma::Mat<double>& Y) const;
+
+
+protected:
+
+    /// Internal constant(s).
+    // Minimal number of input entries processed per thread.
+    static constexpr unsigned long long s_minWorkPerThread = 1ULL << 16;
+
+
+    /// Internal method(s).
+    // Transform all 1D lines of 'in' along one axis (the rows if 'alongRows',
+    // and otherwise the columns), storing the coefficients in 'out'.
+    void transformAxis_ (const arma::Mat<double>& in, arma::Mat<double>& out, const bool& alongRows) const;
+
+    // Gather the entries [begin, begin + length) of a line of length n, with
+    // the given stride, into 'ext', applying the boundary mode.
+    void gather_ (const double* line, const long& stride, const long& n,
+                  const long& begin, const long& length, std::vector<double>& ext) const;
+
+    // Compute 'levels' levels of the 1D transform of a line of length n, for
+    // the segment [begin, begin + width), from the inputs in 'ext', covering
+    // the segment and the halo. The high-pass coefficients are written to
+    // their global positions in 'coeffs', and the low-pass coefficients after
+    // the last level to 'coarse', both with the given stride. 'buffer' is
+    // used as scratch memory.
+    void segment_ (std::vector<double>& ext, std::vector<double>& buffer,
+                   const long& n, const long& begin, const long& width, const unsigned& levels,
+                   double* coeffs, const long& coeffStride, double* coarse, const long& coarseStride) const;
+
+    // Call fun(i) for i = 0, ..., count - 1, distributed over the threads,
+    // where 'work' is the total number of input entries processed.
+    void parallelFor_ (const unsigned& count, const unsigned long long& work,
+                       const std::function<void(unsigned)>& fun) const;
+
+
+private:
+
+    /// Data member(s).
+    bool m_valid = false;
+    unsigned m_tileSize = 0;
+    unsigned m_tileLevels = 0;
+    Boundary m_boundary = Boundary::Periodic;
+    unsigned m_numThreads = 1;
+
+    // The low- and high-pass filter coefficients.
+    std::vector<double> m_lowpass;
+    std::vector<double> m_highpass;
+
+};
+
+} // namespace
+
+#endif // WAVENET_TILEDTRANSFORM_H
@@ -0,0 +1,314 @@
+#ifndef WAVENET_TRANSFORMPLAN_H
+#define WAVENET_TRANSFORMPLAN_H
+
+/**
+ * @file   TransformPlan.h
+ * @brief  Class for executing the wavenet transform for a fixed shape.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <limits> /* std::numeric_limits */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h"
+#include "Wavenet/Logger.h"
+#include "Wavenet/Profiler.h"
+
+
+namespace wavenet {
+
+/**
+ * Class for executing the wavenet transform for a fixed shape.
+ *
+ * In the same spirit as FFTW plans, a TransformPlan is created once for a given
+ * input shape, number of filter coefficients, and mode, and can then be
+ * executed any number of times, for any set of filter coefficients of that
+ * length, without per-call setup. On creation, the plan precomputes the sizes
+ * of each level of the transform along each axis, the offsets of the stored
+ * low-pass activations in the scratch memory, and the range of rows in each
+ * level operator for which the banded kernel doesn't need to wrap around. It
+ * owns all scratch memory used during execution, such that no memory is
+ * allocated when executing the plan on input of the planned shape.
+ *
+ * Rather than multiplying by dense matrix operators, the plan applies the
+ * filters directly: row r of the level operator with 2^{i + 1} columns has the
+ * coefficient g_k in column (N/2 + 2r - k) mod 2^{i + 1}, where N is the number
+ * of filter coefficients. The results are identical to those of
+ * Wavenet::forward_, Wavenet::inverse_, and Wavenet::backpropagate_, up to the
+ * order of floating point summation.
+ *
+ * In 'Train' mode, the low-pass activations from the latest forward pass are
+ * stored, such that the backward pass can be executed afterwards. In
+ * 'Transform' mode, only the forward and inverse passes are available, and the
+ * memory for the activations is not allocated.
+ *
+ * Storing all low-pass activations takes about twice the size of the input
+ * along each axis, i.e. about four times the input size in total. The memory
+ * can be traded for computation using the checkpoint interval, k:
+ *   k = 1: The low-pass inputs to all levels are stored (default).
+ *   k > 1: Only the inputs to every k'th level, starting from the input to the
+ *          1D transform, are stored. The remaining levels are recomputed from
+ *          the nearest stored level during the backward pass, such that each
+ *          level is recomputed at most once. For k >= log2(size), only the
+ *          input to each row and column transform is stored, i.e. about twice
+ *          the input size in total.
+ *   k = 0: Only the input matrix is stored. The row transforms and all column
+ *          activations are recomputed during the backward pass, at the cost of
+ *          about one additional forward pass.
+ *
+ * In 'Invertible' mode, no activations are stored at all. If the filter is
+ * orthonormal, the transform is its own inverse (transposed), such that the
+ * low-pass inputs to each level can be reconstructed exactly from the wavelet
+ * coefficients, level by level, in the same order in which the backward pass
+ * visits them. The backward pass then needs the coefficients from the latest
+ * forward pass, and costs about one additional inverse transform. Since the
+ * reconstruction is only exact for orthonormal filters, the error with which
+ * the activations would be reconstructed is measured whenever the filter is
+ * set: a fixed probe input, with entries in [-1, 1], is forward and then
+ * inverse transformed along each axis, and the result is compared to the 
+ * probe. If this drift, the largest absolute difference, exceeds the 
+ * tolerance, the plan falls back to storing the activations, as in 'Train' 
+ * mode with the given checkpoint interval.
+ */
+class TransformPlan : public Logger {
+
+public:
+
+    /// Execution mode(s).
+    enum class Mode { Transform, Train, Invertible };
+
+
+    /// Constructor(s).
+    TransformPlan () {};
+
+    TransformPlan (const std::vector<unsigned>& shape, const unsigned& filterLength, const Mode& mode = Mode::Train,
+                   const unsigned& checkpointInterval = 1)
+    { init(shape, filterLength, mode, checkpointInterval); };
+
+
+    /// Destructor.
+    ~TransformPlan () {};
+
+
+    /// Planning method(s).
+    // (Re-)initialise the plan for input of the given shape, {nRows, nCols},
+    // number of filter coefficients, and checkpoint interval.
+    bool init (const std::vector<unsigned>& shape, const unsigned& filterLength, const Mode& mode = Mode::Train,
+               const unsigned& checkpointInterval = 1);
+
+    // Whether the plan was created for the given configuration.
+    bool matches (const std::vector<unsigned>& shape, const unsigned& filterLength, const Mode& mode = Mode::Train,
+                  const unsigned& checkpointInterval = 1) const;
+
+    // Set the (low-pass) filter coefficients with which to execute the plan.
+    // In 'Invertible' mode, this also determines whether the activations can
+    // be reconstructed from the wavelet coefficients.
+    bool setFilter (const arma::Col<double>& filter);
+
+    // Set the maximal reconstruction error for which the activations are 
+    // reconstructed in 'Invertible' mode.
+    inline void setTolerance (const double& tolerance) { m_tolerance = tolerance; return; }
+
+
+    /// Get method(s).
+    inline bool     valid        () const { return m_valid; }
+    inline unsigned nRows        () const { return m_nRows; }
+    inline unsigned nCols        () const { return m_nCols; }
+    inline unsigned filterLength () const { return m_filterLength; }
+    inline Mode     mode         () const { return m_mode; }
+    inline unsigned checkpointInterval () const { return m_checkpointInterval; }
+    inline double   tolerance    () const { return m_tolerance; }
+
+    // Reconstruction error of the forward-then-inverse transform of the probe
+    // input with the current filter. Only measured in 'Invertible' mode.
+    inline double drift () const { return m_drift; }
+    // Whether the backward pass reconstructs the activations from the wavelet
+    // coefficients, i.e. 'Invertible' mode with drift within the tolerance.
+    inline bool reconstructs () const { return m_mode == Mode::Invertible && !m_fallback; }
+
+    // Number of bytes used to store activations for the backward pass.
+    unsigned long long activationBytes () const;
+
+    // Total number of bytes of scratch memory owned by the plan.
+    unsigned long long scratchBytes () const;
+
+
+    /// Execution method(s).
+    // Forward transform the input matrix X, yielding the matrix of wavelet
+    // coefficients Y. In 'Train' mode, the activations are stored for use in
+    // a subsequent backward pass.
+    bool forward (const arma::Mat<double>& X, arma::Mat<double>& Y);
+
+    // Inverse transform the matrix of wavelet coefficients Y, yielding the
+    // position space matrix X.
+    bool inverse (const arma::Mat<double>& Y, arma::Mat<double>& X);
+
+    // Backpropagate the errors Delta on the wavelet coefficients from the
+    // latest forward pass, yielding the gradient of the filter coefficients.
+    // Only available in 'Train' mode, or in 'Invertible' mode if the plan has
+    // fallen back to storing the activations.
+    bool backward (const arma::Mat<double>& Delta, arma::Col<double>& gradient);
+
+    // Backpropagate as above, given also the wavelet coefficients Y from the
+    // latest forward pass, from which the activations are reconstructed in
+    // 'Invertible' mode. In other modes, Y is not used.
+    bool backward (const arma::Mat<double>& Y, const arma::Mat<double>& Delta, arma::Col<double>& gradient);
+
+
+protected:
+
+    /// Internal type(s).
+    // A single level of the 1D transform, mapping 2^{i + 1} inputs to 2^{i}
+    // low-pass and 2^{i} high-pass outputs.
+    struct Level {
+        unsigned rows;   // Number of outputs of each filter, 2^{i}.
+        unsigned cols;   // Number of inputs, 2^{i + 1}.
+        unsigned mask;   // Bit mask for taking indices modulo 'cols'.
+        unsigned begin;  // First row for which no wrap-around is needed.
+        unsigned end;    // One past the last row for which no wrap-around is needed.
+        unsigned offset; // Offset of the level inputs within the full activations.
+        bool     stored; // Whether the level inputs are stored (checkpointed).
+        unsigned storedOffset; // Offset of the level inputs within the stored activations.
+    };
+
+    // The levels of the 1D transform along a single axis.
+    struct Axis {
+        unsigned length = 1;        // Length of the 1D input, 2^{m}.
+        std::vector<Level> levels;  // Levels 0, ..., m - 1.
+        unsigned activationSize = 0; // Number of stored activations per 1D transform.
+        unsigned fullSize = 0;       // Number of activations per 1D transform.
+    };
+
+    // Checkpoint intervals for which only the input to the 1D transform, or
+    // no levels at all, are stored (@see planAxis_).
+    static constexpr unsigned s_inputOnly = std::numeric_limits<unsigned>::max();
+    static constexpr unsigned s_none      = 0;
+
+
+    /// Internal planning method(s).
+    // Precompute the levels of the 1D transform of input of the given length,
+    // storing the inputs to every 'interval'th level, counted from the top.
+    Axis planAxis_ (const unsigned& length, const unsigned& interval) const;
+
+    // Allocate the memory for the stored activations.
+    void allocateActivations_ ();
+
+
+    /// Internal kernel method(s).
+    // Apply the level operator with coefficients g to 'in', storing the result
+    // in 'out'.
+    void apply_ (const Level& level, const double* g, const double* in, double* out) const;
+
+    // Apply the transposed level operator with coefficients g to 'in', adding
+    // the result to 'out'.
+    void applyTransposed_ (const Level& level, const double* g, const double* in, double* out) const;
+
+    // Add the correlation of the errors 'delta' on the level outputs with the
+    // level inputs 'in' to 'corr', i.e. corr(k) += sum_r delta(r) in(c(r, k)).
+    void correlate_ (const Level& level, const double* delta, const double* in, double* corr) const;
+
+    // 1D forward transform of x into y, storing the checkpointed low-pass
+    // activations in 'activations' if non-null. 'x' may point to the beginning
+    // of the highest-level activations, in which case no copy is made.
+    void forward1D_ (const Axis& axis, const double* x, double* y, double* activations);
+
+    // Restore the full low-pass activations of a 1D transform from the stored
+    // ones, recomputing the levels which are not stored. If the input to the
+    // 1D transform is not stored, it must already be present in 'full'.
+    // Returns a pointer to the full activations, which is 'stored' itself if
+    // all levels are stored.
+    const double* restore1D_ (const Axis& axis, const double* stored, double* full);
+
+    // 1D inverse transform of y into x.
+    void inverse1D_ (const Axis& axis, const double* y, double* x);
+
+    // 1D backward pass of the errors delta, using the stored low-pass
+    // activations, yielding the errors on the input, 'error'.
+    void backward1D_ (const Axis& axis, const double* delta, const double* activations, double* error);
+
+    // 1D backward pass of the errors delta, reconstructing the low-pass
+    // activations from the wavelet coefficients y, yielding the errors on the
+    // input, 'error', and the reconstructed input, 'input', if non-null.
+    void backwardInvertible1D_ (const Axis& axis, const double* delta, const double* y, double* input, double* error);
+
+    // Combine the accumulated correlations into the gradient of the low-pass
+    // filter coefficients.
+    void gradient_ (arma::Col<double>& gradient) const;
+
+    // Largest absolute difference between the probe input and its 1D forward-
+    // then-inverse transform along the given axis.
+    double reconstructionError_ (const Axis& axis);
+
+
+private:
+
+    /// Data member(s).
+    // Whether the plan is properly initialised.
+    bool m_valid = false;
+
+    // Whether the filter coefficients have been set.
+    bool m_hasFilter = false;
+
+    // The planned configuration.
+    unsigned m_nRows = 0;
+    unsigned m_nCols = 0;
+    unsigned m_filterLength = 0;
+    Mode m_mode = Mode::Train;
+    unsigned m_checkpointInterval = 1;
+
+    // Reconstruction error of the current filter, the tolerance, and whether
+    // the plan has fallen back to storing activations in 'Invertible' mode.
+    double m_drift = 0;
+    double m_tolerance = 1.0e-06;
+    bool m_fallback = false;
+
+    // The levels along each axis: rows are transformed using 'm_rowAxis' (of
+    // length nCols), columns using 'm_colAxis' (of length nRows).
+    Axis m_rowAxis;
+    Axis m_colAxis;
+
+    // The low- and high-pass operator filter coefficients.
+    std::vector<double> m_lowpass;
+    std::vector<double> m_highpass;
+
+    // Scratch memory. The stored low-pass activations for each row and column
+    // transform; the partially transformed matrix; a single row; and two
+    // ping-pong buffers for intermediate 1D results.
+    std::vector<double> m_rowActivations;
+    std::vector<double> m_colActivations;
+    std::vector<double> m_matrix;
+    std::vector<double> m_row;
+    std::vector<double> m_rowOut;
+    std::vector<double> m_buffer[2];
+
+    // The full activations of a single 1D transform, restored from the stored
+    // activations during the backward pass. Only used with checkpointing.
+    std::vector<double> m_restored;
+
+    // The reconstructed, partially transformed matrix, a single row of it, and
+    // two ping-pong buffers for the reconstructed 1D activations; and the probe
+    // input for measuring the reconstruction error. Only used in 'Invertible' 
+    // mode.
+    std::vector<double> m_partial;
+    std::vector<double> m_partialRow;
+    std::vector<double> m_reconstructed[2];
+    std::vector<double> m_probe;
+
+    // Whether a forward pass has been performed with the current filter
+    // coefficients, such that the activations are stored or can be
+    // reconstructed.
+    bool m_hasActivations = false;
+
+    // Accumulated correlations for the low- and high-pass gradients.
+    std::vector<double> m_corrLowpass;
+    std::vector<double> m_corrHighpass;
+
+};
+
+} // namespace
+
+#endif // WAVENET_TRANSFORMPLAN_H
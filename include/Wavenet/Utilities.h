@@ -12,7 +12,9 @@
 #include <cmath> /* log2, log10, sqrt */
 #include <algorithm> /* std::max */
 #include <cstdio> /* snprintf */
-#include <sys/stat.h> /* struct stat */
+#include <sys/stat.h> /* struct stat, mkdir */
+#include <cerrno> /* errno, EEXIST */
+#include <cstring> /* strerror */
 #include <cassert> /* assert */
 #include <memory> /* std::unique_ptr */
 #include <utility> /* std::move */
@@ -108,6 +110,21 @@ inline bool dirExists (const std::string& dir) {
     return exists;
 }
 
+/**
+ * Create directory, including any missing parent directories. Returns false if
+ * the directory could not be created, in which case 'errno' is set.
+ */
+inline bool makeDir (const std::string& dir) {
+    std::string path = dir;
+    while (path.size() > 1 && path.back() == '/') { path.pop_back(); }
+    if (path.empty() || dirExists(path)) { return true; }
+    const std::size_t pos = path.find_last_of("/");
+    if (pos != std::string::npos && pos > 0 && !makeDir(path.substr(0, pos))) {
+        return false;
+    }
+    return mkdir(path.c_str(), 0755) == 0 || (errno == EEXIST && dirExists(path));
+}
+
 
 /// String functions.
 /**
@@ -164,6 +181,21 @@ inline std::string formatNumber (const double&   f,
  */
 arma::Col<double> PointOnNSphere (const unsigned& N, const double& rho = 0.);
 
+/**
+ * Return the canonical representative of a set of filter coefficients, modulo
+ * the symmetries under which the corresponding wavelet bases are equivalent:
+ * sign flip and time reversal.
+ * Among the equivalent filters, the lexicographically largest is returned, 
+ * with entries differing by less than 'tolerance' taken as equal.
+ */
+arma::Col<double> CanonicalFilter (const arma::Col<double>& filter, const double& tolerance = 1e-06);
+
+/**
+ * Return the smallest distance between two sets of filter coefficients, modulo
+ * the same symmetries. Returns infinity for filters of different lengths.
+ */
+double FilterDistance (const arma::Col<double>& a, const arma::Col<double>& b);
+
 /**
  * Given a collection of 1D neural network activations, return the corresponding 
  * vector of wavelet coefficients.
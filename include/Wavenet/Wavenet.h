@@ -13,11 +13,12 @@
 #include <cstdio> /* snprintf */
 #include <vector> /* std::vector */
 #include <string> /* std::string */
-#include <cmath> /* log2, exp */
+#include <cmath> /* log2, exp, std::isfinite */
 #include <cassert> /* assert */
 #include <utility> /* std::move */
 #include <algorithm> /* std::max */
 #include <cstdlib> /* system */
+#include <functional> /* std::function */
 
 // Armadillo include(s).
 #include <armadillo>
@@ -25,10 +26,16 @@
 // Wavenet include(s).
 #include "Wavenet/Utilities.h"
 #include "Wavenet/Logger.h"
+#include "Wavenet/Profiler.h"
+#include "Wavenet/Metrics.h"
 #include "Wavenet/LowpassOperator.h"
 #include "Wavenet/HighpassOperator.h"
 #include "Wavenet/Snapshot.h"
 #include "Wavenet/CostFunctions.h"
+#include "Wavenet/Lattice.h"
+#include "Wavenet/TransformPlan.h"
+#include "Wavenet/Communicator.h"
+#include "Wavenet/GradientAccumulator.h"
 
 // Convenient typedef for the activations from the 1D forward transform.
 typedef arma::field< arma::Col<double> >              Activations1D_t;
@@ -93,6 +100,14 @@ public:
         m_alpha(other.m_alpha),
         m_inertia(other.m_inertia),
         m_inertiaTimeScale(other.m_inertiaTimeScale),
+        m_checkpointInterval(other.m_checkpointInterval),
+        m_invertible(other.m_invertible),
+        m_invertibleTolerance(other.m_invertibleTolerance),
+        m_jointSparsity(other.m_jointSparsity),
+        m_lattice(other.m_lattice),
+        m_projection(other.m_projection),
+        m_rollbackFactor(other.m_rollbackFactor),
+        m_maxRollbacks(other.m_maxRollbacks),
         m_filter(other.m_filter)
     {};
     
@@ -112,16 +127,55 @@ public:
     inline double inertiaTimeScale () const { return m_inertiaTimeScale; }
     
     // Returns the vector of filter coefficients.
-    inline arma::Col<double> filter () const { return m_filter; }
+    inline const arma::Col<double>& filter () const { return m_filter; }
     // Returns the vector momentum in filter coefficient space.
-    inline arma::Col<double> momentum () const { return m_momentum; }
+    inline const arma::Col<double>& momentum () const { return m_momentum; }
 
     // Returns the batch size.
     inline int batchSize () const { return m_batchSize; }
 
+    // Returns the statistics of the last batch used for an update: the number
+    // of examples (summed over all ranks, in distributed training), the mean 
+    // gradient, and the sample variance of the gradient of a single example. 
+    // The variance vanishes for batches with fewer than two examples.
+    inline unsigned                 batchCount    () const { return m_batchCount; }
+    inline const arma::Col<double>& batchGradient () const { return m_batchGradient; }
+    inline const arma::Col<double>& batchVariance () const { return m_batchVariance; }
+
+    // Returns the checkpoint interval used for training.
+    inline unsigned checkpointInterval () const { return m_checkpointInterval; }
+
+    // Returns whether activations are reconstructed from the wavelet 
+    // coefficients during training, and the orthonormality tolerance.
+    inline bool   invertible          () const { return m_invertible; }
+    inline double invertibleTolerance () const { return m_invertibleTolerance; }
+
+    // Returns whether the sparsity of multi-channel examples is computed 
+    // jointly for all channels, rather than for each channel separately.
+    inline bool jointSparsity () const { return m_jointSparsity; }
+
+    // Returns whether the filter coefficients are optimised through the 
+    // orthonormal lattice parameterisation.
+    inline bool lattice () const { return m_lattice; }
+    // Returns the free lattice angles of the current filter coefficients, if 
+    // using the lattice parameterisation.
+    inline const arma::Col<double>& angles () const { return m_angles; }
+
+    // Returns whether the filter coefficients are projected onto the set of 
+    // valid wavelets after each update.
+    inline bool projection () const { return m_projection; }
+
+    // Returns the factor by which the learning rate is reduced when a diverging
+    // update is rolled back, and the maximal number of consecutive roll-backs.
+    inline double   rollbackFactor () const { return m_rollbackFactor; }
+    inline unsigned maxRollbacks   () const { return m_maxRollbacks; }
+
     // Returns whether the wavenet is configured to learn wavelet functions. 
     inline bool wavelet () const { return m_wavelet; }
 
+    // Returns the communicator used for distributed training, if any.
+    inline Communicator* communicator () const { return m_communicator; }
+
     // Returns the filter log. Returns a _reference_ to the filter log and 
     // doesn't have a const qualifier, such that the log can be modified 
     // externally.
@@ -141,6 +195,10 @@ public:
     // Returns the last (non-zero) entry in the cost log.
     double lastCost () const;
 
+    // Returns the throughput and memory metrics. Returns a _reference_, such 
+    // that the metrics can be reset and updated externally, e.g. by the Coach.
+    inline Metrics& metrics () const { return m_metrics; }
+
     
 /// Set method(s).
     // Set the regularisation constant (lambda).
@@ -168,14 +226,22 @@ public:
         return true;
     }
 
-    // Set the vector of filter coefficients.
+    // Set the vector of filter coefficients. The rvalue overload moves the
+    // input into the wavenet, such that it is only copied once, into the 
+    // filter log.
     bool setFilter (const arma::Col<double>& filter);
+    bool setFilter (arma::Col<double>&& filter);
     // Set the vector momentum in filter coefficient space.
     inline bool setMomentum (const arma::Col<double>& momentum) {
         assert(momentum.size() == m_filter.size());
         m_momentum = momentum;
         return true;
     }
+    inline bool setMomentum (arma::Col<double>&& momentum) {
+        assert(momentum.size() == m_filter.size());
+        m_momentum = std::move(momentum);
+        return true;
+    }
 
     // Set the batch size.
     inline bool setBatchSize (const unsigned& batchSize) {
@@ -183,11 +249,78 @@ public:
         return true;
     }
 
+    // Set the checkpoint interval used for training, trading memory for 
+    // recomputation in the backward pass (@see TransformPlan). 1 (default) 
+    // stores all activations; 0 stores only the input.
+    inline bool setCheckpointInterval (const unsigned& checkpointInterval) {
+        m_checkpointInterval = checkpointInterval;
+        return true;
+    }
+
+    // Specify whether the activations should be reconstructed from the wavelet
+    // coefficients during training, rather than stored, whenever the error of
+    // the reconstruction is no larger than the tolerance (@see TransformPlan).
+    inline bool setInvertible (const bool& invertible, const double& tolerance = 1.0e-06) {
+        assert(tolerance >= 0);
+        m_invertible = invertible;
+        m_invertibleTolerance = tolerance;
+        return true;
+    }
+
+    // Specify whether the sparsity of multi-channel examples should be 
+    // computed jointly for the wavelet coefficients of all channels, rather 
+    // than summed over the channels (default).
+    inline bool setJointSparsity (const bool& jointSparsity) {
+        m_jointSparsity = jointSparsity;
+        return true;
+    }
+
+    // Specify whether the filter coefficients should be optimised through the
+    // orthonormal lattice parameterisation (@see Lattice.h), in which case 
+    // only valid wavelets are considered, and the regularisation term is not
+    // used. The filter coefficients are projected onto the lattice at the next
+    // call to 'train'.
+    inline bool setLattice (const bool& lattice) {
+        m_lattice = lattice;
+        m_angles.reset();
+        m_onLattice = false;
+        return true;
+    }
+
+    // Specify whether the filter coefficients should be projected onto the set
+    // of valid wavelets after each update (@see ProjectFilter), in which case 
+    // the regularisation term is not used. The filter coefficients are also
+    // projected at the next call to 'train'.
+    inline bool setProjection (const bool& projection) {
+        m_projection = projection;
+        m_projected  = false;
+        return true;
+    }
+
+    // Specify how diverging updates are handled: the wavenet is rolled back to
+    // the state before the last update, and the learning rate (alpha) is 
+    // multiplied by 'factor'. Training fails after 'maxRollbacks' consecutive
+    // roll-backs.
+    inline bool setRollback (const double& factor, const unsigned& maxRollbacks = 10) {
+        assert(factor > 0 && factor < 1);
+        m_rollbackFactor = factor;
+        m_maxRollbacks   = maxRollbacks;
+        return true;
+    }
+
     // Specify whether the wavenet should learn wavelet functions
     inline bool doWavelet (const bool& wavelet) {
         m_wavelet = wavelet;
         return true;
     }
+
+    // Set the communicator used for distributed training, in which case the 
+    // batch gradients are averaged over all ranks before each update. The 
+    // wavenet doesn't own the communicator.
+    inline bool setCommunicator (Communicator* communicator) {
+        m_communicator = communicator;
+        return true;
+    }
     
 
 /// Print method(s).
@@ -234,20 +367,86 @@ public:
      * resulting wavelet coefficients, (3) computes the regularisation error 
      * gradient on the current member filter coeffients, (4) back-propagates the 
      * combined (sparsity and regularisation) gradient through the wavenet and 
-     * accumulates the error gradient associated with each filter coefficient 
-     * using weight matrices, and finally (5) appends the combined vector 
-     * gradient in filter coefficient space to the batch queue. If the batch 
-     * queue has reached the target size (which may be 1, with default setting, 
+     * accumulates the error gradient associated with each filter coefficient, 
+     * and finally (5) appends the combined vector 
+     * gradient in filter coefficient space to the batch accumulator. If the 
+     * batch has reached the target size (which may be 1, with default setting, 
      * in which case batch gradient descent is not used), the method will also 
-     * trigger an update of the wavenet object by flushing the batch queue.
+     * trigger an update of the wavenet object by flushing the batch. If the 
+     * update diverges, the wavenet is rolled back, and training continues 
+     * with a reduced learning rate (@see rollback_).
+     *
+     * The forward and backward passes are executed using a TransformPlan for 
+     * the shape of the input, which is equivalent to (but faster than) 
+     * forward_(...) and backpropagate_(...) using the cached matrix operators.
      * 
-     * @see forward_(...)
-     * @see backpropagate_(...)
-     * @see flushBatchQueue_()
+     * @see TransformPlan
+     * @see flushBatch_()
      * 
      * @param X Input data example, on which to train the wavenet object.
      */
-    bool train (arma::Mat<double> X);  
+    bool train (const arma::Mat<double>& X);
+
+    /**
+     * @brief Train wavenet instance on a multi-channel example.
+     *
+     * Each slice of the cube is a channel, e.g. one of several co-registered
+     * images, all of which are transformed using the same filter coefficients
+     * and the same transform plan. The sparsity term is either the sum of the
+     * sparsity terms of the wavelet coefficients of each channel, or, with
+     * joint sparsity, the sparsity term of the wavelet coefficients of all
+     * channels combined. The sparsity gradients of all channels are summed
+     * along with a single regularisation gradient, and appended to the batch 
+     * queue as one entry, such that each multi-channel example counts as a 
+     * single example. For a single channel, this is equivalent to 
+     * train(const arma::Mat<double>&).
+     *
+     * With joint sparsity, the sparsity gradient of each channel depends on the
+     * wavelet coefficients of all channels, such that the channels are forward
+     * transformed again for the backward pass, unless the activations are
+     * reconstructed from the wavelet coefficients (@see setInvertible).
+     *
+     * @param X Input data example, with one slice per channel.
+     */
+    bool train (const arma::Cube<double>& X);
+
+    /**
+     * @brief Train wavenet instance asynchronously, using several threads 
+     *        (Hogwild).
+     *
+     * Each of 'numThreads' worker threads repeatedly pulls an example using
+     * 'next', and computes the combined gradient of the example, using its own 
+     * TransformPlan, with respect to a snapshot of the filter coefficients 
+     * taken at the start of each of its batches. Once a worker has accumulated 
+     * a batch, it applies the batch-averaged gradient to the filter 
+     * coefficients and momentum shared by all workers, one coefficient at a 
+     * time, using atomic compare-and-swap operations. Workers thus don't wait
+     * for each other to compute gradients, at the cost of computing gradients
+     * with respect to filter coefficients which may since have been updated
+     * by other workers (staleness), and of updates to different coefficients
+     * being interleaved.
+     *
+     * After each update, the worker appends to the cost log and filter log
+     * under a lock, which is only held for the duration of the append, i.e.
+     * once per batch. With only a few filter coefficients, the contention is
+     * negligible, and the throughput scales with the number of threads.
+     * Incomplete batches remaining when the examples run out are used for a 
+     * final update by each worker. If a batch gradient, or the updated filter
+     * coefficients, aren't finite, or if an example throws, the shared state
+     * is rolled back as in synchronous training (@see rollback_). Once all 
+     * workers are done, the shared filter coefficients and momentum are 
+     * copied back into the wavenet.
+     *
+     * The lattice parameterisation and projection, which update all filter 
+     * coefficients jointly, are not supported.
+     *
+     * @param next Function filling its argument with the next example, and 
+     *             returning false if there are no more examples. Must be safe
+     *             to call from several threads at once.
+     * @param numThreads The number of worker threads.
+     * @return Whether the training completed successfully.
+     */
+    bool trainAsync (const std::function<bool(arma::Mat<double>&)>& next, const unsigned& numThreads);
 
     /**
      * @brief Clear all non-essential data from wavenet object.
@@ -324,6 +523,110 @@ public:
                                               const unsigned& Ndiv);
     
 
+/// Second-order method(s).
+    /**
+     * @brief Compute the gradient of the cost with respect to the filter 
+     *        coefficients, averaged over a set of examples.
+     *
+     * The gradient is that used in training, i.e. the back-propagated 
+     * gradient of the sparsity term plus lambda times the regularisation 
+     * gradient (@see RegTermDeriv). The cost is that of the objective of which 
+     * this is the gradient, i.e. the average sparsity term plus twice lambda 
+     * times the regularisation term (@see RegTerm). 
+     *
+     * The second-order methods use a separate transform plan, and don't 
+     * modify the state of the training. They don't support the lattice 
+     * parameterisation, or projection.
+     *
+     * @param examples The set of examples.
+     * @param gradient Output vector gradient in filter coefficient space.
+     * @param cost Output combined cost.
+     * @return Whether the gradient was computed successfully.
+     */
+    bool gradient (const std::vector< arma::Mat<double> >& examples, arma::Col<double>& gradient, double& cost);
+
+    /**
+     * @brief Compute the product of the Hessian of the cost, averaged over a 
+     *        set of examples, with a vector in filter coefficient space.
+     *
+     * The Hessian of the regularisation term is computed exactly (@see 
+     * RegTermHessian). The contribution from the sparsity term is computed as
+     * the directional derivative of the exact, back-propagated sparsity 
+     * gradient along the vector, using central differences,
+     *   H v \approx (g(a + \epsilon v) - g(a - \epsilon v)) / (2 \epsilon)
+     * with a step \epsilon relative to the scale of the filter coefficients, 
+     * balancing truncation and rounding errors. Since the Gini coefficient is
+     * only piecewise smooth in the wavelet coefficients (changing form 
+     * whenever the ordering or signs of these change), this is the curvature
+     * averaged over a small neighbourhood of the filter coefficients. Near
+     * such kinks, i.e. if the ordering or sign of some wavelet coefficients 
+     * changes within \epsilon, the finite difference picks up the jump in the
+     * gradient, and the product is noisy, and may be dominated by it.
+     *
+     * @param examples The set of examples.
+     * @param v Vector in filter coefficient space.
+     * @param Hv Output Hessian-vector product.
+     * @return Whether the product was computed successfully.
+     */
+    bool hessianVectorProduct (const std::vector< arma::Mat<double> >& examples, const arma::Col<double>& v, arma::Col<double>& Hv);
+
+    /**
+     * @brief Compute the full Hessian of the cost, averaged over a set of 
+     *        examples.
+     *
+     * Computed column by column, from the Hessian-vector products with each 
+     * unit vector, and symmetrised. Requires 2N evaluations of the sparsity
+     * gradient for N filter coefficients. The sparsity part is therefore a
+     * finite-difference estimate, which is noisy near kinks of the sparsity 
+     * term.
+     *
+     * @see hessianVectorProduct
+     *
+     * @param examples The set of examples.
+     * @param H Output (N x N) Hessian matrix.
+     * @return Whether the Hessian was computed successfully.
+     */
+    bool hessian (const std::vector< arma::Mat<double> >& examples, arma::Mat<double>& H);
+
+    /**
+     * @brief Compute the curvature of the cost along a direction in filter 
+     *        coefficient space.
+     *
+     * The curvature is given by the Rayleigh quotient v^T H v / v^T v, using a
+     * single Hessian-vector product. E.g. along the gradient, the inverse 
+     * curvature is the step size which minimises the local quadratic model of
+     * the cost. Since the product uses finite differences for the sparsity 
+     * term, the curvature is noisy near kinks of the sparsity term (@see 
+     * hessianVectorProduct).
+     *
+     * @param examples The set of examples.
+     * @param v Direction in filter coefficient space.
+     * @param curvature Output curvature.
+     * @return Whether the curvature was computed successfully.
+     */
+    bool curvature (const std::vector< arma::Mat<double> >& examples, const arma::Col<double>& v, double& curvature);
+
+    /**
+     * @brief Perform a single, damped Newton step on the filter coefficients.
+     *
+     * Solves (H + \mu I) \Delta a = - g, using the eigen-decomposition of the
+     * Hessian H, where the damping \mu is at least 'damping', and large enough
+     * for the shifted Hessian to be positive definite, such that the step is a
+     * descent direction. If the step doesn't decrease the cost on the 
+     * examples, the damping is increased ten-fold, up to ten times. If the 
+     * step is accepted, the filter coefficients are updated and added to the
+     * filter log, the cost before the step is added to the cost log, as for 
+     * an update in training, and the momentum is reset. The Hessian is the finite-difference estimate of 'hessian', 
+     * such that near kinks of the sparsity term the step may be poor, in 
+     * which case it is rejected by the check on the cost.
+     *
+     * @param examples The set of examples.
+     * @param damping Minimal damping.
+     * @return Whether a step decreasing the cost was taken.
+     */
+    bool newtonStep (const std::vector< arma::Mat<double> >& examples, const double& damping = 1.0e-06);
+
+
 /// Basis function method(s).
     /**
      * @brief Generate 1D basis funtion.
@@ -434,7 +737,7 @@ protected:
      *         the error gradients for the filter coefficents.
      */
     std::vector< arma::Col<double> > backpropagate_ (const arma::Col<double>& delta,
-                                                     Activations1D_t activations);
+                                                     const Activations1D_t& activations);
 
 
 /// 2D wavenet transform method(s).
@@ -496,20 +799,81 @@ protected:
      * @return A vector of the error gradients for the filter coefficents.
      */
     arma::Col<double> backpropagate_ (const arma::Mat<double>& Delta,
-                                      Activations2D_t Activations);
+                                      const Activations2D_t& Activations);
 
 
 /// Low-level learning method(s).
     /**
-     * @brief Flush the batch queue.
+     * @brief Prepare the transform plan for training on input of given shape.
+     *
+     * Re-uses the current transform plan if it matches the shape and the 
+     * training configuration, and (re-)initialises it otherwise. With the 
+     * lattice parameterisation, or with projection, the filter coefficients 
+     * are first projected onto the lattice, or the set of valid wavelets, 
+     * resp., if they have been set since the last update.
+     */
+    bool preparePlan_ (const unsigned& nRows, const unsigned& nCols);
+
+    /**
+     * @brief Compute the back-propagated sparsity gradient, and the sparsity
+     *        term, averaged over a set of examples, for the given filter 
+     *        coefficients.
+     *
+     * Uses the transform plan for second-order methods, such that the 
+     * training plan isn't modified.
+     */
+    bool sparsityGradient_ (const std::vector< arma::Mat<double> >& examples, const arma::Col<double>& filter,
+                            arma::Col<double>& gradient, double& sparsity);
+
+    /**
+     * @brief Add the gradient from a single training example to the batch 
+     *        accumulator.
+     *
+     * Adds the regularisation gradient (unless using the lattice 
+     * parameterisation or projection) to the backpropagated sparsity gradient,
+     * adds the combined gradient to the batch accumulator, adds the combined 
+     * cost to the latest entry in the cost log, and flushes the batch if it 
+     * has reached the batch size.
+     *
+     * Returns false if the batch couldn't be used for an update, and the 
+     * maximal number of consecutive roll-backs has been reached, or if it 
+     * couldn't be combined across ranks.
+     */
+    bool accumulateGradient_ (const arma::Col<double>& gradientSparsity, const double& sparsity);
+
+    /**
+     * @brief Flush the batch.
      * 
-     * Averages the filter coefficient gradients in the batch queue, calls the 
-     * update method with the average gradient, clears the batch queue, and 
-     * appends the average cost of the examples in the batch to the cost log.
+     * Averages the filter coefficient gradients in the batch accumulator, 
+     * calls the update method with the average gradient, stores the statistics
+     * of the batch, clears the accumulator, and appends the average cost of 
+     * the examples in the batch to the cost log.
+     *
+     * If the averaged gradient, or the updated filter coefficients, aren't 
+     * finite, the wavenet is rolled back instead. In distributed training, 
+     * returns false, discarding the batch, if the gradients couldn't be 
+     * combined across ranks.
      * 
      * @see update_(arma::Col<double>)
+     * @see rollback_(std::string, unsigned)
+     */
+    bool flushBatch_ ();
+
+    /**
+     * @brief Roll back a diverging update.
+     *
+     * Discards the current batch, restores the filter coefficients (and lattice
+     * angles) from before the last update, resets the momentum, and reduces 
+     * the learning rate (alpha) by the roll-back factor, such that training 
+     * can continue. The restored filter coefficients aren't added to the 
+     * filter log, which thus stays aligned with the cost log. Returns false 
+     * if the maximal number of consecutive roll-backs has been reached, in 
+     * which case training should stop.
+     *
+     * @param reason Description of the non-finite quantity, for printing.
+     * @param discarded Number of examples in the discarded batch.
      */
-    void flushBatchQueue_ ();
+    bool rollback_ (const std::string& reason, const unsigned& discarded);
 
 
     /**
@@ -527,6 +891,39 @@ protected:
      */
     void scaleMomentum_ (const double& factor);
 
+    /**
+     * @brief Set the filter coefficients from lattice angles.
+     *
+     * @see LatticeFilter(arma::Col<double>)
+     */
+    void setAngles_ (arma::Col<double>&& angles);
+
+    /**
+     * @brief Reset the state derived from the filter coefficients.
+     *
+     * Called whenever the filter coefficients are replaced: resets the lattice
+     * angles, the lattice and projection flags, and the cached matrix 
+     * operators.
+     */
+    void resetFilterState_ ();
+
+    /**
+     * @brief Reset the state to roll back to.
+     *
+     * Clears the filter coefficients (and lattice angles) kept from before the
+     * latest update, and the number of consecutive roll-backs, such that no 
+     * roll-back restores a state from before the filter coefficients were 
+     * replaced outside of training.
+     */
+    void resetRollbackState_ ();
+
+    /**
+     * @brief Project filter coefficients onto the set of valid wavelets.
+     *
+     * @see ProjectFilter(arma::Col<double>, bool, double, unsigned)
+     */
+    void projectFilter_ (arma::Col<double>& filter) const;
+
 
     /**
      * @brief Update the filter coefficients with gradient.
@@ -540,6 +937,12 @@ protected:
      * are specified, an effictive inertia is computed before performing the 
      * momentum update.
      *
+     * With the lattice parameterisation, the gradient is mapped onto the 
+     * lattice angles, which are updated instead, using a separate momentum.
+     * With projection, the updated filter coefficients are projected onto the 
+     * set of valid wavelets, warm-started from the updated filter, and the 
+     * momentum is set to the projected step.
+     *
      * @see scaleMomentum_(double)
      * @see addMomentum_(arma::Col<double>) 
      * @see setFilter(arma::Col<double>) 
@@ -760,6 +1163,67 @@ private:
      * used.
      */
     double m_inertiaTimeScale = 0.;
+
+    /**
+     * @brief Checkpoint interval used for training.
+     *
+     * Controls which activations are stored by the transform plan during the
+     * forward pass, and which are recomputed during the backward pass. Larger
+     * intervals (and 0, storing only the input) use less memory, at the cost
+     * of additional computation, which allows training on large inputs.
+     *
+     * @see TransformPlan
+     */
+    unsigned m_checkpointInterval = 1;
+
+    /**
+     * @brief Whether to reconstruct activations during training.
+     *
+     * If true, the activations are reconstructed from the wavelet coefficients
+     * in the backward pass, instead of being stored in the forward pass, as 
+     * long as the measured reconstruction error is no larger than the 
+     * tolerance. Otherwise, activations are stored according to the 
+     * checkpoint interval.
+     *
+     * @see TransformPlan
+     */
+    bool   m_invertible = false;
+    double m_invertibleTolerance = 1.0e-06;
+
+    /**
+     * @brief Whether to compute the sparsity of multi-channel examples jointly.
+     *
+     * If true, the sparsity term of a multi-channel example is the Gini 
+     * coefficient of the wavelet coefficients of all channels combined. 
+     * Otherwise, it is the sum of the Gini coefficients of each channel.
+     */
+    bool m_jointSparsity = false;
+
+    /**
+     * @brief Whether to use the orthonormal lattice parameterisation.
+     *
+     * If true, the filter coefficients are given by N/2 - 1 free lattice 
+     * angles, which are updated in place of the filter coefficients, such that
+     * the filter always satisfies the wavelet conditions, and the 
+     * regularisation term is not needed.
+     *
+     * @see Lattice.h
+     */
+    bool m_lattice = false;
+
+    /**
+     * @brief Whether to project the filter coefficients after each update.
+     *
+     * If true, the filter coefficients are projected onto the set of filters
+     * satisfying the wavelet conditions after each update, such that the 
+     * regularisation term is not needed, and larger learning rates can be 
+     * used. 'm_projected' tracks whether the current filter coefficients have
+     * been projected, and is reset whenever they are set externally.
+     *
+     * @see ProjectFilter
+     */
+    bool m_projection = false;
+    bool m_projected  = false;
     
 
     // Filter coefficient space member(s).
@@ -773,6 +1237,49 @@ private:
      */
     arma::Col<double> m_momentum;
 
+    /**
+     * @brief The free lattice angles of the filter coefficients, and the 
+     *        momentum in lattice angle space.
+     *
+     * Only used with the lattice parameterisation. The angles are reset 
+     * whenever the filter coefficients are set externally.
+     */
+    arma::Col<double> m_angles;
+    arma::Col<double> m_angleMomentum;
+
+    /**
+     * @brief Whether the filter coefficients are given by the lattice angles.
+     *
+     * Tracked explicitly, since the number of angles doesn't tell: for N = 2
+     * (Haar), there are no free angles to begin with.
+     */
+    bool m_onLattice = false;
+
+
+    // Divergence handling member(s).
+    /**
+     * @brief Factor by which the learning rate is reduced at each roll-back, 
+     *        and the maximal number of consecutive roll-backs.
+     */
+    double   m_rollbackFactor = 0.5;
+    unsigned m_maxRollbacks   = 10;
+
+    /**
+     * @brief Number of consecutive roll-backs, i.e. since the last successful
+     *        update.
+     */
+    unsigned m_numRollbacks = 0;
+
+    /**
+     * @brief The state before the last successful update.
+     *
+     * The filter coefficients and lattice angles to which the wavenet is 
+     * rolled back if an update diverges. Kept in memory only.
+     */
+    arma::Col<double> m_goodFilter;
+    arma::Col<double> m_goodAngles;
+    bool m_goodOnLattice = false;
+
 
     // Cached matrix operator member(s).
     /**
@@ -815,20 +1322,31 @@ private:
      * If the batch size is kept at 1, no batch gradient descent is performed 
      * and each training example will trigger an update of the filter 
      * coefficients. If the batch size is larger than one, the filter 
-     * coefficient gradient arising from each training example will be stored in 
-     * a batch queue, until the batch queue reaches the specified size, and the 
+     * coefficient gradient arising from each training example will be added to 
+     * a batch accumulator, until the batch reaches the specified size, and the 
      * Wavenet object is updated by the batch-averaged gradient. This vill lead
      * to a more stable, but slower, learning proces.
      */
     unsigned m_batchSize = 1;
     
     /**
-     * @brief The batch queue.
+     * @brief The batch accumulator.
      * 
-     * Contains one filter coefficient space gradient for each example in the 
-     * current batch, to be added and scaled when doing a batch update.
+     * Accumulates the filter coefficient space gradients of the examples in 
+     * the current batch, to be averaged when doing a batch update, using 
+     * memory independent of the batch size.
+     */
+    GradientAccumulator m_batchAccumulator;
+
+    /**
+     * @brief Statistics of the last batch used for an update.
+     *
+     * The number of examples, the mean gradient, and the per-example variance
+     * of the gradient, e.g. for choosing the batch size adaptively.
      */
-    std::vector< arma::Col<double> > m_batchQueue;
+    unsigned          m_batchCount = 0;
+    arma::Col<double> m_batchGradient;
+    arma::Col<double> m_batchVariance;
     
     /**
      * @brief The filter log.
@@ -856,6 +1374,46 @@ private:
      * pass type filters.)
      */
     bool m_wavelet = true;
+
+
+    // Distributed training member(s).
+    /**
+     * @brief The communicator used for distributed training, if any.
+     *
+     * If set, the summed gradients, costs, and numbers of examples of each 
+     * batch are all-reduced across the ranks of the communicator before each
+     * update, such that wavenets with identical filter coefficients on all 
+     * ranks stay identical. Not copied with the wavenet, since each collective
+     * call must be matched by one on every rank.
+     */
+    Communicator* m_communicator = nullptr;
+
+
+    // Monitoring member(s).
+    /**
+     * @brief Throughput and memory metrics.
+     *
+     * Mutable, since the metrics are also updated by const methods, e.g. when 
+     * saving snapshots.
+     */
+    mutable Metrics m_metrics;
+
+
+    // Planning member(s).
+    /**
+     * @brief Transform plan used for training.
+     *
+     * Created on the first call to 'train' for a given input shape and number
+     * of filter coefficients, and reused for all subsequent training examples
+     * of that shape, to avoid per-example setup and allocation of activations.
+     */
+    TransformPlan m_plan;
+
+    /**
+     * @brief Transform plan used for second-order methods, such that these 
+     *        don't modify the plan used for training.
+     */
+    TransformPlan m_curvaturePlan;
     
 };
 
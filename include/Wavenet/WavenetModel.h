@@ -0,0 +1,138 @@
+#ifndef WAVENET_WAVENETMODEL_H
+#define WAVENET_WAVENETMODEL_H
+
+/**
+ * @file   WavenetModel.h
+ * @brief  Immutable, thread-safe wavenet model for inference.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h"
+#include "Wavenet/Logger.h"
+#include "Wavenet/Wavenet.h"
+#include "Wavenet/TransformPlan.h"
+
+
+namespace wavenet {
+
+/**
+ * Immutable, thread-safe wavenet model for inference.
+ *
+ * The transform methods of the Wavenet class lazily (re-)build the cached
+ * matrix operators, and are therefore not const, such that a single Wavenet
+ * object cannot safely be shared between threads. A WavenetModel is produced
+ * from a (trained) Wavenet object, or a set of filter coefficients, and
+ * freezes the filter coefficients for input up to a given shape.
+ *
+ * Each transform is executed using the banded filter kernels of a 
+ * TransformPlan, in O(N) operations and memory per input entry, where N is the
+ * number of filter coefficients. Since plans own their scratch memory, each
+ * call creates its own plan. The model is never modified after construction,
+ * and all transform methods are const and use only local memory, such that a 
+ * single model can be used concurrently from any number of threads without
+ * synchronisation.
+ */
+class WavenetModel : public Logger {
+
+public:
+
+    /// Constructor(s).
+    WavenetModel () {};
+
+    WavenetModel (const Wavenet& wavenet, const std::vector<unsigned>& shape)
+    { init_(wavenet.filter(), shape); };
+
+    WavenetModel (const arma::Col<double>& filter, const std::vector<unsigned>& shape)
+    { init_(filter, shape); };
+
+
+    /// Destructor.
+    ~WavenetModel () {};
+
+
+    /// Get method(s).
+    // Whether the model is properly initialised.
+    inline bool valid () const { return m_valid; }
+    // Returns the frozen vector of filter coefficients.
+    inline const arma::Col<double>& filter () const { return m_filter; }
+    // Returns the largest length along any axis supported by the model.
+    inline unsigned maxSize () const { return 1u << m_maxLevel; }
+
+    // Whether input of the given shape can be transformed using the model.
+    bool supports (const unsigned& nRows, const unsigned& nCols = 1) const;
+
+
+    /// Transform method(s).
+    /**
+     * @brief Forward transform of matrix.
+     *
+     * Equivalent to the 2D forward transform of Wavenet, performed in a
+     * row-major fashion. For column vector input, the 1D transform is
+     * performed.
+     *
+     * @param X The input, position space matrix.
+     * @return The matrix of wavelet coefficients, or an empty matrix if the
+     *         shape of X is not supported by the model.
+     */
+    arma::Mat<double> transform (const arma::Mat<double>& X) const;
+
+    /**
+     * @brief Inverse transform of matrix of wavelet coefficients.
+     *
+     * @param Y The matrix of wavelet coefficients.
+     * @return The position space matrix, or an empty matrix if the shape of Y
+     *         is not supported by the model.
+     */
+    arma::Mat<double> inverse (const arma::Mat<double>& Y) const;
+
+    /**
+     * @brief Compress matrix using the wavelet basis of the model.
+     *
+     * Forward transforms the input, keeps the 'nCoeffs' wavelet coefficients
+     * with the largest magnitude, sets all other coefficients to zero, and
+     * inverse transforms back to position space.
+     *
+     * @param X The input, position space matrix.
+     * @param nCoeffs The number of wavelet coefficients to keep.
+     * @return The compressed, position space matrix, or an empty matrix if the
+     *         shape of X is not supported by the model.
+     */
+    arma::Mat<double> compress (const arma::Mat<double>& X, const unsigned& nCoeffs) const;
+
+
+protected:
+
+    /// Internal initialisation method(s).
+    // Freeze the filter coefficients for input up to the given shape.
+    bool init_ (const arma::Col<double>& filter, const std::vector<unsigned>& shape);
+
+
+    /// Internal transform method(s).
+    // Initialise a plan for transforming input of the given shape with the 
+    // frozen filter coefficients. Returns false if the shape is not supported.
+    bool plan_ (const unsigned& nRows, const unsigned& nCols, TransformPlan& plan) const;
+
+
+private:
+
+    /// Data member(s).
+    // Whether the model is properly initialised.
+    bool m_valid = false;
+
+    // The frozen filter coefficients.
+    arma::Col<double> m_filter;
+
+    // Number of levels of the largest supported transform.
+    unsigned m_maxLevel = 0;
+
+};
+
+} // namespace
+
+#endif // WAVENET_WAVENETMODEL_H
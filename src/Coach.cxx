@@ -41,37 +41,145 @@ void Coach::setTargetPrecision (const double& targetPrecision) {
     return;
 }
 
-void Coach::checkMakeOutdir (const std::string& subdir) const {
+void Coach::setBatchSizeTheta (const double& batchSizeTheta) {
+    if (batchSizeTheta <= 0) {
+        WARNING("Requested norm test tolerance (%f) is no good. Exiting.", batchSizeTheta);
+        return;
+    }
+    m_batchSizeTheta = batchSizeTheta;
+    return;
+}
 
-    // Perform checks.
-    if (m_basedir == "" || outdir() == "") {
-        WARNING("Directory not set.");
+void Coach::setCurriculum (const std::vector<unsigned>& factors, const int& numEventsPerStage, const double& precision) {
+    for (unsigned i = 0; i < factors.size(); i++) {
+        if (!isRadix2(factors[i])) {
+            WARNING("Curriculum pooling factor (%d) is not radix 2.", factors[i]);
+            return;
+        }
+        if (i > 0 && factors[i] > factors[i - 1]) {
+            WARNING("Curriculum pooling factors must be decreasing, i.e. from coarse to fine.");
+            return;
+        }
+    }
+    m_curriculum = factors;
+    if (!m_curriculum.empty() && m_curriculum.back() != 1) { m_curriculum.push_back(1); }
+    if (m_curriculum.size() > 1 && numEventsPerStage <= 0 && precision <= 0) {
+        WARNING("Neither number of events per stage nor precision set. The training will remain at the first stage.");
+    }
+    m_curriculumEvents    = numEventsPerStage;
+    m_curriculumPrecision = precision;
+    return;
+}
+
+void Coach::setDeduplication (const double& radius) {
+    if (radius == 0) {
+        WARNING("Requested deduplication radius (%f) is no good.", radius);
+        return;
+    }
+    m_dedupRadius = radius;
+    return;
+}
+
+void Coach::setPruning (const int& checkpointEvents, const unsigned& factor) {
+    if (checkpointEvents == 0 || factor < 2) {
+        WARNING("Requested pruning checkpoint (%d) or factor (%d) is no good.", checkpointEvents, factor);
         return;
     }
+    m_pruneEvents = checkpointEvents;
+    m_pruneFactor = factor;
+    return;
+}
 
-    if (strcmp(outdir().substr(0,1).c_str(), "/") == 0) {
-        WARNING("Directory '%s' not accepted. Only accepting realtive paths.", outdir().c_str());
+void Coach::setNumWorkers (const unsigned& numWorkers) {
+    if (numWorkers == 0) {
+        WARNING("Number of workers must be positive.");
         return;
     }
+    m_numWorkers = numWorkers;
+    return;
+}
 
-    const std::string dir = outdir() + subdir;
+void Coach::setNewtonSteps (const unsigned& numSteps, const unsigned& numExamples) {
+    if (numSteps > 0 && numExamples == 0) {
+        WARNING("Number of examples for Newton steps must be positive.");
+        return;
+    }
+    m_newtonSteps    = numSteps;
+    m_newtonExamples = numExamples;
+    return;
+}
+
+void Coach::addWavenet (Wavenet* wavenet, const std::string& name, const unsigned& numCoeffs) {
+    if (!wavenet || !name.size()) {
+        WARNING("Cannot add wavenet without an instance and a name.");
+        return;
+    }
+    if (numCoeffs > 0 && !isRadix2(numCoeffs)) {
+        WARNING("Input number of coefficients (%d) is not radix 2.", numCoeffs);
+        return;
+    }
+    m_fanout.push_back(Trainee(wavenet, name, numCoeffs));
+    return;
+}
+
+Metrics Coach::metrics () const {
+
+    // Collect the wavenet instances being trained.
+    std::vector<const Wavenet*> wavenets;
+    if (m_wavenet) { wavenets.push_back(m_wavenet); }
+    for (const Trainee& trainee : m_fanout) {
+        if (trainee.wavenet != m_wavenet) { wavenets.push_back(trainee.wavenet); }
+    }
+
+    if (wavenets.empty()) {
+        WARNING("No wavenet instances were set.");
+        return Metrics();
+    }
+
+    // Combine their metrics.
+    Metrics metrics = wavenets.front()->metrics();
+    for (unsigned i = 1; i < wavenets.size(); i++) {
+        metrics.merge(wavenets[i]->metrics());
+    }
+    return metrics;
+}
+
+bool Coach::checkMakeOutdir (const std::string& subdir) const {
+    return checkMakeDir_(outdir() + subdir);
+}   
+
+bool Coach::checkMakeDir_ (const std::string& dir) const {
+
+    // Perform checks.
+    if (m_basedir == "" || dir == "") {
+        WARNING("Directory not set.");
+        return false;
+    }
+
+    if (strcmp(dir.substr(0,1).c_str(), "/") == 0) {
+        WARNING("Directory '%s' not accepted. Only accepting realtive paths.", dir.c_str());
+        return false;
+    }
 
     if (dirExists(dir)) {
         DEBUG("Directory '%s' already exists. Exiting.", dir.c_str()); 
-        return;
+        return true;
     }
     
     // Create the directory.
     INFO("Creating directory '%s'.", dir.c_str());
-    system(("mkdir -p " + dir).c_str());
+    if (!makeDir(dir)) {
+        ERROR("Failed to create directory '%s': %s.", dir.c_str(), strerror(errno));
+        return false;
+    }
     
-    return;
+    return true;
 }   
 
 bool Coach::run () {
     
     // Perform checks.
-    if (!m_wavenet) {
+    if (!m_wavenet && m_fanout.empty()) {
         ERROR("WaveletML object not set.Exiting.");
         return false;
     }
@@ -100,7 +208,7 @@ bool Coach::run () {
             WARNING(".. a generator with no natural epochs and with");
             WARNING(".. no target precision set. Etiher choose a ");
             WARNING(".. different generator or use");
-            WARNING(".. 'Coach::setUseAdaptiveLearningRate()' or")
+            WARNING(".. 'Coach::setUseAdaptiveLearningRate()' or");
             WARNING(".. 'Coach::setUseAdaptiveLearningRate()', and");
             WARNING("'Coach::setTargetPrecision(someValue)'.");
             WARNING("Exiting.");
@@ -109,23 +217,121 @@ bool Coach::run () {
     }
     
     INFO("Start training, using coach '%s'.", m_name.c_str());
-    
-    // Save base snapshot of initial condition, so as to be able to restore same 
-    // configuration for each intitialisation (in particular, to roll back 
-    //changes made by adaptive learning methods.)
-    Snapshot baseSnap (outdir() + "snapshots/.tmp.snap");
-    m_wavenet->save(baseSnap);
-    
-    // Define number of trailing steps, for use with adaptive learning rate.
-    const unsigned useLastN = 10;
-    // Definition bare, specified regularsation constant, for use with simulated
-    // annealing.
-    const double lambdaBare = m_wavenet->lambda(); 
-    
-    // Define snapshot object, for saving the final configuration for each 
-    // initialisation.
-    Snapshot snap (outdir() + "snapshots/" + m_name + ".%06u.snap", 0);
 
+    // Collect the wavenet instances to train: the member wavenet, saved under
+    // the name of the coach, and those added for fan-out training, each saved
+    // under its own name. All are trained on the same examples, each of which
+    // is only taken from the generator once.
+    std::vector<Trainee> trainees;
+    if (m_wavenet) { trainees.push_back(Trainee(m_wavenet, m_name, m_numCoeffs)); }
+    for (const Trainee& trainee : m_fanout) {
+        trainees.push_back(trainee);
+        if (trainee.numCoeffs == 0) { trainees.back().numCoeffs = m_numCoeffs; }
+    }
+    for (unsigned i = 0; i < trainees.size(); i++) {
+        for (unsigned j = 0; j < i; j++) {
+            if (trainees[i].wavenet == trainees[j].wavenet || trainees[i].name == trainees[j].name) {
+                ERROR("Wavenet '%s' is added more than once, or shares its name with another. Exiting.", trainees[i].name.c_str());
+                return false;
+            }
+        }
+    }
+    const bool fanout = (trainees.size() > 1);
+    if (fanout) {
+        INFO("Training %d wavenets on each example, in parallel.", trainees.size());
+    }
+
+    // In distributed training, only rank 0 writes output.
+    const bool distributed = (m_communicator && m_communicator->size() > 1);
+    const bool root = (!distributed || m_communicator->rank() == 0);
+    if (distributed) {
+        if (!m_communicator->initialised()) {
+            ERROR("Communicator was not properly initialised. Exiting.");
+            return false;
+        }
+        if (fanout) {
+            ERROR("Fan-out mode is not supported in distributed training. Exiting.");
+            return false;
+        }
+        INFO("Training as rank %d of %d.", m_communicator->rank(), m_communicator->size());
+    }
+
+    // Asynchronous training is only supported for a single wavenet, trained on
+    // single-channel examples at a fixed resolution.
+    if (m_numWorkers > 1) {
+        if (fanout || distributed || !m_curriculum.empty() || m_generator->numChannels() > 1) {
+            ERROR("Asynchronous training doesn't support fan-out mode, distributed training, curricula, or multi-channel examples. Exiting.");
+            return false;
+        }
+        if (useAdaptiveLearningRate() || useAdaptiveBatchSize() || useSimulatedAnnealing() || m_dedupRadius > 0 || m_pruneEvents > 0) {
+            WARNING("Adaptive learning, simulated annealing, pruning, and deduplication are not used in asynchronous training.");
+        }
+        INFO("Training asynchronously, using %d workers.", m_numWorkers);
+    }
+
+    // The Newton steps use the most recent examples used by the synchronous
+    // training. In distributed training, these differ between ranks, which 
+    // would cause the wavenets to diverge.
+    if (m_newtonSteps > 0) {
+        if (distributed || m_numWorkers > 1 || m_generator->numChannels() > 1) {
+            ERROR("Newton steps are not supported in distributed or asynchronous training, or for multi-channel examples. Exiting.");
+            return false;
+        }
+    }
+
+    for (Trainee& trainee : trainees) {
+
+        // Prefix progress information with the name of each wavenet, in 
+        // fan-out mode.
+        trainee.label = (fanout ? "[" + trainee.name + "] " : "");
+
+        // Reset the metrics, such that rates refer to the current run.
+        trainee.wavenet->metrics().reset();
+        if (m_metricsInterval > 0 && root && !checkMakeDir_(outdir_(trainee))) {
+            ERROR("Cannot write metrics for '%s'. Exiting.", trainee.name.c_str());
+            return false;
+        }
+
+        // Average the batch gradients over all ranks, in distributed training.
+        if (distributed) { trainee.wavenet->setCommunicator(m_communicator); }
+
+        // Definition bare, specified regularsation constant, for use with 
+        // simulated annealing.
+        trainee.lambdaBare = trainee.wavenet->lambda();
+
+        // Save base snapshot of initial condition, so as to be able to restore 
+        // same configuration for each intitialisation (in particular, to roll 
+        // back changes made by adaptive learning methods.)
+        // Each rank keeps its own base snapshot.
+        const std::string tmp = (distributed ? ".tmp." + std::to_string(m_communicator->rank()) : ".tmp");
+        trainee.baseSnap = Snapshot(outdir_(trainee) + "snapshots/" + tmp + ".snap");
+        trainee.wavenet->save(trainee.baseSnap);
+
+        // Define snapshot object, for saving the final configuration for each 
+        // initialisation.
+        trainee.snap = Snapshot(outdir_(trainee) + "snapshots/" + trainee.name + ".%06u.snap", 0);
+    }
+
+    // Buffers holding a block of training examples, in fan-out mode and in 
+    // distributed training. For a single wavenet, the examples are otherwise 
+    // used directly from the generator.
+    const bool buffered = (fanout || distributed);
+    const unsigned blockSize = (buffered ? std::max(m_blockSize, 1u) : 1u);
+    std::vector< arma::Mat<double> >  blockExamples (buffered ? blockSize : 0);
+    std::vector< arma::Cube<double> > blockChannels (buffered ? blockSize : 0);
+    std::vector< const arma::Mat<double>* >  examples (blockSize, nullptr);
+    std::vector< const arma::Cube<double>* > channels (blockSize, nullptr);
+
+    // Ring buffer holding the most recent examples, for the Newton steps at 
+    // the end of each initialisation.
+    std::vector< arma::Mat<double> > recent;
+    unsigned recentNext = 0;
+
+    // Wrap the generator, to pool the input according to the coarse-to-fine 
+    // curriculum, if any.
+    PoolingGenerator pooling (m_generator);
+    GeneratorBase* generator = (m_curriculum.empty() ? m_generator : &pooling);
+    
     // Loop initialisations.
     for (unsigned init = 0; init < m_numInits; init++) {
 
@@ -134,165 +340,614 @@ bool Coach::run () {
             INFO("Initialisation %d/%d", init + 1, m_numInits);
         }
 
-        // Load base snapshot.
-        m_wavenet->load(baseSnap);
-        m_wavenet->clear();
+        for (Trainee& trainee : trainees) {
+
+            // Load base snapshot.
+            trainee.wavenet->load(trainee.baseSnap);
+            trainee.wavenet->clear();
+
+            // Generate initial coefficient configuration as random point on 
+            // unit N-sphere. In this way we immediately fullfill one out of the
+            // (at most) four (non-trivial) conditions on the filter 
+            // coefficients. With a fixed seed, all wavenets with the same 
+            // number of filter coefficients start from the same point.
+            // In distributed training, all ranks start from the point 
+            // generated on rank 0.
+            if (m_seed >= 0) { arma::arma_rng::set_seed(m_seed + init); }
+            arma::Col<double> filter = PointOnNSphere(trainee.numCoeffs);
+            if (distributed && !m_communicator->broadcast(filter, 0)) {
+                ERROR("Failed to broadcast the initial filter coefficients. Exiting.");
+                return false;
+            }
+            trainee.wavenet->setFilter(std::move(filter));
+
+            // Definitions for adaptive learning.
+            trainee.done = false;
+            trainee.failed = false;
+            trainee.tail = 0;
+            trainee.currentCostLogSize  = 0;
+            trainee.previousCostLogSize = 0;
+
+            // Definitions for pruning and deduplication.
+            trainee.events         = 0;
+            trainee.nextCheckpoint = m_pruneEvents;
+            trainee.checkpoint     = 0;
+            trainee.filterLogSize  = 0;
+            trainee.stopped        = false;
+        }
 
-        // Generate initial coefficient configuration as random point on unit 
-        // N-sphere. In this way we immediately fullfill one out of the (at 
-        // most) four (non-trivial) conditions on the filter coefficients.
-        m_wavenet->setFilter( PointOnNSphere(m_numCoeffs) );
+        // Start from the coarsest stage of the curriculum.
+        int stageEvents = 0;
+        setStage_(0, pooling, trainees);
+        recent.clear();
+        recentNext = 0;
         
-        // Definitions for adaptive learning.
-        bool done = false; // Whether the training is done, i.e. whether to 
-                           // break training early
-        unsigned tail = 0; // The number of updates since beginning of training 
-                           // or last update of the learning rate, whichever is 
-                           // latest.
-        unsigned currentCostLogSize  = 0; // Number of entries in cost log, now 
-        unsigned previousCostLogSize = 0; // and at previous step in the loop. 
-                                          // Used to determine whether a batch
-                                          // update occurred.
-        
-        // Get the number of digits to use when printing the number of events.
-        const unsigned eventDigits = (m_numEvents > 0 ? unsigned(log10(m_numEvents)) + 1 : 1);
-
         // Loop epochs.
         for (unsigned epoch = 0; epoch < m_numEpochs; epoch++) {
 
             // Reset (re-open) generator.
-            m_generator->reset();
+            generator->reset();
 
             // Print progress.
             if (m_printLevel > 1) {
                 INFO("  Epoch %d/%d", epoch + 1, m_numEpochs);
             }
 
-            // Loop events.
+            // Train asynchronously on all examples in the epoch.
+            if (m_numWorkers > 1) {
+                trainAsync_(trainees.front(), generator);
+                if (allDone_(trainees)) { break; }
+                continue;
+            }
+
+            // Loop events, in blocks.
+            for (Trainee& trainee : trainees) {
+                trainee.eventPrint = trainee.wavenet->batchSize();
+            }
             int event = 0;
-            int eventPrint = m_wavenet->batchSize(); 
+            bool more = true;
             do {
-                // Simulated annealing.
-                if (useSimulatedAnnealing()) {
-                     const double f = (event + epoch * numEvents()) / float(numEvents() * numEpochs());
-                     const double effectiveLambda = lambdaBare * f / sq(2 - f);
-                     m_wavenet->setLambda(effectiveLambda);
+                // Get the next block of training examples. Multi-channel 
+                // examples are decoded once, and all channels are trained on
+                // together.
+                const bool multiChannel = (generator->numChannels() > 1);
+                const int  first = event;
+                unsigned nBlock = 0;
+                do {
+                    PROFILE("GeneratorBase::next");
+                    const unsigned long long start = Profiler::instance().now();
+                    if (multiChannel) {
+                        channels[nBlock] = &generator->nextChannels();
+                        if (buffered) {
+                            blockChannels[nBlock] = *channels[nBlock];
+                            channels[nBlock] = &blockChannels[nBlock];
+                        }
+                    } else {
+                        examples[nBlock] = &generator->next();
+                        if (buffered) {
+                            blockExamples[nBlock] = *examples[nBlock];
+                            examples[nBlock] = &blockExamples[nBlock];
+                        }
+                        if (m_newtonSteps > 0) {
+                            if (recent.size() < m_newtonExamples) { recent.push_back(*examples[nBlock]); }
+                            else                                  { recent[recentNext] = *examples[nBlock]; }
+                            recentNext = (recentNext + 1) % m_newtonExamples;
+                        }
+                    }
+                    const unsigned long long wait = Profiler::instance().now() - start;
+                    for (Trainee& trainee : trainees) {
+                        trainee.wavenet->metrics().addGeneratorWait(wait);
+                    }
+
+                    // Increment event number. (Only level not in a for-loop, 
+                    // since the number of events may be unspecified, i.e. be 
+                    // -1.) If the generator is not in a good condition, break.
+                    ++nBlock;
+                    ++event;
+                    more = generator->good() && (event < m_numEvents || m_numEvents < 0);
+                } while (more && nBlock < blockSize);
+
+                // In distributed training, all ranks train on the number of
+                // examples in the smallest block, and continue only if all 
+                // generators are in a good condition, such that the batches of
+                // all ranks line up.
+                if (distributed) {
+                    arma::Col<double> sync = {double(nBlock), double(more)};
+                    if (!m_communicator->allReduce(sync, Communicator::Reduction::Min)) {
+                        ERROR("Failed to synchronise with the other ranks. Exiting.");
+                        return false;
+                    }
+                    nBlock = sync(0);
+                    more   = (sync(1) > 0);
+                    event  = first + nBlock;
                 }
 
-                // Main training call.
-                bool status = m_wavenet->train( m_generator->next() );
+                // Train each wavenet on the block of examples, in parallel in
+                // fan-out mode.
+                auto trainBlock = [&] (Trainee& trainee) {
+                    for (unsigned i = 0; i < nBlock && !trainee.done; i++) {
+                        step_(trainee, examples[i], (multiChannel ? channels[i] : nullptr), first + i, epoch);
+                    }
+                };
+
+                if (fanout) {
+                    std::vector<std::thread> threads;
+                    for (Trainee& trainee : trainees) {
+                        if (trainee.done) { continue; }
+                        threads.emplace_back(trainBlock, std::ref(trainee));
+                    }
+                    for (std::thread& thread : threads) { thread.join(); }
+                } else {
+                    trainBlock(trainees.front());
+                }
 
-                // In case something goes wrong.
-                if (!status) {
-                    done = true;
-                    break;
+                // In distributed training, a failed collective call leaves the
+                // ranks out of step, so stop on all ranks (@see Communicator).
+                if (distributed && !m_communicator->initialised()) {
+                    ERROR("Lost the connection to the other ranks. Exiting.");
+                    return false;
                 }
 
-                // Adaptive learning rate.
-                if (useAdaptiveLearningRate() || useAdaptiveBatchSize()) {
-
-                    // Determine whether a batch upate took place, by checking 
-                    // whether the size of the cost log changed.
-                    previousCostLogSize = currentCostLogSize;
-                    currentCostLogSize  = m_wavenet->costLog().size();
-                    bool changed = (currentCostLogSize != previousCostLogSize);
-                    
-
-                    // If it changed and the tail (number of updates since last 
-                    // learning rate update) is sufficiently large, initiate
-                    // adaptation.
-                    if (changed && ++tail > useLastN) {
-                        
-                        const unsigned filterLogSize = m_wavenet->filterLog().size();
-
-                        // Compute the (vector) size of the last N steps in the 
-                        // SGD, as well as the mean (scalar) size of these.
-                        std::vector< arma::Col<double> > lastNsteps(useLastN);
-                        double meanStepSize  = 0;
-                        for (unsigned i = 0; i < useLastN; i++) {
-                            lastNsteps.at(i) = m_wavenet->filterLog().at(filterLogSize - useLastN + i) - m_wavenet->filterLog().at(filterLogSize - useLastN + i - 1);
-                            meanStepSize += arma::norm(lastNsteps.at(i));
-                        }
-                        meanStepSize /= float(useLastN);
-                        
-                        // Compute the total (vector) size of the last N steps 
-                        // in the SGD combined, as well as the (scalar) size.
-                        arma::Col<double> totalStep = m_wavenet->filterLog().at(filterLogSize - 1) - m_wavenet->filterLog().at(filterLogSize - 1 - useLastN);
-                        double totalStepSize = arma::norm(totalStep);
-                       
-                        // Check whether we have reached target precision or 
-                        // whether to perform adaptive learning rate update. 
-                        if (targetPrecision() != -1 && meanStepSize < targetPrecision() && !useSimulatedAnnealing()) {
-                            INFO("[Adaptive learning] The mean step size over the last %d updates (%f)", useLastN, meanStepSize);
-                            INFO("[Adaptive learning] is smaller than the target precision (%f). Done.", targetPrecision());
-                            done = true;
-                        } else if (totalStepSize < meanStepSize) {
-                            INFO("[Adaptive learning] Total step size (%f) is smaller than mean step size (%f).", totalStepSize, meanStepSize);
-
-                            // Update batch size.
-                            if (useAdaptiveBatchSize()) {
-                               INFO("[Adaptive learning]   Increasing batch size from %d to %d.", m_wavenet->batchSize(), 2 * m_wavenet->batchSize());
-                               m_wavenet->setBatchSize( 2 * m_wavenet->batchSize() );
-                            }
-
-                            // Update learning rate.
-                            if (useAdaptiveLearningRate()) {
-                                INFO("[Adaptive learning]   Reducing learning rate (alpha) from %f to %f.", m_wavenet->alpha(), (1./2.) * m_wavenet->alpha() ); //* (totalStepSize/meanStepSize));
-                                m_wavenet->setAlpha( (1./2.) * m_wavenet->alpha() ); // * (totalStepSize/meanStepSize));
-                            }
-
-                            tail = 0;
-                        }
-                        
-                        
+                // Periodically write metrics to file.
+                for (Trainee& trainee : trainees) {
+                    Metrics& metrics = trainee.wavenet->metrics();
+                    if (m_metricsInterval > 0 && root && metrics.elapsed() - trainee.lastMetricsWrite > m_metricsInterval) {
+                        trainee.lastMetricsWrite = metrics.elapsed();
+                        metrics.writeCSV(outdir_(trainee) + "metrics.csv");
                     }
-                    
-                } 
-
-                // Print progress.
-                if (m_printLevel > 2 && ((event + 1) % eventPrint == 0  || event + 1 == m_numEvents)) {
-                    if (m_numEvents == -1) { INFO("    Event %*d/- (cost: %7.3f)",   eventDigits, event + 1, m_wavenet->lastCost()); }
-                    else                   { INFO("    Event %*d/%*d (cost: %7.3f)", eventDigits, event + 1, eventDigits, m_numEvents, m_wavenet->lastCost()); }
-                    if ((event + 1) == 10 * eventPrint) { eventPrint *= 10; }
                 }
 
-                // Increment event number. (Only level not in a for-loop, since
-                // the number of events may be unspecified, i.e. be -1.)
-                ++event;
-
-                // If the generator is not in a good condition, break.
-                if (!m_generator->good()) { break; }
+                // Proceed to the next stage of the curriculum on schedule, or
+                // once converged at the current one.
+                stageEvents += nBlock;
+                if (!finalStage_() &&
+                    ((m_curriculumEvents > 0 && stageEvents >= m_curriculumEvents) || 
+                     allConverged_(trainees))) {
+                    stageEvents = 0;
+                    setStage_(m_stage + 1, pooling, trainees);
+                    recent.clear();
+                    recentNext = 0;
+                }
 
-            } while (!done && (event < m_numEvents || m_numEvents < 0 ));
+            } while (more && !allDone_(trainees));
             
-            if (done) { break; }
+            if (allDone_(trainees)) { break; }
         }
-        
-        // Clean up, by removing the last entry in the cost log, which isn't  
-        // properly scaled to batch size since the batch queue hasn't been flushed,  
-        // and therefore might bias result.
-        m_wavenet->costLog().pop_back(); 
 
-        // Saving snapshot to file.
-        m_wavenet->save(snap++);
+        for (Trainee& trainee : trainees) {
+
+            // Refine the solution using Newton steps, unless the 
+            // initialisation was stopped early, or failed.
+            if (m_newtonSteps > 0 && !trainee.stopped && !trainee.failed) { polish_(trainee, recent); }
+
+            // Clean up, by removing the last entry in the cost log, which isn't
+            // properly scaled to batch size since the batch queue hasn't been 
+            // flushed, and therefore might bias result.
+            trainee.wavenet->costLog().pop_back(); 
+
+            // Saving snapshot to file.
+            if (root) { trainee.wavenet->save(trainee.snap); }
+            ++trainee.snap;
+
+            // Record the solution, unless the initialisation was stopped early
+            // or converged to a solution already found.
+            if (!trainee.stopped) {
+                const arma::Col<double>& filter = trainee.wavenet->filter();
+                bool found = false;
+                for (const arma::Col<double>& solution : trainee.solutions) {
+                    found |= (FilterDistance(filter, solution) < std::max(m_dedupRadius, 0.));
+                }
+                if (!found) { trainee.solutions.push_back(CanonicalFilter(filter)); }
+            }
+        }
+    }
+
+    // Print summary of the initialisations.
+    if (m_dedupRadius > 0 || m_pruneEvents > 0) {
+        for (Trainee& trainee : trainees) {
+            INFO("%sFound %d distinct solution(s) in %d initialisation(s); %d pruned, and %d stopped as duplicates.",
+                 trainee.label.c_str(), trainee.solutions.size(), m_numInits, trainee.numPruned, trainee.numDuplicates);
+        }
     }
     
+    // Print summary of the solutions certified as local minima.
+    if (m_newtonSteps > 0) {
+        for (Trainee& trainee : trainees) {
+            INFO("%s%d of %d solution(s) refined by Newton steps were certified as local minima.",
+                 trainee.label.c_str(), trainee.numCertified, trainee.numPolished);
+        }
+    }
+
+    // Print summary of diverging updates, which were rolled back.
+    for (Trainee& trainee : trainees) {
+        const Metrics& metrics = trainee.wavenet->metrics();
+        if (metrics.rollbacks() > 0) {
+            WARNING("%sRolled back %llu diverging update(s), discarding %llu example(s).",
+                    trainee.label.c_str(), metrics.rollbacks(), metrics.discardedExamples());
+        }
+    }
+
+    // Print and export the metrics.
+    for (Trainee& trainee : trainees) {
+        Metrics& metrics = trainee.wavenet->metrics();
+        if (m_printLevel > 0) {
+            INFO("%sMetrics:", trainee.label.c_str());
+            metrics.print();
+        }
+        if (!root) { continue; }
+        INFO("Writing metrics to '%s'.", (outdir_(trainee) + "metrics.json").c_str());
+        metrics.writeJSON(outdir_(trainee) + "metrics.json");
+    }
+
+    // Print and export the timing summary, if the profiler is enabled.
+    if (Profiler::enabled() && root && checkMakeOutdir()) {
+        Profiler& profiler = Profiler::instance();
+        INFO("Timing summary:");
+        profiler.summary();
+        INFO("Writing timings to '%s'.", (outdir() + "profile.json").c_str());
+        profiler.exportJSON(outdir() + "profile.json");
+        if (Profiler::tracing()) {
+            INFO("Writing trace to '%s'.", (outdir() + "trace.json").c_str());
+            profiler.exportChromeTrace(outdir() + "trace.json");
+        }
+    }
+
     // Writing setup to run-specific README file.
-    INFO("Writing run configuration to '%s'.", (outdir() + "README").c_str());
-    std::ofstream outFileStream (outdir() + "README");
-    
-    outFileStream << "m_numEvents: " << m_numEvents << "\n";
-    outFileStream << "m_numEpochs: " << m_numEpochs << "\n";
-    outFileStream << "m_numInits: "  << m_numInits  << "\n";
-    outFileStream << "m_numCoeffs: " << m_numCoeffs << "\n";
-    
-    outFileStream.close();
+    for (Trainee& trainee : trainees) {
+        if (!root) { continue; }
+        INFO("Writing run configuration to '%s'.", (outdir_(trainee) + "README").c_str());
+        std::ofstream outFileStream (outdir_(trainee) + "README");
+        
+        outFileStream << "m_numEvents: " << m_numEvents << "\n";
+        outFileStream << "m_numEpochs: " << m_numEpochs << "\n";
+        outFileStream << "m_numInits: "  << m_numInits  << "\n";
+        outFileStream << "m_numCoeffs: " << trainee.numCoeffs << "\n";
+        if (distributed) {
+            outFileStream << "m_numRanks: " << m_communicator->size() << "\n";
+        }
+        if (!m_curriculum.empty()) {
+            outFileStream << "m_curriculum:";
+            for (const unsigned& factor : m_curriculum) { outFileStream << " " << factor; }
+            outFileStream << "\n";
+            outFileStream << "m_curriculumEvents: "    << m_curriculumEvents    << "\n";
+            outFileStream << "m_curriculumPrecision: " << m_curriculumPrecision << "\n";
+        }
+        if (m_dedupRadius > 0) {
+            outFileStream << "m_dedupRadius: " << m_dedupRadius << "\n";
+        }
+        if (m_pruneEvents > 0) {
+            outFileStream << "m_pruneEvents: " << m_pruneEvents << "\n";
+            outFileStream << "m_pruneFactor: " << m_pruneFactor << "\n";
+        }
+        
+        outFileStream.close();
+    }
 
-    // We're not clearing the wavenet object, since it might be useful to look 
+    // We're not clearing the wavenet objects, since it might be useful to look
     // at the filter- and cost log immediately after training (i.e. without 
     // interacting with Snapshots).
 
     return true;   
 }
 
+void Coach::step_ (Trainee& trainee, const arma::Mat<double>* example, const arma::Cube<double>* channels,
+                   const int& event, const unsigned& epoch) {
+
+    Wavenet* wavenet = trainee.wavenet;
+    const char* label = trainee.label.c_str();
+
+    // Define number of trailing steps, for use with adaptive learning rate.
+    const unsigned useLastN = 10;
+
+    // Simulated annealing.
+    if (useSimulatedAnnealing()) {
+         const double f = (event + epoch * numEvents()) / float(numEvents() * numEpochs());
+         const double effectiveLambda = trainee.lambdaBare * f / sq(2 - f);
+         wavenet->setLambda(effectiveLambda);
+    }
+
+    // Main training call.
+    bool status = (channels ? wavenet->train(*channels) : wavenet->train(*example));
+
+    // In case something goes wrong, e.g. if the updates keep diverging after
+    // being rolled back (@see Wavenet::setRollback).
+    if (!status) {
+        trainee.done = trainee.failed = true;
+        return;
+    }
+
+    // Adaptive learning rate.
+    if (useAdaptiveLearningRate() || useAdaptiveBatchSize()) {
+
+        // Determine whether a batch upate took place, by checking whether the 
+        // size of the cost log changed.
+        trainee.previousCostLogSize = trainee.currentCostLogSize;
+        trainee.currentCostLogSize  = wavenet->costLog().size();
+        bool changed = (trainee.currentCostLogSize != trainee.previousCostLogSize);
+
+        // Adaptive batch size, using the norm test on the statistics of the 
+        // batch used for the update. In distributed training, the statistics
+        // are those of the combined batch of all ranks, such that all ranks 
+        // choose the same batch size.
+        if (useAdaptiveBatchSize() && changed && wavenet->batchCount() > 1) {
+            const double variance = arma::sum(wavenet->batchVariance());
+            const double norm2    = arma::dot(wavenet->batchGradient(), wavenet->batchGradient());
+            const double required = (norm2 > 0 ? variance / (sq(m_batchSizeTheta) * norm2) : 0.);
+            if (required > wavenet->batchCount()) {
+
+                // Scale the batch size of this rank, and limit it to the number
+                // of events.
+                unsigned batchSize = (unsigned) std::ceil(wavenet->batchSize() * required / double(wavenet->batchCount()));
+                if (m_numEvents > 0) { batchSize = std::min(batchSize, (unsigned) m_numEvents); }
+                if (batchSize > (unsigned) wavenet->batchSize()) {
+                    INFO("%s[Adaptive learning] Gradient variance (%f) is large compared to gradient norm (%f).", label, variance / double(wavenet->batchCount()), sqrt(norm2));
+                    INFO("%s[Adaptive learning]   Increasing batch size from %d to %d.", label, wavenet->batchSize(), batchSize);
+                    wavenet->setBatchSize(batchSize);
+                }
+            }
+        }
+        
+        // If it changed and the tail (number of updates since last learning 
+        // rate update) is sufficiently large, initiate adaptation.
+        if (changed && ++trainee.tail > useLastN) {
+            
+            const unsigned filterLogSize = wavenet->filterLog().size();
+
+            // Compute the (vector) size of the last N steps in the SGD, as well
+            // as the mean (scalar) size of these.
+            std::vector< arma::Col<double> > lastNsteps(useLastN);
+            double meanStepSize  = 0;
+            for (unsigned i = 0; i < useLastN; i++) {
+                lastNsteps.at(i) = wavenet->filterLog().at(filterLogSize - useLastN + i) - wavenet->filterLog().at(filterLogSize - useLastN + i - 1);
+                meanStepSize += arma::norm(lastNsteps.at(i));
+            }
+            meanStepSize /= float(useLastN);
+            
+            // Compute the total (vector) size of the last N steps in the SGD 
+            // combined, as well as the (scalar) size.
+            arma::Col<double> totalStep = wavenet->filterLog().at(filterLogSize - 1) - wavenet->filterLog().at(filterLogSize - 1 - useLastN);
+            double totalStepSize = arma::norm(totalStep);
+           
+            // Check whether we have reached target precision or whether to 
+            // perform adaptive learning rate update. 
+            if (targetPrecision() != -1 && meanStepSize < targetPrecision() && !useSimulatedAnnealing() && !finalStage_()) {
+                // Before the last stage of the curriculum, proceed to the next
+                // stage rather than ending the training.
+                trainee.converged = true;
+            } else if (targetPrecision() != -1 && meanStepSize < targetPrecision() && !useSimulatedAnnealing()) {
+                INFO("%s[Adaptive learning] The mean step size over the last %d updates (%f)", label, useLastN, meanStepSize);
+                INFO("%s[Adaptive learning] is smaller than the target precision (%f). Done.", label, targetPrecision());
+                trainee.done = true;
+            } else if (totalStepSize < meanStepSize) {
+                INFO("%s[Adaptive learning] Total step size (%f) is smaller than mean step size (%f).", label, totalStepSize, meanStepSize);
+
+                // Update batch size, if the variance of the gradients couldn't
+                // be estimated from the batch.
+                if (useAdaptiveBatchSize() && wavenet->batchCount() < 2) {
+                   INFO("%s[Adaptive learning]   Increasing batch size from %d to %d.", label, wavenet->batchSize(), 2 * wavenet->batchSize());
+                   wavenet->setBatchSize( 2 * wavenet->batchSize() );
+                }
+
+                // Update learning rate.
+                if (useAdaptiveLearningRate()) {
+                    INFO("%s[Adaptive learning]   Reducing learning rate (alpha) from %f to %f.", label, wavenet->alpha(), (1./2.) * wavenet->alpha() ); //* (totalStepSize/meanStepSize));
+                    wavenet->setAlpha( (1./2.) * wavenet->alpha() ); // * (totalStepSize/meanStepSize));
+                }
+
+                trainee.tail = 0;
+            }
+        }
+    } 
+
+    // Detect convergence at the current stage of the curriculum, from the mean
+    // step size over the last N updates at this stage.
+    if (m_curriculumPrecision > 0 && !finalStage_() && !trainee.converged) {
+        const unsigned filterLogSize = wavenet->filterLog().size();
+        if (filterLogSize > trainee.stageStart + useLastN) {
+            double meanStepSize = 0;
+            for (unsigned i = 0; i < useLastN; i++) {
+                meanStepSize += arma::norm(wavenet->filterLog().at(filterLogSize - useLastN + i) - wavenet->filterLog().at(filterLogSize - useLastN + i - 1));
+            }
+            meanStepSize /= float(useLastN);
+            trainee.converged = (meanStepSize < m_curriculumPrecision);
+        }
+    }
+
+    // Stop the initialisation early, if it is a duplicate or is pruned.
+    ++trainee.events;
+    checkRestart_(trainee, useLastN);
+
+    // Print progress.
+    const unsigned eventDigits = (m_numEvents > 0 ? unsigned(log10(m_numEvents)) + 1 : 1);
+    if (m_printLevel > 2 && ((event + 1) % trainee.eventPrint == 0  || event + 1 == m_numEvents)) {
+        if (m_numEvents == -1) { INFO("    %sEvent %*d/- (cost: %7.3f)",   label, eventDigits, event + 1, wavenet->lastCost()); }
+        else                   { INFO("    %sEvent %*d/%*d (cost: %7.3f)", label, eventDigits, event + 1, eventDigits, m_numEvents, wavenet->lastCost()); }
+        if ((event + 1) == 10 * trainee.eventPrint) { trainee.eventPrint *= 10; }
+    }
+
+    return;
+}
+
+bool Coach::allDone_ (const std::vector<Trainee>& trainees) const {
+    for (const Trainee& trainee : trainees) {
+        if (!trainee.done) { return false; }
+    }
+    return true;
+}
+
+void Coach::setStage_ (const unsigned& stage, PoolingGenerator& pooling, std::vector<Trainee>& trainees) {
+
+    m_stage = stage;
+    if (m_curriculum.empty()) { return; }
+    pooling.setFactor(m_curriculum.at(stage));
+
+    // Measure convergence from the start of the stage.
+    for (Trainee& trainee : trainees) {
+        trainee.converged  = false;
+        trainee.stageStart = trainee.wavenet->filterLog().size();
+    }
+
+    // Print progress.
+    if (m_printLevel > 1) {
+        INFO("  Curriculum stage %d/%d (pooling factor %d)", stage + 1, m_curriculum.size(), m_curriculum.at(stage));
+    }
+
+    return;
+}
+
+void Coach::checkRestart_ (Trainee& trainee, const unsigned& useLastN) {
+
+    Wavenet* wavenet = trainee.wavenet;
+    const char* label = trainee.label.c_str();
+
+    // Check, after each update, whether the filter coefficients have entered
+    // the basin of a previously found solution.
+    const unsigned filterLogSize = wavenet->filterLog().size();
+    if (m_dedupRadius > 0 && filterLogSize != trainee.filterLogSize) {
+        trainee.filterLogSize = filterLogSize;
+        for (const arma::Col<double>& solution : trainee.solutions) {
+            const double distance = FilterDistance(wavenet->filter(), solution);
+            if (distance < m_dedupRadius) {
+                INFO("%s[Restarts] Filter is within %f of a previously found solution. Stopping.", label, distance);
+                trainee.done = trainee.stopped = true;
+                ++trainee.numDuplicates;
+                return;
+            }
+        }
+    }
+
+    // Successive halving, at each checkpoint.
+    if (m_pruneEvents > 0 && trainee.events == trainee.nextCheckpoint) {
+
+        // Compute the mean cost over the last N updates. The last entry in the
+        // cost log is the running sum of the current batch, and is not used.
+        const std::vector<double>& costLog = wavenet->costLog();
+        if (costLog.size() > 1) {
+            const unsigned n = std::min<unsigned>(useLastN, costLog.size() - 1);
+            double cost = 0;
+            for (unsigned i = costLog.size() - 1 - n; i < costLog.size() - 1; i++) {
+                cost += costLog[i];
+            }
+            cost /= float(n);
+
+            // Keep the initialisation only if it is among the best 1/factor of
+            // all initialisations having reached this checkpoint.
+            if (trainee.checkpointCosts.size() <= trainee.checkpoint) {
+                trainee.checkpointCosts.resize(trainee.checkpoint + 1);
+            }
+            std::vector<double>& costs = trainee.checkpointCosts[trainee.checkpoint];
+            costs.push_back(cost);
+            const unsigned keep = (costs.size() + m_pruneFactor - 1) / m_pruneFactor;
+            const unsigned rank = std::count_if(costs.begin(), costs.end(), [&] (const double& c) { return c < cost; });
+            if (rank >= keep) {
+                INFO("%s[Restarts] Cost (%f) at checkpoint %d is not among the best %d of %d. Pruning.",
+                     label, cost, trainee.checkpoint + 1, keep, costs.size());
+                trainee.done = trainee.stopped = true;
+                ++trainee.numPruned;
+            }
+        }
+
+        ++trainee.checkpoint;
+        trainee.nextCheckpoint *= m_pruneFactor;
+    }
+
+    return;
+}
+
+int Coach::trainAsync_ (Trainee& trainee, GeneratorBase* generator) {
+
+    Wavenet* wavenet = trainee.wavenet;
+
+    // The workers take examples from the generator, which isn't thread-safe,
+    // one at a time.
+    std::mutex mutex;
+    int event = 0;
+    bool more = true;
+    auto next = [&] (arma::Mat<double>& X) {
+        std::lock_guard<std::mutex> lock (mutex);
+        if (!more) { return false; }
+        PROFILE("GeneratorBase::next");
+        const unsigned long long start = Profiler::instance().now();
+        X = generator->next();
+        wavenet->metrics().addGeneratorWait(Profiler::instance().now() - start);
+
+        // Increment event number. If the generator is not in a good condition,
+        // stop.
+        ++event;
+        more = generator->good() && (event < m_numEvents || m_numEvents < 0);
+        return true;
+    };
+
+    // Main training call.
+    if (!wavenet->trainAsync(next, m_numWorkers)) {
+        trainee.done = trainee.failed = true;
+    }
+
+    // Print progress.
+    if (m_printLevel > 2) {
+        INFO("    %sEvents: %d (cost: %7.3f)", trainee.label.c_str(), event, wavenet->lastCost());
+    }
+
+    return event;
+}
+
+bool Coach::allConverged_ (const std::vector<Trainee>& trainees) const {
+    for (const Trainee& trainee : trainees) {
+        if (!trainee.converged && !trainee.done) { return false; }
+    }
+    return true;
+}
+
+void Coach::polish_ (Trainee& trainee, const std::vector< arma::Mat<double> >& examples) {
+
+    PROFILE("Coach::polish_");
+
+    Wavenet* wavenet = trainee.wavenet;
+    const char* label = trainee.label.c_str();
+
+    if (examples.empty()) {
+        WARNING("%sNo examples for Newton steps.", label);
+        return;
+    }
+
+    // Take damped Newton steps, until these no longer decrease the cost.
+    unsigned step = 0;
+    while (step < m_newtonSteps && wavenet->newtonStep(examples)) { ++step; }
+
+    // Compute the gradient and the eigenvalues of the Hessian at the solution.
+    arma::Col<double> gradient, eigval;
+    arma::Mat<double> hessian, eigvec;
+    double cost;
+    if (!wavenet->gradient(examples, gradient, cost) || !wavenet->hessian(examples, hessian) ||
+        !arma::eig_sym(eigval, eigvec, hessian)) {
+        WARNING("%sCould not compute the curvature at the solution.", label);
+        return;
+    }
+    ++trainee.numPolished;
+
+    // The solution is certified as a local minimum if the Hessian is positive
+    // definite, and the distance to the minimum of the local quadratic model, 
+    // |H^{-1} g|, is smaller than the target precision (or 1e-04, if none is 
+    // set).
+    const double tolerance = (targetPrecision() > 0 ? targetPrecision() : 1.0e-04);
+    const bool   positive  = (eigval.min() > 0);
+    const double distance  = (positive ? arma::norm(eigvec * ((eigvec.t() * gradient) / eigval)) : arma::norm(gradient));
+    const bool   certified = positive && distance < tolerance;
+    if (certified) { ++trainee.numCertified; }
+
+    if (m_printLevel > 0) {
+        INFO("%s[Second order] After %d Newton step(s): cost %f, gradient norm %.2e, curvature in [%.2e, %.2e].",
+             label, step, cost, arma::norm(gradient), eigval.min(), eigval.max());
+        if (certified) {
+            INFO("%s[Second order]   Certified as a local minimum (estimated distance %.2e).", label, distance);
+        } else if (positive) {
+            INFO("%s[Second order]   Not certified; estimated distance to the minimum is %.2e.", label, distance);
+        } else {
+            INFO("%s[Second order]   Not certified; the Hessian is not positive definite.", label);
+        }
+    }
+
+    return;
+}
+
 } // namespace
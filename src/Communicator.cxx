@@ -0,0 +1,410 @@
+#include "Wavenet/Communicator.h"
+
+// STL include(s).
+#include <chrono> /* std::chrono */
+#include <thread> /* std::this_thread */
+#include <cstring> /* memset, strncpy */
+#include <cerrno> /* errno */
+#include <algorithm> /* std::min, std::max */
+#include <cstdint> /* uint32_t */
+
+// POSIX include(s).
+#include <unistd.h> /* close, unlink */
+#include <poll.h> /* poll */
+#include <netdb.h> /* getaddrinfo */
+#include <sys/socket.h> /* socket, bind, listen, accept, connect */
+#include <sys/un.h> /* sockaddr_un */
+#include <netinet/in.h> /* IPPROTO_TCP */
+#include <netinet/tcp.h> /* TCP_NODELAY */
+
+namespace wavenet {
+
+namespace {
+
+    // Returns the current time, in seconds.
+    inline double now () {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Whether the address refers to a Unix domain socket.
+    inline bool isUnix (const std::string& address) { return address.compare(0, 5, "unix:") == 0; }
+
+    // Split TCP address "host:port" into host and port.
+    inline bool splitAddress (const std::string& address, std::string& host, std::string& port) {
+        const std::size_t pos = address.rfind(':');
+        if (pos == std::string::npos) { return false; }
+        host = address.substr(0, pos);
+        port = address.substr(pos + 1);
+        return true;
+    }
+
+    // Fill Unix domain socket address.
+    inline bool unixAddress (const std::string& path, sockaddr_un& addr) {
+        if (path.size() >= sizeof(addr.sun_path)) { return false; }
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        return true;
+    }
+
+    // First word of the handshake, identifying connections from other ranks.
+    const uint32_t handshakeMagic = 0x57564e54; // "WVNT"
+
+    // Receive exactly 'n' bytes from the socket, waiting at most until the
+    // deadline.
+    inline bool recvAll (const int& fd, char* data, const std::size_t& n, const double& deadline) {
+        std::size_t received = 0;
+        while (received < n) {
+            pollfd pfd = {fd, POLLIN, 0};
+            const int wait = std::max(int((deadline - now()) * 1000), 0);
+            if (poll(&pfd, 1, wait) <= 0) { return false; }
+            const ssize_t count = ::recv(fd, data + received, n - received, 0);
+            if (count <= 0) { return false; }
+            received += count;
+        }
+        return true;
+    }
+
+    // Reduce 'n' received values into 'values'.
+    inline void reduce (double* values, const double* received, const std::size_t& n,
+                        const Communicator::Reduction& reduction) {
+        for (std::size_t i = 0; i < n; i++) {
+            switch (reduction) {
+                case Communicator::Reduction::Sum: values[i] += received[i]; break;
+                case Communicator::Reduction::Min: values[i] = std::min(values[i], received[i]); break;
+                case Communicator::Reduction::Max: values[i] = std::max(values[i], received[i]); break;
+            }
+        }
+        return;
+    }
+
+} // namespace
+
+
+bool Communicator::init (const unsigned& rank, const std::vector<std::string>& addresses, const double& timeout) {
+
+    // Perform checks.
+    close();
+    if (addresses.empty() || rank >= addresses.size()) {
+        WARNING("Rank %d is not valid for %d address(es).", rank, addresses.size());
+        return false;
+    }
+
+    m_rank = rank;
+    m_size = addresses.size();
+
+    // A single rank needs no communication.
+    if (m_size == 1) {
+        m_initialised = true;
+        return true;
+    }
+
+    // Listen on own address, then connect to the next rank, and accept the
+    // connection from the previous rank. Since all ranks listen before
+    // connecting, the connections are queued until accepted.
+    const double deadline = now() + timeout;
+    m_listen = listen_(addresses[m_rank]);
+    if (m_listen < 0) { close(); return false; }
+
+    m_next = connect_(addresses[(m_rank + 1) % m_size], deadline);
+    if (m_next < 0) { close(); return false; }
+
+    // Identify to the next rank by own rank and ring size.
+    const uint32_t hello[3] = {handshakeMagic, m_rank, m_size};
+    if (::send(m_next, hello, sizeof(hello), MSG_NOSIGNAL) != (ssize_t) sizeof(hello)) {
+        ERROR("Rank %d could not send handshake to the next rank.", m_rank);
+        close();
+        return false;
+    }
+
+    // Accept connections until one identifies as the previous rank in a ring
+    // of the same size, rejecting any other, e.g. from a process started with
+    // a different list of addresses.
+    const uint32_t expected = (m_rank + m_size - 1) % m_size;
+    while (m_prev < 0) {
+        pollfd pfd = {m_listen, POLLIN, 0};
+        const int wait = std::max(int((deadline - now()) * 1000), 0);
+        int fd = -1;
+        if (poll(&pfd, 1, wait) <= 0 || (fd = ::accept(m_listen, nullptr, nullptr)) < 0) {
+            ERROR("Rank %d timed out waiting for the previous rank.", m_rank);
+            close();
+            return false;
+        }
+        uint32_t peer[3] = {0, 0, 0};
+        if (!recvAll(fd, (char*) peer, sizeof(peer), deadline) || peer[0] != handshakeMagic) {
+            WARNING("Rejected connection without valid handshake.");
+            ::close(fd);
+            continue;
+        }
+        if (peer[1] != expected || peer[2] != m_size) {
+            WARNING("Rejected connection from rank %d of %d; expected rank %d of %d.", peer[1], peer[2], expected, m_size);
+            ::close(fd);
+            continue;
+        }
+        m_prev = fd;
+    }
+
+    // Send small messages immediately.
+    if (!isUnix(addresses[m_rank])) {
+        const int flag = 1;
+        setsockopt(m_next, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        setsockopt(m_prev, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    }
+
+    // Make sure all ranks are connected.
+    m_initialised = true;
+    if (!barrier()) { close(); return false; }
+
+    INFO("Connected as rank %d of %d.", m_rank, m_size);
+    return true;
+}
+
+void Communicator::close () {
+    for (int* fd : {&m_listen, &m_next, &m_prev}) {
+        if (*fd >= 0) { ::close(*fd); *fd = -1; }
+    }
+    if (m_unixPath.size()) {
+        unlink(m_unixPath.c_str());
+        m_unixPath = "";
+    }
+    m_initialised = false;
+    return;
+}
+
+std::vector<std::string> Communicator::localhost (const unsigned& size, const unsigned& port) {
+    std::vector<std::string> addresses;
+    for (unsigned i = 0; i < size; i++) {
+        addresses.push_back("localhost:" + std::to_string(port + i));
+    }
+    return addresses;
+}
+
+bool Communicator::allReduce (arma::Col<double>& values, const Reduction& reduction) {
+
+    PROFILE("Communicator::allReduce");
+
+    // Perform checks.
+    if (!m_initialised) {
+        WARNING("Communicator is not initialised.");
+        return false;
+    }
+    if (m_size == 1) { return true; }
+
+    // Split the vector into one chunk per rank. Chunk c covers entries
+    // [offset(c), offset(c + 1)).
+    const std::size_t n = values.n_elem;
+    auto offset = [&] (const unsigned& c) { return (n * c) / m_size; };
+    auto chunk  = [&] (const long& c) { return unsigned(((c % m_size) + m_size) % m_size); };
+    double* data = values.memptr();
+    std::vector<double> buffer (n / m_size + 1);
+
+    // Reduce-scatter: at step s, send chunk (rank - s), and receive and reduce
+    // chunk (rank - s - 1), such that after m_size - 1 steps, each rank holds
+    // the fully reduced chunk (rank + 1).
+    for (unsigned s = 0; s + 1 < m_size; s++) {
+        const unsigned cs = chunk(long(m_rank) - s);
+        const unsigned cr = chunk(long(m_rank) - s - 1);
+        const std::size_t nSend = offset(cs + 1) - offset(cs);
+        const std::size_t nRecv = offset(cr + 1) - offset(cr);
+        if (!sendRecv_((const char*) (data + offset(cs)), nSend * sizeof(double),
+                       (char*) buffer.data(), nRecv * sizeof(double))) { return false; }
+        reduce(data + offset(cr), buffer.data(), nRecv, reduction);
+    }
+
+    // All-gather: at step s, send chunk (rank + 1 - s), and receive chunk
+    // (rank - s) in place.
+    for (unsigned s = 0; s + 1 < m_size; s++) {
+        const unsigned cs = chunk(long(m_rank) + 1 - s);
+        const unsigned cr = chunk(long(m_rank) - s);
+        const std::size_t nSend = offset(cs + 1) - offset(cs);
+        const std::size_t nRecv = offset(cr + 1) - offset(cr);
+        if (!sendRecv_((const char*) (data + offset(cs)), nSend * sizeof(double),
+                       (char*) (data + offset(cr)), nRecv * sizeof(double))) { return false; }
+    }
+
+    return true;
+}
+
+bool Communicator::broadcast (arma::Col<double>& values, const unsigned& root) {
+
+    PROFILE("Communicator::broadcast");
+
+    // Perform checks.
+    if (!m_initialised) {
+        WARNING("Communicator is not initialised.");
+        return false;
+    }
+    if (root >= m_size) {
+        WARNING("Root rank %d is not valid for %d rank(s).", root, m_size);
+        return false;
+    }
+    if (m_size == 1) { return true; }
+
+    // Pass the vector along the ring, from the root to the rank preceding it.
+    // The number of entries is sent first, such that the receiving ranks can
+    // resize accordingly.
+    const bool first = (m_rank == root);
+    const bool last  = ((m_rank + 1) % m_size == root);
+    unsigned long long n = values.n_elem;
+    if (!first) {
+        if (!sendRecv_(nullptr, 0, (char*) &n, sizeof(n))) { return false; }
+        values.set_size(n);
+        if (!sendRecv_(nullptr, 0, (char*) values.memptr(), n * sizeof(double))) { return false; }
+    }
+    if (!last) {
+        if (!sendRecv_((const char*) &n, sizeof(n), nullptr, 0)) { return false; }
+        if (!sendRecv_((const char*) values.memptr(), n * sizeof(double), nullptr, 0)) { return false; }
+    }
+
+    return true;
+}
+
+bool Communicator::barrier () {
+    arma::Col<double> token (1, arma::fill::zeros);
+    return allReduce(token);
+}
+
+int Communicator::listen_ (const std::string& address) {
+
+    int fd = -1;
+    if (isUnix(address)) {
+
+        // Unix domain socket, removing any stale socket file.
+        sockaddr_un addr;
+        const std::string path = address.substr(5);
+        if (!unixAddress(path, addr)) {
+            ERROR("Socket path '%s' is too long.", path.c_str());
+            return -1;
+        }
+        unlink(path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, (sockaddr*) &addr, sizeof(addr)) < 0) {
+            ERROR("Could not bind to '%s'.", address.c_str());
+            if (fd >= 0) { ::close(fd); }
+            return -1;
+        }
+        m_unixPath = path;
+
+    } else {
+
+        // TCP socket, on the interface of the configured host.
+        std::string host, port;
+        if (!splitAddress(address, host, port)) {
+            ERROR("Address '%s' is not of the form 'host:port'.", address.c_str());
+            return -1;
+        }
+        addrinfo hints, *result = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family   = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags    = AI_PASSIVE;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+            ERROR("Could not resolve '%s'.", address.c_str());
+            return -1;
+        }
+        for (addrinfo* info = result; info != nullptr; info = info->ai_next) {
+            fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+            if (fd < 0) { continue; }
+            const int flag = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+            if (bind(fd, info->ai_addr, info->ai_addrlen) == 0) { break; }
+            ::close(fd);
+            fd = -1;
+        }
+        freeaddrinfo(result);
+        if (fd < 0) {
+            ERROR("Could not bind to '%s'.", address.c_str());
+            return -1;
+        }
+    }
+
+    if (::listen(fd, 1) < 0) {
+        ERROR("Could not listen on '%s'.", address.c_str());
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int Communicator::connect_ (const std::string& address, const double& deadline) {
+
+    // Retry until the next rank is listening, or the deadline is reached.
+    do {
+        int fd = -1;
+        if (isUnix(address)) {
+            sockaddr_un addr;
+            if (!unixAddress(address.substr(5), addr)) {
+                ERROR("Socket path '%s' is too long.", address.c_str());
+                return -1;
+            }
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0 && ::connect(fd, (sockaddr*) &addr, sizeof(addr)) == 0) { return fd; }
+        } else {
+            std::string host, port;
+            if (!splitAddress(address, host, port)) {
+                ERROR("Address '%s' is not of the form 'host:port'.", address.c_str());
+                return -1;
+            }
+            addrinfo hints, *result = nullptr;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family   = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) == 0) {
+                fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+                const bool connected = (fd >= 0 && ::connect(fd, result->ai_addr, result->ai_addrlen) == 0);
+                freeaddrinfo(result);
+                if (connected) { return fd; }
+            }
+        }
+        if (fd >= 0) { ::close(fd); }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    } while (now() < deadline);
+
+    ERROR("Rank %d timed out connecting to '%s'.", m_rank, address.c_str());
+    return -1;
+}
+
+bool Communicator::sendRecv_ (const char* send, const std::size_t& nSend, char* recv, const std::size_t& nRecv) {
+
+    // Progress whichever direction is ready, until both are complete.
+    std::size_t sent = 0, received = 0;
+    while (sent < nSend || received < nRecv) {
+        pollfd pfds[2] = {{m_next, short(sent     < nSend ? POLLOUT : 0), 0},
+                          {m_prev, short(received < nRecv ? POLLIN  : 0), 0}};
+        if (poll(pfds, 2, -1) < 0) {
+            ERROR("Polling sockets failed.");
+            close();
+            return false;
+        }
+        if ((sent < nSend && pfds[0].revents & (POLLERR | POLLHUP)) || (received < nRecv && pfds[1].revents & POLLERR)) {
+            ERROR("Connection to neighbouring rank lost.");
+            close();
+            return false;
+        }
+        if (sent < nSend && pfds[0].revents & POLLOUT) {
+            // Don't block on partial sends, such that receiving may proceed.
+            const ssize_t n = ::send(m_next, send + sent, nSend - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { continue; }
+            if (n < 0) {
+                ERROR("Sending to rank %d failed.", (m_rank + 1) % m_size);
+                close();
+                return false;
+            }
+            sent += n;
+        }
+        if (received < nRecv && pfds[1].revents & (POLLIN | POLLHUP)) {
+            const ssize_t n = ::recv(m_prev, recv + received, nRecv - received, 0);
+            if (n <= 0) {
+                ERROR("Receiving from rank %d failed.", (m_rank + m_size - 1) % m_size);
+                close();
+                return false;
+            }
+            received += n;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
@@ -1,9 +1,14 @@
 #include "Wavenet/CostFunctions.h"
 
+// STL include(s).
+#include <algorithm> /* std::max */
+
 namespace wavenet {
 
 
 double SparseTerm (const arma::Col<double>& c) {
+
+    PROFILE("SparseTerm");
     
     /**
      * For wavelet coefficients {c} ordered by increasing absolute value
@@ -47,6 +52,8 @@ double SparseTerm (const arma::Mat<double>& C) {
 
 
 arma::Col<double> SparseTermDeriv (const arma::Col<double>& c) {
+
+    PROFILE("SparseTermDeriv");
    
      /**
      * For wavelet coefficients {c} ordered by increasing absolute value
@@ -117,6 +124,8 @@ arma::Mat<double> SparseTermDeriv (const arma::Mat<double>& C) {
 }
 
 double RegTerm (const arma::Col<double>& a, const bool& doWavelet) {
+
+    PROFILE("RegTerm");
     
     // Initialise number of filter coefficients.
     const int N = a.n_elem;
@@ -257,6 +266,8 @@ double RegTerm (const arma::Col<double>& a, const bool& doWavelet) {
 }
 
 arma::Col<double> RegTermDeriv (const arma::Col<double>& a, const bool& doWavelet) {
+
+    PROFILE("RegTermDeriv");
     
     /**
      * Taking the derivative of each term in the sum of squared deviations from 
@@ -414,4 +425,159 @@ arma::Col<double> RegTermDeriv (const arma::Col<double>& a, const bool& doWavele
     return gradient;
 }
 
+arma::Mat<double> RegTermHessian (const arma::Col<double>& a, const bool& doWavelet) {
+
+    PROFILE("RegTermHessian");
+
+    // Initialise number of filter coefficients.
+    const int N = a.n_elem;
+
+    // Initialise filter coefficient Hessian matrix.
+    arma::Mat<double> hessian (N, N, arma::fill::zeros);
+
+
+    /**
+     * (C2): Orthogonality of scaling functions
+     *
+     * Mathematical expression:
+     *   \nabla^{2} R_{2}(\{a\}) = \sum_{m} 2 \times (\nabla t_{m} \nabla t_{m}^{T}
+     *                             + (t_{m} - \delta_{m,0}) \nabla^{2} t_{m})
+     * with 
+     *   t_{m} = \sum_{k} a_{k} a_{k + 2m}
+     *   (\nabla t_{m})_{i} = a_{i + 2m} + a_{i - 2m}
+     *   (\nabla^{2} t_{m})_{ij} = \delta_{i,j + 2m} + \delta_{i,j - 2m}
+     */
+    // Loop over summation index m, with the same range as in RegTermDeriv.
+    for (const int& m : arma::linspace(-N/2, N/2, N + 1)) {
+
+        // Compute the term, less the kroenecker delta: \delta_{0,m}
+        double term = - (m == 0 ? 1. : 0);
+        for (int k = 0; k < N; k++) {
+            if (a.in_range(k + 2 * m)) {
+                term += a(k) * a(k + 2 * m);
+            }
+        }
+
+        // Compute the inner derivative vector.
+        arma::Col<double> inner_derivative (N, arma::fill::zeros);
+        for (int i = 0; i < N; i++) {
+            if (a.in_range(i + 2 * m)) { 
+                inner_derivative(i) += a(i + 2 * m);
+            }
+            if (a.in_range(i - 2 * m)) {
+                inner_derivative(i) += a(i - 2 * m);
+            }
+        }
+
+        // Add outer product of inner derivatives.
+        hessian += 2. * inner_derivative * inner_derivative.t();
+
+        // Add second derivatives of the term.
+        for (int j = 0; j < N; j++) {
+            if (a.in_range(j + 2 * m)) { hessian(j + 2 * m, j) += 2. * term; }
+            if (a.in_range(j - 2 * m)) { hessian(j - 2 * m, j) += 2. * term; }
+        }
+    }
+
+
+    // Wavelet-specific regularisation terms.
+    if (doWavelet) {
+
+        // Signs of the filter coefficients in the sum of the high-pass filter
+        // coefficients, used in (C4).
+        arma::Col<double> bsign (N, arma::fill::zeros);
+        for (int i = 0; i < N; i++) {
+            bsign(i) = pow(-1, N - i - 1);
+        }
+
+        /**
+         * (C3): Orthonormality of wavelet functions.
+         *
+         * Identical to (C2).
+         */
+        hessian *= 2.;
+
+        /**
+         * (C1): Dilation equation.
+         *
+         * Mathematical expression:
+         *   \nabla^{2} R_{1}(\{a\}) = 2 \times \mathbf{1} \mathbf{1}^{T}
+         */
+        hessian += 2. * arma::Mat<double> (N, N, arma::fill::ones);
+
+        /**
+         * (C4): High-pass filter.
+         *
+         * Mathematical expression:
+         *   (\nabla^{2} R_{4}(\{a\}))_{ij} = 2 \times (-1)^{N - i - 1} (-1)^{N - j - 1}
+         */
+        hessian += 2. * bsign * bsign.t();
+
+        /**
+         * (C5): Orthogonality of scaling and wavelet functions.
+         *
+         * Automatically satisfied, @see RegTermDeriv.
+         */
+    }
+
+    return hessian;
+}
+
+bool ProjectFilter (arma::Col<double>& a, const bool& doWavelet, const double& tolerance, const unsigned& maxIterations) {
+
+    PROFILE("ProjectFilter");
+
+    // Initialise number of filter coefficients and constraints.
+    const int N = a.n_elem;
+    const int M = N / 2 + (doWavelet ? 1 : 0);
+    if (N == 0) { return false; }
+    const unsigned numIterations = (maxIterations > 0 ? maxIterations : std::max(20u, 4u * N));
+
+    arma::Col<double> c (M);    // Constraint deviations.
+    arma::Mat<double> J (M, N); // Jacobian of the constraints.
+    for (unsigned iteration = 0; iteration <= numIterations; iteration++) {
+
+        // Compute the deviations from the constraints, and their Jacobian.
+        J.zeros();
+        for (int m = 0; m < N / 2; m++) {
+
+            // (C2): \sum_{k} a_{k} a_{k + 2m} = \delta_{0,m}, with derivative 
+            // a_{i + 2m} + a_{i - 2m} with respect to a_{i}.
+            double term = 0.;
+            for (int k = 0; k + 2*m < N; k++) {
+                term += a(k) * a(k + 2*m);
+            }
+            c(m) = term - (m == 0 ? 1. : 0.);
+            for (int i = 0; i < N; i++) {
+                if (i + 2*m < N)  { J(m, i) += a(i + 2*m); }
+                if (i - 2*m >= 0) { J(m, i) += a(i - 2*m); }
+            }
+        }
+
+        // (C4): \sum_{k} (-1)^{k} a_{k} = 0, with derivative (-1)^{i}.
+        if (doWavelet) {
+            c(M - 1) = 0.;
+            for (int i = 0; i < N; i++) {
+                c(M - 1)   += (i % 2 ? -1. : 1.) * a(i);
+                J(M - 1, i) = (i % 2 ? -1. : 1.);
+            }
+        }
+
+        // Check convergence. Given (C2) and (C4), the sum of the filter 
+        // coefficients is \pm\sqrt{2}; choose the positive sign (C1).
+        if (arma::abs(c).max() <= tolerance) {
+            if (doWavelet && arma::accu(a) < 0) { a *= -1.; }
+            return true;
+        }
+        if (iteration == numIterations) { break; }
+
+        // Take the minimum-norm Newton step.
+        arma::Col<double> lagrange;
+        if (!arma::solve(lagrange, J * J.t(), c)) { break; }
+        a -= J.t() * lagrange;
+    }
+
+    return false;
+}
+
 } // namespace
@@ -12,6 +12,16 @@ bool GeneratorBase::close () {
     return true; 
 }
 
+const arma::Cube<double>& GeneratorBase::nextChannels () {
+
+    // Yield the single-channel input as a cube with one slice.
+    const arma::Mat<double>& data = next();
+    m_channels.set_size(data.n_rows, data.n_cols, 1);
+    m_channels.slice(0) = data;
+
+    return m_channels;
+}
+
 bool GeneratorBase::setShape (const std::vector<unsigned>& shape) {
 
     // Initialiase variables.
@@ -70,7 +80,7 @@ bool GeneratorBase::resize_ () {
 
     // Check whether generator is properly initialised.
     if (!initialised()) {
-        WARNING("Cannot resize generator which isn't properly initialised.")
+        WARNING("Cannot resize generator which isn't properly initialised.");
         return false;
     }
 
@@ -97,4 +107,13 @@ bool GeneratorBase::check_ () {
     return true;
 }
 
+void GeneratorBase::seed_ () {
+    if (m_seed < 0) {
+        arma::arma_rng::set_seed_random();
+    } else {
+        arma::arma_rng::set_seed(m_seed);
+    }
+    return;
+}
+
 } // namespace
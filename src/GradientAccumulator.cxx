@@ -0,0 +1,84 @@
+#include "Wavenet/GradientAccumulator.h"
+
+namespace wavenet {
+
+bool GradientAccumulator::add (const arma::Col<double>& gradient) {
+
+    // Initialise on the first gradient.
+    if (m_count == 0) {
+        m_sum          = gradient;
+        m_compensation = arma::zeros< arma::Col<double> >(gradient.n_elem);
+        m_mean         = gradient;
+        m_m2           = arma::zeros< arma::Col<double> >(gradient.n_elem);
+        m_count        = 1;
+        return true;
+    }
+
+    if (gradient.n_elem != m_sum.n_elem) {
+        WARNING("Gradient size (%d) doesn't match that of the accumulator (%d).", gradient.n_elem, m_sum.n_elem);
+        return false;
+    }
+
+    m_count++;
+
+    // Compensated summation.
+    const arma::Col<double> y = gradient - m_compensation;
+    const arma::Col<double> t = m_sum + y;
+    m_compensation = (t - m_sum) - y;
+    m_sum          = t;
+
+    // Welford's update of the mean and sum of squared deviations.
+    const arma::Col<double> delta = gradient - m_mean;
+    m_mean += delta / double(m_count);
+    m_m2   += delta % (gradient - m_mean);
+
+    return true;
+}
+
+bool GradientAccumulator::set (const unsigned& count, const arma::Col<double>& sum, const arma::Col<double>& mean, const arma::Col<double>& m2) {
+
+    if (count == 0) {
+        clear();
+        return true;
+    }
+
+    if (mean.n_elem != sum.n_elem || m2.n_elem != sum.n_elem) {
+        WARNING("Sum, mean, and squared deviations must have the same size.");
+        return false;
+    }
+
+    m_count        = count;
+    m_sum          = sum;
+    m_compensation = arma::zeros< arma::Col<double> >(sum.n_elem);
+    m_mean         = mean;
+    m_m2           = m2;
+
+    return true;
+}
+
+void GradientAccumulator::clear () {
+    m_count = 0;
+    m_sum         .reset();
+    m_compensation.reset();
+    m_mean        .reset();
+    m_m2          .reset();
+    return;
+}
+
+arma::Col<double> GradientAccumulator::variance () const {
+    if (m_count < 2) { return arma::zeros< arma::Col<double> >(m_m2.n_elem); }
+    return m_m2 / double(m_count - 1);
+}
+
+arma::Col<double> GradientAccumulator::squares () const {
+    return m_m2 + double(m_count) * (m_mean % m_mean);
+}
+
+arma::Col<double> GradientAccumulator::deviations (const double& count, const arma::Col<double>& sum,
+                                                   const arma::Col<double>& squares) {
+    arma::Col<double> m2 = squares - (sum % sum) / count;
+    m2.elem(arma::find(m2 < 0.)).zeros();
+    return m2;
+}
+
+} // namespace
@@ -0,0 +1,151 @@
+#include "Wavenet/Lattice.h"
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <cmath> /* sin, cos, atan2, M_PI */
+
+namespace wavenet {
+
+namespace {
+
+    // Returns all N/2 lattice angles, given the N/2 - 1 free angles, such that
+    // the angles sum to \pi/4.
+    inline std::vector<double> allAngles (const arma::Col<double>& angles) {
+        std::vector<double> theta (angles.n_elem + 1);
+        double sum = 0;
+        for (unsigned j = 0; j < angles.n_elem; j++) {
+            theta[j] = angles(j);
+            sum     += angles(j);
+        }
+        theta.back() = M_PI / 4. - sum;
+        return theta;
+    }
+
+    // Apply the lattice rotations, storing the pair (h, g) after each
+    // rotation j, of length 2j + 2.
+    inline void rotate (const std::vector<double>& theta,
+                        std::vector< std::vector<double> >& h,
+                        std::vector< std::vector<double> >& g) {
+
+        const unsigned K = theta.size();
+        h.assign(K, std::vector<double>());
+        g.assign(K, std::vector<double>());
+
+        // First rotation.
+        h[0] = { cos(theta[0]), sin(theta[0]) };
+        g[0] = {-sin(theta[0]), cos(theta[0]) };
+
+        // Subsequent rotations, of h and g delayed by two entries.
+        for (unsigned j = 1; j < K; j++) {
+            const double c = cos(theta[j]), s = sin(theta[j]);
+            const unsigned L = 2 * j + 2;
+            h[j].assign(L, 0.);
+            g[j].assign(L, 0.);
+            for (unsigned i = 0; i < L; i++) {
+                const double u = (i + 2 < L ? h[j - 1][i]     : 0.); // h
+                const double v = (i >= 2    ? g[j - 1][i - 2] : 0.); // z^{-2} g
+                h[j][i] =  c * u + s * v;
+                g[j][i] = -s * u + c * v;
+            }
+        }
+
+        return;
+    }
+
+} // namespace
+
+
+arma::Col<double> LatticeFilter (const arma::Col<double>& angles) {
+
+    PROFILE("LatticeFilter");
+
+    // Apply the lattice rotations, and return the final h.
+    std::vector< std::vector<double> > h, g;
+    rotate(allAngles(angles), h, g);
+
+    return arma::Col<double>(h.back());
+}
+
+arma::Col<double> LatticeAngles (const arma::Col<double>& filter) {
+
+    PROFILE("LatticeAngles");
+
+    // Initialise number of filter coefficients and lattice angles.
+    const unsigned N = filter.n_elem;
+    const unsigned K = N / 2;
+
+    // Initialise the pair (h, g) from the filter coefficients, with the
+    // companion g_{k} = (-1)^{k + 1} h_{N - k - 1} of the lattice.
+    std::vector<double> h (N), g (N);
+    for (unsigned k = 0; k < N; k++) {
+        h[k] = filter(k);
+        g[k] = (k % 2 ? 1. : -1.) * filter(N - k - 1);
+    }
+
+    // Undo the rotations in reverse order. Each angle is chosen such that the
+    // last two entries of the un-rotated h vanish, as they do exactly for
+    // valid wavelets.
+    std::vector<double> theta (K, 0.);
+    for (unsigned j = K; j --> 1; ) {
+        const unsigned L = 2 * j + 2;
+        theta[j] = atan2(h[L - 1], g[L - 1]);
+        const double c = cos(theta[j]), s = sin(theta[j]);
+        std::vector<double> u (L - 2), v (L - 2);
+        for (unsigned i = 0; i < L - 2; i++) {
+            u[i] = c * h[i]     - s * g[i];
+            v[i] = s * h[i + 2] + c * g[i + 2];
+        }
+        h = std::move(u);
+        g = std::move(v);
+    }
+    theta[0] = atan2(h[1], h[0]);
+
+    // Return the free angles.
+    return arma::Col<double>(std::vector<double>(theta.begin(), theta.end() - 1));
+}
+
+arma::Col<double> LatticeGradient (const arma::Col<double>& angles, const arma::Col<double>& gradient) {
+
+    PROFILE("LatticeGradient");
+
+    // Apply the lattice rotations, storing the intermediate pairs (h, g).
+    const std::vector<double> theta = allAngles(angles);
+    const unsigned K = theta.size();
+    std::vector< std::vector<double> > h, g;
+    rotate(theta, h, g);
+
+    // Backpropagate the gradients on (h, g) through the rotations in reverse
+    // order. Since dh'/d\theta_{j} = g' and dg'/d\theta_{j} = -h', the
+    // gradient on each angle is <dh', g'> - <dg', h'>.
+    std::vector<double> dh (gradient.memptr(), gradient.memptr() + gradient.n_elem);
+    std::vector<double> dg (dh.size(), 0.);
+    std::vector<double> dtheta (K, 0.);
+    for (unsigned j = K; j --> 0; ) {
+        const unsigned L = 2 * j + 2;
+        for (unsigned i = 0; i < L; i++) {
+            dtheta[j] += dh[i] * g[j][i] - dg[i] * h[j][i];
+        }
+        if (j == 0) { break; }
+
+        // Transpose of the rotation, onto h and the delayed g.
+        const double c = cos(theta[j]), s = sin(theta[j]);
+        std::vector<double> du (L - 2), dv (L - 2);
+        for (unsigned i = 0; i < L - 2; i++) {
+            du[i] = c * dh[i]     - s * dg[i];
+            dv[i] = s * dh[i + 2] + c * dg[i + 2];
+        }
+        dh = std::move(du);
+        dg = std::move(dv);
+    }
+
+    // Since the last angle is \pi/4 minus the sum of the free angles, the
+    // gradient on each free angle receives minus that on the last angle.
+    arma::Col<double> result (K - 1);
+    for (unsigned j = 0; j + 1 < K; j++) {
+        result(j) = dtheta[j] - dtheta[K - 1];
+    }
+
+    return result;
+}
+
+} // namespace
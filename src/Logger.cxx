@@ -1,41 +1,309 @@
 #include "Wavenet/Logger.h"
 
+// STL include(s).
+#include <cstring> /* strcmp */
+#include <thread> /* std::thread */
+#include <mutex> /* std::mutex, std::lock_guard, std::unique_lock */
+#include <condition_variable> /* std::condition_variable */
+#include <deque> /* std::deque */
+#include <unordered_map> /* std::unordered_map */
+#include <typeindex> /* std::type_index */
+#include <utility> /* std::move */
+#include <algorithm> /* std::min */
+#include <cstdlib> /* atexit */
+
+// POSIX include(s).
+#include <pthread.h> /* pthread_atfork */
+
 namespace wavenet {
-    
-void Logger::fctprint_ (std::string fun, std::string level, std::string format, ...) {
-    
+
+namespace {
+
+/**
+ * Background writer, owning the single thread which performs the actual output
+ * of the formatted log statements.
+ *
+ * Records are queued by the logging threads and written in batches, with a
+ * single flush of stdout per batch. When stopped, the writer drains the queue
+ * before the thread exits, such that no statements are lost.
+ */
+class LogWriter {
+
+public:
+
+    /// Constructor(s).
+    LogWriter () :
+        m_thread(&LogWriter::run_, this)
+    {};
+
+
+    /// Destructor.
+    ~LogWriter () {
+        stop();
+    };
+
+
+    /// Queue a formatted record for writing. Returns the number of records
+    /// which must be written before this one has been.
+    unsigned long long push (std::string&& record) {
+        unsigned long long target = 0;
+        {
+            std::lock_guard<std::mutex> lock (m_mutex);
+            m_queue.push_back(std::move(record));
+            target = ++m_pushed;
+        }
+        m_wake.notify_one();
+        return target;
+    }
+
+    /// Block until all queued records have been written.
+    void flush () {
+        unsigned long long target = 0;
+        {
+            std::lock_guard<std::mutex> lock (m_mutex);
+            target = m_pushed;
+        }
+        wait(target);
+        return;
+    }
+
+    /// Block until at least 'target' records have been written.
+    void wait (const unsigned long long& target) {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        m_done.wait(lock, [this, target] { return m_written >= target; });
+        return;
+    }
+
+    /// Write all queued records, and join the writer thread.
+    void stop () {
+        {
+            std::lock_guard<std::mutex> lock (m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) { m_thread.join(); }
+        return;
+    }
+
+    /// Lock and unlock the queue around fork(), such that the queue is not
+    /// copied into the child process in an inconsistent state.
+    void lock   () { m_mutex.lock(); }
+    void unlock () { m_mutex.unlock(); }
+
+
+private:
+
+    /// Internal method(s).
+    // Main loop of the writer thread.
+    void run_ () {
+        std::deque<std::string> batch;
+        std::unique_lock<std::mutex> lock (m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) { break; } // Only reached when stopping.
+
+            // Take ownership of all pending records, and write them without
+            // holding the lock.
+            batch.swap(m_queue);
+            lock.unlock();
+            for (const std::string& record : batch) {
+                fwrite(record.data(), 1, record.size(), stdout);
+            }
+            fflush(stdout);
+            const unsigned long long nWritten = batch.size();
+            batch.clear();
+            lock.lock();
+
+            m_written += nWritten;
+            m_done.notify_all();
+        }
+        return;
+    }
+
+
+private:
+
+    /// Data member(s).
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::deque<std::string> m_queue;
+    unsigned long long m_pushed  = 0;
+    unsigned long long m_written = 0;
+    bool m_stop = false;
+
+    // Declared last, such that the thread is started only once all other
+    // members have been initialised.
+    std::thread m_thread;
+
+};
+
+/**
+ * Process-wide logging state.
+ *
+ * The writer is created on first use, and is never destroyed, such that no
+ * thread is joined during static destruction. Instead, Logger::shutdown stops
+ * the writer explicitly (and is registered to run at exit), after which all
+ * statements are written synchronously by the calling thread.
+ *
+ * Since only the forking thread survives fork(), the child process cannot use
+ * the parent's writer. The fork handlers therefore hold the locks across the
+ * fork, and let the child abandon the parent's writer, such that a new one is
+ * created on first use in the child. Statements still pending at the time of
+ * the fork are written by the parent only.
+ */
+struct LogState {
+    std::mutex mutex; // Guards 'writer' and 'stopped', and synchronous writes.
+    LogWriter* writer = nullptr;
+    bool stopped = false;
+};
+
+LogState& state_ ();
+
+void prepareFork_ () {
+    LogState& state = state_();
+    state.mutex.lock();
+    if (state.writer) { state.writer->lock(); }
+    return;
+}
+
+void parentFork_ () {
+    LogState& state = state_();
+    if (state.writer) { state.writer->unlock(); }
+    state.mutex.unlock();
+    return;
+}
+
+void childFork_ () {
+    LogState& state = state_();
+    // The writer thread doesn't exist in the child, so the writer can neither
+    // be used nor destroyed. It is deliberately leaked.
+    state.writer = nullptr;
+    state.mutex.unlock();
+    return;
+}
+
+void exit_ () {
+    Logger::shutdown();
+    return;
+}
+
+LogState& state_ () {
+    static LogState* state = [] {
+        LogState* s = new LogState();
+        pthread_atfork(prepareFork_, parentFork_, childFork_);
+        atexit(exit_);
+        return s;
+    }();
+    return *state;
+}
+
+// Hand the record to the background writer, or write it synchronously if the
+// writer has been shut down. If 'wait', block until the record is written.
+void write_ (std::string&& record, const bool& wait) {
+    LogState& state = state_();
+    std::unique_lock<std::mutex> lock (state.mutex);
+    if (state.stopped) {
+        fwrite(record.data(), 1, record.size(), stdout);
+        fflush(stdout);
+        return;
+    }
+    if (!state.writer) { state.writer = new LogWriter(); }
+    LogWriter* writer = state.writer;
+    const unsigned long long target = writer->push(std::move(record));
+    lock.unlock();
+
+    // A stopped writer has written all records before its thread exits, so
+    // waiting is safe even if the writer is shut down in the meantime.
+    if (wait) { writer->wait(target); }
+    return;
+}
+
+// Demangled name of the class with type 'info'. The result is cached per
+// thread, so no locking is needed and each class is demangled once per thread.
+const std::string& className_ (const std::type_info& info) {
+    thread_local std::unordered_map<std::type_index, std::string> cache;
+    auto it = cache.find(std::type_index(info));
+    if (it == cache.end()) {
+        it = cache.emplace(std::type_index(info), demangle(info.name())).first;
+    }
+    return it->second;
+}
+
+// Format the print statement into a thread-local buffer, and hand it to the
+// background writer. 'ERROR' statements wait until they have been written.
+void dispatch_ (const char* scope, const char* level, const char* format, va_list args) {
+
     // Determine print level colour.
-    std::string col = "\033[1m";
-    if      (level == "ERROR")   { col = "\033[1;31m"; }
-    else if (level == "WARNING") { col = "\033[1;31m"; }
-    else if (level == "INFO")    { col = "\033[1;34m"; }
+    const char* col = "\033[1m";
+    if      (strcmp(level, "ERROR")   == 0) { col = "\033[1;31m"; }
+    else if (strcmp(level, "WARNING") == 0) { col = "\033[1;31m"; }
+    else if (strcmp(level, "INFO")    == 0) { col = "\033[1;34m"; }
 
     // Format print statement.
-    std::cout << "\033[1m" << std::left << std::setw(34) << ("<" + fun + "> ") << col << std::setw(7) << level << "\033[0m ";
+    const int size = 2048;
+    thread_local char buffer [size];
+    int n = snprintf(buffer, size, "\033[1m%-34s%s%-7s\033[0m ", scope, col, level);
+    if (n < 0 || n >= size - 1) { n = 0; }
+    int m = vsnprintf(buffer + n, size - n - 1, format, args);
+    if (m < 0) { m = 0; }
+    n = std::min(n + m, size - 2);
+    buffer[n++] = '\n';
+
+    write_(std::string(buffer, n), strcmp(level, "ERROR") == 0);
+
+    return;
+}
+
+} // namespace
+
+std::atomic<int> Logger::s_globalLevel (WAVENET_LEVEL_VERBOSE);
+
+void Logger::fctprint_ (const char* fun, const char* level, const char* format, ...) {
+
+    // Format the calling scope.
+    thread_local char scope [256];
+    snprintf(scope, sizeof(scope), "<%s> ", fun);
+
     va_list args;
     va_start (args, format);
-    vprintf (format.c_str(), args);
+    dispatch_(scope, level, format, args);
     va_end (args);
-    std::cout << std::endl;
 
     return;
 }
 
-void Logger::print_ (std::string cls, std::string fun, std::string level, std::string format, ...) const {
-    
-    // Determine print level colour.
-    std::string col = "\033[1m";
-    if      (level == "ERROR")   { col = "\033[1;31m"; }
-    else if (level == "WARNING") { col = "\033[1;31m"; }
-    else if (level == "INFO")    { col = "\033[1;34m"; }
+void Logger::flush () {
+    LogState& state = state_();
+    std::unique_lock<std::mutex> lock (state.mutex);
+    LogWriter* writer = state.stopped ? nullptr : state.writer;
+    lock.unlock();
+    if (writer) { writer->flush(); }
+    fflush(stdout);
+    return;
+}
+
+void Logger::shutdown () {
+    // The lock is held while stopping the writer, such that statements which
+    // are written synchronously are never printed before the pending ones.
+    LogState& state = state_();
+    std::lock_guard<std::mutex> lock (state.mutex);
+    if (state.stopped) { return; }
+    state.stopped = true;
+    if (state.writer) { state.writer->stop(); }
+    return;
+}
+
+void Logger::print_ (const std::type_info& cls, const char* fun, const char* level, const char* format, ...) const {
+
+    // Format the calling scope, using the cached class name.
+    thread_local char scope [256];
+    snprintf(scope, sizeof(scope), "<%s::%s> ", className_(cls).c_str(), fun);
 
-    // Format print statement.
-    std::cout << "\033[1m" << std::left << std::setw(34) << ("<" + cls + "::" + fun + "> ") << col << std::setw(7) << level << "\033[0m ";
     va_list args;
     va_start (args, format);
-    vprintf (format.c_str(), args);
+    dispatch_(scope, level, format, args);
     va_end (args);
-    std::cout << std::endl;
 
     return;
 }
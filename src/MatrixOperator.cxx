@@ -1,7 +1,44 @@
 #include "Wavenet/MatrixOperator.h"
 
+// STL include(s).
+#include <vector> /* std::vector */
+#include <chrono> /* std::chrono::steady_clock */
+#include <fstream> /* std::ifstream, std::ofstream */
+#include <sstream> /* std::stringstream */
+
 namespace wavenet {
     
+// Static data member(s).
+std::atomic<bool> MatrixOperator::s_autotune (true);
+std::map< std::pair<unsigned, unsigned>, MatrixOperator::Strategy > MatrixOperator::s_plans;
+std::mutex MatrixOperator::s_mutex;
+std::string MatrixOperator::s_tuningFile = "";
+
+
+namespace {
+
+/**
+ * Concrete operator with generic filter coefficients, used for timing the 
+ * construction strategies.
+ */
+class ProbeOperator : public MatrixOperator {
+public:
+    ProbeOperator (const unsigned& N, const unsigned& size) {
+        setSize(size);
+        // Use deterministic coefficients, so as to not affect the state of the
+        // random number generator.
+        setFilter(arma::linspace< arma::Col<double> >(1, N, N));
+    }
+    virtual void setFilter (const arma::Col<double>& filter) {
+        m_filter = filter;
+        if (size()) { setComplete(); }
+        return;
+    }
+    inline void constructUsing (const Strategy& strategy) { construct_(strategy); return; }
+};
+
+} // namespace
+
 void MatrixOperator::construct () {
 
     // Check whether the matrix operator is properly configured.
@@ -11,20 +48,173 @@ void MatrixOperator::construct () {
     }
 
     // Choose the most efficient (but equivalent) way to construct the matrix 
-    // operator, given the size and filter configuration. The numbers are found 
-    // empirically, but generally: if we have a large operator and few filter 
-    // coefficients, construct by filter indices; if we have a small operatator 
-    // and many indices, construct by matrix rows.
+    // operator, given the size and filter configuration.
     const unsigned N = m_filter.n_elem;
-    if ((N ==  2 && m_size >= 2) ||
-        (N <=  6 && m_size >= 3) ||
-        (N <= 20 && m_size >= 4) ||
-        (           m_size >= 5)) {
-        constructByIndices_();
-    } else {
-        constructByRows_();
+    construct_(autotune() ? plan(N, m_size) : heuristic_(N, m_size));
+
+    return;
+}
+
+MatrixOperator::Strategy MatrixOperator::plan (const unsigned& N, const unsigned& size) {
+
+    // Look up existing plan.
+    {
+        std::lock_guard<std::mutex> lock (s_mutex);
+        auto it = s_plans.find(std::make_pair(N, size));
+        if (it != s_plans.end()) { return it->second; }
     }
 
+    // Otherwise, find the plan by timing the available strategies.
+    return tune(N, size);
+}
+
+MatrixOperator::Strategy MatrixOperator::tune (const unsigned& N, const unsigned& size) {
+
+    // Initialise variables. The number of repetitions is reduced for large 
+    // operators, for which the timing is less noisy and more costly.
+    const std::vector<Strategy> strategies = {Strategy::Rows, Strategy::Indices, Strategy::Direct};
+    const unsigned reps = (size < 8 ? 5 : (size < 11 ? 3 : 1));
+    ProbeOperator probe (N, size);
+
+    // Time each strategy, using the fastest of a few repetitions.
+    Strategy best = heuristic_(N, size);
+    double bestTime = -1;
+    for (const Strategy& strategy : strategies) {
+        probe.constructUsing(strategy); // Warm-up.
+        double time = -1;
+        for (unsigned rep = 0; rep < reps; rep++) {
+            const auto start = std::chrono::steady_clock::now();
+            probe.constructUsing(strategy);
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (time < 0 || elapsed < time) { time = elapsed; }
+        }
+        if (bestTime < 0 || time < bestTime) {
+            bestTime = time;
+            best = strategy;
+        }
+    }
+
+    // Store the plan, and persist it if requested.
+    std::string tuningFile;
+    {
+        std::lock_guard<std::mutex> lock (s_mutex);
+        s_plans[std::make_pair(N, size)] = best;
+        tuningFile = s_tuningFile;
+    }
+    if (!tuningFile.empty()) { saveTuning(tuningFile); }
+
+    return best;
+}
+
+std::map< std::pair<unsigned, unsigned>, MatrixOperator::Strategy > MatrixOperator::plans () {
+    std::lock_guard<std::mutex> lock (s_mutex);
+    return s_plans;
+}
+
+void MatrixOperator::clearPlans () {
+    std::lock_guard<std::mutex> lock (s_mutex);
+    s_plans.clear();
+    return;
+}
+
+void MatrixOperator::printPlans () {
+    const std::map< std::pair<unsigned, unsigned>, Strategy > current = plans();
+    FCTINFO("Operator construction plans (%lu):", current.size());
+    for (const auto& entry : current) {
+        FCTINFO("  N = %2u, size = %2u: %s", entry.first.first, entry.first.second, strategyName(entry.second).c_str());
+    }
+    return;
+}
+
+bool MatrixOperator::loadTuning (const std::string& filename) {
+
+    std::ifstream stream (filename);
+    if (!stream.good()) {
+        FCTWARNING("Could not open tuning file '%s'.", filename.c_str());
+        return false;
+    }
+
+    // Read plans, one per line, skipping comments.
+    std::map< std::pair<unsigned, unsigned>, Strategy > loaded;
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') { continue; }
+        std::stringstream ss (line);
+        unsigned N, size;
+        std::string name;
+        if (!(ss >> N >> size >> name)) {
+            FCTWARNING("Could not parse line '%s' in tuning file '%s'.", line.c_str(), filename.c_str());
+            return false;
+        }
+        if      (name == strategyName(Strategy::Rows))    { loaded[std::make_pair(N, size)] = Strategy::Rows; }
+        else if (name == strategyName(Strategy::Indices)) { loaded[std::make_pair(N, size)] = Strategy::Indices; }
+        else if (name == strategyName(Strategy::Direct))  { loaded[std::make_pair(N, size)] = Strategy::Direct; }
+        else {
+            FCTWARNING("Strategy '%s' in tuning file '%s' not recognised.", name.c_str(), filename.c_str());
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock (s_mutex);
+    for (const auto& entry : loaded) { s_plans[entry.first] = entry.second; }
+
+    return true;
+}
+
+bool MatrixOperator::saveTuning (const std::string& filename) {
+
+    const std::map< std::pair<unsigned, unsigned>, Strategy > current = plans();
+    std::ofstream stream (filename);
+    if (!stream.good()) {
+        FCTWARNING("Could not open tuning file '%s' for writing.", filename.c_str());
+        return false;
+    }
+
+    stream << "# N size strategy\n";
+    for (const auto& entry : current) {
+        stream << entry.first.first << " " << entry.first.second << " " << strategyName(entry.second) << "\n";
+    }
+
+    return true;
+}
+
+void MatrixOperator::setTuningFile (const std::string& filename) {
+    if (fileExists(filename)) { loadTuning(filename); }
+    std::lock_guard<std::mutex> lock (s_mutex);
+    s_tuningFile = filename;
+    return;
+}
+
+std::string MatrixOperator::strategyName (const Strategy& strategy) {
+    switch (strategy) {
+        case Strategy::Rows:    return "rows";
+        case Strategy::Indices: return "indices";
+        case Strategy::Direct:  return "direct";
+    }
+    return "";
+}
+
+MatrixOperator::Strategy MatrixOperator::heuristic_ (const unsigned& N, const unsigned& size) {
+
+    // The numbers are found empirically, but generally: if we have a large 
+    // operator and few filter coefficients, construct by filter indices; if we
+    // have a small operatator and many indices, construct by matrix rows.
+    if ((N ==  2 && size >= 2) ||
+        (N <=  6 && size >= 3) ||
+        (N <= 20 && size >= 4) ||
+        (           size >= 5)) {
+        return Strategy::Indices;
+    }
+    return Strategy::Rows;
+}
+
+void MatrixOperator::construct_ (const Strategy& strategy) {
+    switch (strategy) {
+        case Strategy::Rows:    constructByRows_();    break;
+        case Strategy::Indices: constructByIndices_(); break;
+        case Strategy::Direct:  constructDirect_();    break;
+    }
+    m_strategy = strategy;
     return;
 }
 
@@ -112,6 +302,30 @@ void MatrixOperator::constructByIndices_ () {
     return;
 }
 
+void MatrixOperator::constructDirect_ () {
+
+    // Initialise variables.
+    const unsigned nRows = (unsigned) pow(2, m_size);
+    const unsigned nCols = (unsigned) pow(2, m_size + 1);
+    const unsigned N = m_filter.n_elem;
+
+    // Initialise the matrix operator to all zeros.
+    this->zeros(nRows, nCols);
+
+    // The i'th filter coefficient in row r is located in column 
+    // (N/2 + 2r - i) mod nCols. Since nCols is a power of two, the modulo can 
+    // be taken by masking, also for negative (wrapped-around) column indices.
+    const unsigned mask = nCols - 1;
+    for (unsigned irow = 0; irow < nRows; irow++) {
+        const unsigned offset = N / 2 + 2 * irow;
+        for (unsigned i = 0; i < N; i++) {
+            this->at(irow, (offset - i) & mask) += m_filter(i);
+        }
+    }
+
+    return;
+}
+
 void rowshift (arma::Row<double>& row, const int& shift) {
     
     // Initialise length of row vector.
@@ -0,0 +1,151 @@
+#include "Wavenet/Metrics.h"
+
+// STL include(s).
+#include <fstream> /* std::ofstream, std::ifstream */
+#include <algorithm> /* std::min, std::max */
+
+namespace wavenet {
+
+Metrics& Metrics::operator= (const Metrics& other) {
+    m_start = other.m_start;
+    m_examples           .store(other.examples());
+    m_updates            .store(other.updates());
+    m_generatorWaitNs    .store(other.generatorWaitNs());
+    m_cacheHits          .store(other.cacheHits());
+    m_cacheRebuilds      .store(other.cacheRebuilds());
+    m_snapshotWrites     .store(other.snapshotWrites());
+    m_snapshotWriteNs    .store(other.snapshotWriteNs());
+    m_activationBytes    .store(other.activationBytes());
+    m_peakActivationBytes.store(other.peakActivationBytes());
+    m_rollbacks          .store(other.rollbacks());
+    m_discardedExamples  .store(other.discardedExamples());
+    return *this;
+}
+
+void Metrics::setActivationBytes (const unsigned long long& bytes) {
+    m_activationBytes.store(bytes, std::memory_order_relaxed);
+
+    // Raise the peak value, unless another thread has raised it further.
+    unsigned long long peak = m_peakActivationBytes.load(std::memory_order_relaxed);
+    while (bytes > peak && !m_peakActivationBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+    return;
+}
+
+void Metrics::reset () {
+    *this = Metrics();
+    return;
+}
+
+void Metrics::merge (const Metrics& other) {
+    m_start = std::min(m_start, other.m_start);
+    m_examples           .fetch_add(other.examples(),            std::memory_order_relaxed);
+    m_updates            .fetch_add(other.updates(),             std::memory_order_relaxed);
+    m_generatorWaitNs    .store(std::max(generatorWaitNs(), other.generatorWaitNs()), std::memory_order_relaxed);
+    m_cacheHits          .fetch_add(other.cacheHits(),           std::memory_order_relaxed);
+    m_cacheRebuilds      .fetch_add(other.cacheRebuilds(),       std::memory_order_relaxed);
+    m_snapshotWrites     .fetch_add(other.snapshotWrites(),      std::memory_order_relaxed);
+    m_snapshotWriteNs    .fetch_add(other.snapshotWriteNs(),     std::memory_order_relaxed);
+    m_activationBytes    .fetch_add(other.activationBytes(),     std::memory_order_relaxed);
+    m_peakActivationBytes.fetch_add(other.peakActivationBytes(), std::memory_order_relaxed);
+    m_rollbacks          .fetch_add(other.rollbacks(),           std::memory_order_relaxed);
+    m_discardedExamples  .fetch_add(other.discardedExamples(),   std::memory_order_relaxed);
+    return;
+}
+
+double Metrics::elapsed () const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+double Metrics::examplesPerSecond () const {
+    const double t = elapsed();
+    return t > 0 ? examples() / t : 0.;
+}
+
+double Metrics::updatesPerSecond () const {
+    const double t = elapsed();
+    return t > 0 ? updates() / t : 0.;
+}
+
+double Metrics::meanSnapshotWriteMs () const {
+    const unsigned long long n = snapshotWrites();
+    return n > 0 ? snapshotWriteNs() * 1.0e-6 / double(n) : 0.;
+}
+
+void Metrics::print () const {
+    INFO("  elapsed               : %.2f s",   elapsed());
+    INFO("  examples              : %llu (%.1f/s)", examples(), examplesPerSecond());
+    INFO("  updates               : %llu (%.1f/s)", updates(),  updatesPerSecond());
+    INFO("  generator wait        : %.2f s",   generatorWaitNs() * 1.0e-9);
+    INFO("  peak activation memory: %.2f MB",  peakActivationBytes() / 1048576.);
+    INFO("  operator cache        : %llu hits, %llu rebuilds", cacheHits(), cacheRebuilds());
+    INFO("  snapshot writes       : %llu (mean %.2f ms)", snapshotWrites(), meanSnapshotWriteMs());
+    INFO("  roll-backs            : %llu (%llu examples discarded)", rollbacks(), discardedExamples());
+    return;
+}
+
+bool Metrics::writeCSV (const std::string& filename) const {
+
+    // Check whether a header line needs to be written.
+    const bool header = !std::ifstream(filename).good();
+
+    std::ofstream stream (filename, std::ios::app);
+    if (!stream.good()) {
+        WARNING("Could not open file '%s' for writing.", filename.c_str());
+        return false;
+    }
+
+    if (header) {
+        stream << "elapsed_s,examples,updates,examples_per_s,updates_per_s,generator_wait_s,"
+               << "activation_bytes,peak_activation_bytes,cache_hits,cache_rebuilds,"
+               << "snapshot_writes,mean_snapshot_write_ms,rollbacks,discarded_examples\n";
+    }
+
+    stream << elapsed()                 << ","
+           << examples()                << ","
+           << updates()                 << ","
+           << examplesPerSecond()       << ","
+           << updatesPerSecond()        << ","
+           << generatorWaitNs() * 1.0e-9 << ","
+           << activationBytes()         << ","
+           << peakActivationBytes()     << ","
+           << cacheHits()               << ","
+           << cacheRebuilds()           << ","
+           << snapshotWrites()          << ","
+           << meanSnapshotWriteMs()     << ","
+           << rollbacks()               << ","
+           << discardedExamples()       << "\n";
+    stream.close();
+
+    return true;
+}
+
+bool Metrics::writeJSON (const std::string& filename) const {
+
+    std::ofstream stream (filename);
+    if (!stream.good()) {
+        WARNING("Could not open file '%s' for writing.", filename.c_str());
+        return false;
+    }
+
+    stream << "{\n"
+           << "  \"elapsed_s\": "              << elapsed()                  << ",\n"
+           << "  \"examples\": "               << examples()                 << ",\n"
+           << "  \"updates\": "                << updates()                  << ",\n"
+           << "  \"examples_per_s\": "         << examplesPerSecond()        << ",\n"
+           << "  \"updates_per_s\": "          << updatesPerSecond()         << ",\n"
+           << "  \"generator_wait_s\": "       << generatorWaitNs() * 1.0e-9 << ",\n"
+           << "  \"activation_bytes\": "       << activationBytes()          << ",\n"
+           << "  \"peak_activation_bytes\": "  << peakActivationBytes()      << ",\n"
+           << "  \"cache_hits\": "             << cacheHits()                << ",\n"
+           << "  \"cache_rebuilds\": "         << cacheRebuilds()            << ",\n"
+           << "  \"snapshot_writes\": "        << snapshotWrites()           << ",\n"
+           << "  \"mean_snapshot_write_ms\": " << meanSnapshotWriteMs()      << ",\n"
+           << "  \"rollbacks\": "              << rollbacks()                << ",\n"
+           << "  \"discarded_examples\": "     << discardedExamples()        << "\n"
+           << "}\n";
+    stream.close();
+
+    return true;
+}
+
+} // namespace
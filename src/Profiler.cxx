@@ -0,0 +1,178 @@
+#include "Wavenet/Profiler.h"
+
+// STL include(s).
+#include <fstream> /* std::ofstream */
+#include <algorithm> /* std::sort, std::min, std::max */
+#include <map> /* std::map */
+#include <iomanip> /* std::fixed, std::setprecision */
+
+namespace wavenet {
+
+std::atomic<bool> Profiler::s_enabled (false);
+std::atomic<bool> Profiler::s_tracing (false);
+
+Profiler& Profiler::instance () {
+    static Profiler profiler;
+    return profiler;
+}
+
+unsigned long long Profiler::now () const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+Profiler::ThreadData& Profiler::threadData_ () {
+
+    // Each thread looks up its counters once, and caches the pointer.
+    thread_local ThreadData* data = nullptr;
+    if (!data) {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_threads.emplace_back(new ThreadData());
+        data = m_threads.back().get();
+        data->id = m_threads.size() - 1;
+    }
+    return *data;
+}
+
+void Profiler::record (const char* name, const unsigned long long& startNs, const unsigned long long& durationNs) {
+
+    ThreadData& data = threadData_();
+
+    // The lock is only ever contended while the counters are being read.
+    std::lock_guard<std::mutex> lock (data.mutex);
+
+    // Update counters.
+    Counter& counter = data.counters[name];
+    counter.calls   += 1;
+    counter.totalNs += durationNs;
+    counter.minNs    = std::min(counter.minNs, durationNs);
+    counter.maxNs    = std::max(counter.maxNs, durationNs);
+
+    // Store event, if requested.
+    if (tracing()) {
+        data.events.push_back({name, startNs, durationNs});
+    }
+
+    return;
+}
+
+void Profiler::reset () {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    for (auto& data : m_threads) {
+        std::lock_guard<std::mutex> threadLock (data->mutex);
+        data->counters.clear();
+        data->events.clear();
+    }
+    return;
+}
+
+std::vector< std::pair<std::string, Profiler::Counter> > Profiler::merged () {
+
+    // Merge by name, since identical string literals in different translation
+    // units need not share an address.
+    std::map<std::string, Counter> counters;
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        for (auto& data : m_threads) {
+            std::lock_guard<std::mutex> threadLock (data->mutex);
+            for (const auto& entry : data->counters) {
+                Counter& counter = counters[entry.first];
+                counter.calls   += entry.second.calls;
+                counter.totalNs += entry.second.totalNs;
+                counter.minNs    = std::min(counter.minNs, entry.second.minNs);
+                counter.maxNs    = std::max(counter.maxNs, entry.second.maxNs);
+            }
+        }
+    }
+
+    // Order by decreasing total time.
+    std::vector< std::pair<std::string, Counter> > output (counters.begin(), counters.end());
+    std::sort(output.begin(), output.end(), [](const std::pair<std::string, Counter>& a, const std::pair<std::string, Counter>& b) {
+        return a.second.totalNs > b.second.totalNs;
+    });
+
+    return output;
+}
+
+void Profiler::summary () {
+
+    std::vector< std::pair<std::string, Counter> > counters = merged();
+    if (counters.empty()) {
+        INFO("No timings recorded.");
+        return;
+    }
+
+    INFO("%-32s %10s %12s %12s %12s %12s", "Scope", "Calls", "Total [ms]", "Mean [us]", "Min [us]", "Max [us]");
+    for (const auto& entry : counters) {
+        const Counter& c = entry.second;
+        INFO("%-32s %10llu %12.2f %12.2f %12.2f %12.2f",
+             entry.first.c_str(),
+             c.calls,
+             c.totalNs * 1.0e-6,
+             c.totalNs * 1.0e-3 / double(c.calls),
+             c.minNs   * 1.0e-3,
+             c.maxNs   * 1.0e-3);
+    }
+
+    return;
+}
+
+bool Profiler::exportJSON (const std::string& filename) {
+
+    std::ofstream stream (filename);
+    if (!stream.good()) {
+        WARNING("Could not open file '%s' for writing.", filename.c_str());
+        return false;
+    }
+
+    std::vector< std::pair<std::string, Counter> > counters = merged();
+    stream << "{\n";
+    for (unsigned i = 0; i < counters.size(); i++) {
+        const Counter& c = counters[i].second;
+        stream << "  \"" << counters[i].first << "\": {"
+               << "\"calls\": "    << c.calls   << ", "
+               << "\"total_ns\": " << c.totalNs << ", "
+               << "\"min_ns\": "   << c.minNs   << ", "
+               << "\"max_ns\": "   << c.maxNs   << "}"
+               << (i + 1 < counters.size() ? ",\n" : "\n");
+    }
+    stream << "}\n";
+    stream.close();
+
+    return true;
+}
+
+bool Profiler::exportChromeTrace (const std::string& filename) {
+
+    std::ofstream stream (filename);
+    if (!stream.good()) {
+        WARNING("Could not open file '%s' for writing.", filename.c_str());
+        return false;
+    }
+
+    // Complete ('X') events, with time stamps and durations in microseconds,
+    // written in fixed notation with nanosecond resolution, since the default
+    // six significant digits truncate the time stamps of long runs.
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"traceEvents\": [\n";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        for (auto& data : m_threads) {
+            std::lock_guard<std::mutex> threadLock (data->mutex);
+            for (const Event& event : data->events) {
+                if (!first) { stream << ",\n"; }
+                first = false;
+                stream << "  {\"name\": \"" << event.name << "\", \"ph\": \"X\", "
+                       << "\"ts\": "  << event.startNs    * 1.0e-3 << ", "
+                       << "\"dur\": " << event.durationNs * 1.0e-3 << ", "
+                       << "\"pid\": 0, \"tid\": " << data->id << "}";
+            }
+        }
+    }
+    stream << "\n]}\n";
+    stream.close();
+
+    return true;
+}
+
+} // namespace
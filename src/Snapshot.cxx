@@ -65,8 +65,16 @@ Snapshot& operator<< (Snapshot& snap, const Wavenet& wavenet) {
     stream << wavenet.m_momentum         << "\n#\n";
 
     stream << wavenet.m_batchSize << "\n";
-    stream << "BATCHQUEUE" << "\n";
-    for (const auto& q : wavenet.m_batchQueue) { stream << q << "\n#\n"; }
+    // The current, incomplete batch is stored through the state of the batch 
+    // accumulator, rather than the gradients of the individual examples.
+    const GradientAccumulator& batch = wavenet.m_batchAccumulator;
+    stream << "BATCHSTATISTICS" << "\n";
+    stream << batch.count() << "\n";
+    if (!batch.empty()) {
+        stream << batch.sum()  << "\n#\n";
+        stream << batch.mean() << "\n#\n";
+        stream << batch.m2()   << "\n#\n";
+    }
 
     stream << "FILTERLOG" << "\n";
     for (const auto& f : wavenet.m_filterLog)  { stream << f << "\n#\n"; }
@@ -102,6 +110,8 @@ const Snapshot& operator>> (const Snapshot& snap, Wavenet& wavenet) {
         } catch (const std::invalid_argument& ia) {;}
     }
     wavenet.m_filter = arma::conv_to< arma::Col<double> >::from(vec_filter);
+    wavenet.resetFilterState_();
+    wavenet.resetRollbackState_();
     
     // Read momentum.
     std::vector<double> vec_momentum;
@@ -114,18 +124,40 @@ const Snapshot& operator>> (const Snapshot& snap, Wavenet& wavenet) {
     
     stream >> wavenet.m_batchSize;
     
-    // Read batch queue.
+    // Read the state of the batch accumulator.
     stream >> tmp;
-    wavenet.m_batchQueue.clear();
-    while (tmp.find("FILTERLOG") == std::string::npos) {
-        std::vector<double> vec_momentum;
-        while (stream >> tmp) {
-            try {
-                vec_momentum.push_back( stod(tmp) );
-            } catch (const std::invalid_argument& ia) { break; }
+    wavenet.m_batchAccumulator.clear();
+    if (tmp.find("BATCHSTATISTICS") != std::string::npos) {
+        unsigned count = 0;
+        stream >> count;
+        if (count > 0) {
+            std::vector< arma::Col<double> > vecs (3); // Sum, mean, and squared deviations.
+            for (arma::Col<double>& vec : vecs) {
+                std::vector<double> values;
+                while (stream >> tmp && tmp.find("#") == std::string::npos) {
+                    try {
+                        values.push_back( stod(tmp) );
+                    } catch (const std::invalid_argument& ia) {;}
+                }
+                vec = arma::conv_to< arma::Col<double> >::from(values);
+            }
+            wavenet.m_batchAccumulator.set(count, vecs[0], vecs[1], vecs[2]);
+        }
+        stream >> tmp;
+    } else {
+
+        // Snapshots written before the batch accumulator was introduced store
+        // the gradient of each example in the batch queue.
+        while (tmp.find("FILTERLOG") == std::string::npos) {
+            std::vector<double> vec_gradient;
+            while (stream >> tmp) {
+                try {
+                    vec_gradient.push_back( stod(tmp) );
+                } catch (const std::invalid_argument& ia) { break; }
+            }
+            if (!vec_gradient.size()) { break; }
+            wavenet.m_batchAccumulator.add( arma::conv_to< arma::Col<double> >::from(vec_gradient) );
         }
-        if (!vec_momentum.size()) { break; }
-        wavenet.m_batchQueue.push_back( arma::conv_to< arma::Col<double> >::from(vec_momentum) );
     }
     
     // Read filter log.
@@ -0,0 +1,333 @@
+#include "Wavenet/StreamingTransform.h"
+
+namespace wavenet {
+
+namespace {
+
+    // Floor of a / 2, for any sign of a.
+    inline long floorHalf (const long& a) { return (a >= 0 ? a / 2 : -((-a + 1) / 2)); }
+
+    // Ceiling of a / 2, for any sign of a.
+    inline long ceilHalf (const long& a) { return -floorHalf(-a); }
+
+    // Non-negative remainder of t modulo n.
+    inline long modulo (const long& t, const long& n) { return ((t % n) + n) % n; }
+
+    // Set the low- and high-pass filter coefficients, b_{k} = (-1)^k a_{N - k - 1}
+    // (@see HighpassOperator).
+    inline void setFilters (const arma::Col<double>& filter, std::vector<double>& lowpass, std::vector<double>& highpass) {
+        const unsigned N = filter.n_elem;
+        lowpass .resize(N);
+        highpass.resize(N);
+        for (unsigned k = 0; k < N; k++) {
+            lowpass [k] = filter(k);
+            highpass[k] = (k % 2 ? -1. : 1.) * filter(N - k - 1);
+        }
+        return;
+    }
+
+    // Index of the first input at each scale. The stream starts at index 0, and
+    // the inputs to scale s + 1 are the low-pass outputs of scale s, the first
+    // of which is the first r for which 2r + N/2 is not before the first input.
+    inline std::vector<long> scaleStarts (const unsigned& N, const unsigned& numLevels) {
+        std::vector<long> starts (numLevels + 1, 0);
+        for (unsigned s = 0; s < numLevels; s++) {
+            starts[s + 1] = ceilHalf(starts[s] - (long) N / 2);
+        }
+        return starts;
+    }
+
+} // namespace
+
+
+/// StreamingTransform
+// -----------------------------------------------------------------------------
+
+bool StreamingTransform::init (const arma::Col<double>& filter, const unsigned& numLevels) {
+
+    // Perform checks.
+    m_valid = false;
+    if (filter.n_elem == 0 || filter.n_elem % 2 != 0) {
+        WARNING("Number of filter coefficients (%d) is not a positive multiple of 2.", filter.n_elem);
+        return false;
+    }
+
+    if (numLevels == 0) {
+        WARNING("Number of levels must be positive.");
+        return false;
+    }
+
+    // Set filters, and initialise the state at each scale.
+    setFilters(filter, m_lowpass, m_highpass);
+    m_scales.assign(numLevels, Scale());
+
+    m_valid = true;
+    reset();
+    return true;
+}
+
+void StreamingTransform::reset () {
+    const std::vector<long> starts = scaleStarts(m_lowpass.size(), m_scales.size());
+    for (unsigned s = 0; s < m_scales.size(); s++) {
+        m_scales[s].history.assign(m_lowpass.size(), 0.);
+        m_scales[s].start = starts[s];
+        m_scales[s].next  = starts[s];
+    }
+    m_numSamples = 0;
+    return;
+}
+
+bool StreamingTransform::push (const arma::Col<double>& samples, std::vector<StreamingCoefficient>& coefficients) {
+
+    // Perform checks.
+    if (!m_valid) {
+        WARNING("Transform is not properly initialised.");
+        return false;
+    }
+
+    // Push samples to the finest scale.
+    for (unsigned i = 0; i < samples.n_elem; i++) {
+        push_(0, samples(i), coefficients);
+    }
+    m_numSamples += samples.n_elem;
+
+    return true;
+}
+
+bool StreamingTransform::flush (std::vector<StreamingCoefficient>& coefficients) {
+
+    // Perform checks.
+    if (!m_valid) {
+        WARNING("Transform is not properly initialised.");
+        return false;
+    }
+
+    // Pad each scale, from finest to coarsest, with zeros until the last
+    // output depending on the inputs at that scale, i.e. the last r for which
+    // 2r + N/2 - (N - 1) is not after the last input, has been emitted. The
+    // outputs emitted while padding are inputs to the coarser scales.
+    const long N    = m_lowpass.size();
+    const long half = N / 2;
+    for (unsigned s = 0; s < m_scales.size(); s++) {
+        Scale& scale = m_scales[s];
+        if (scale.next == scale.start) { continue; }
+        const long last  = scale.next - 1;
+        const long rLast = floorHalf(last + N - 1 - half);
+        while (scale.next <= 2 * rLast + half) {
+            push_(s, 0., coefficients);
+        }
+    }
+
+    reset();
+    return true;
+}
+
+void StreamingTransform::push_ (const unsigned& s, const double& value, std::vector<StreamingCoefficient>& coefficients) {
+
+    Scale& scale = m_scales[s];
+    const long N    = m_lowpass.size();
+    const long half = N / 2;
+
+    // Store the input.
+    const long t = scale.next++;
+    scale.history[modulo(t, N)] = value;
+
+    // Output r is complete once the input at 2r + N/2 has been received.
+    if (((t - half) & 1) != 0) { return; }
+    const long r = (t - half) / 2;
+
+    // Apply filters to the latest N inputs, where inputs before the start are
+    // zero.
+    double low = 0, high = 0;
+    for (long k = 0; k < N && t - k >= scale.start; k++) {
+        const double u = scale.history[modulo(t - k, N)];
+        low  += m_lowpass [k] * u;
+        high += m_highpass[k] * u;
+    }
+
+    // Emit high-pass coefficient, and propagate the low-pass output to the
+    // next scale, or emit it at the coarsest scale.
+    coefficients.push_back({s, r, high, false});
+    if (s + 1 < m_scales.size()) {
+        push_(s + 1, low, coefficients);
+    } else {
+        coefficients.push_back({s, r, low, true});
+    }
+
+    return;
+}
+
+
+/// StreamingInverse
+// -----------------------------------------------------------------------------
+
+bool StreamingInverse::init (const arma::Col<double>& filter, const unsigned& numLevels) {
+
+    // Perform checks.
+    m_valid = false;
+    if (filter.n_elem == 0 || filter.n_elem % 2 != 0) {
+        WARNING("Number of filter coefficients (%d) is not a positive multiple of 2.", filter.n_elem);
+        return false;
+    }
+
+    if (numLevels == 0) {
+        WARNING("Number of levels must be positive.");
+        return false;
+    }
+
+    // Set filters, and initialise the state at each scale.
+    setFilters(filter, m_lowpass, m_highpass);
+    m_scales.assign(numLevels, Scale());
+
+    m_valid = true;
+    reset();
+    return true;
+}
+
+void StreamingInverse::reset () {
+    const long N    = m_lowpass.size();
+    const long half = N / 2;
+    const std::vector<long> starts = scaleStarts(N, m_scales.size());
+    for (unsigned s = 0; s < m_scales.size(); s++) {
+        Scale& scale = m_scales[s];
+        scale.low        .clear();
+        scale.high       .clear();
+        scale.accumulated.clear();
+        scale.start = starts[s];
+        scale.next  = starts[s + 1];
+        scale.accumulatedStart = 2 * scale.next + half - N + 1;
+    }
+    m_numSamples = 0;
+    m_maxSamples = -1;
+    m_hasPending = false;
+    m_pending    = 0;
+    return;
+}
+
+bool StreamingInverse::push (const std::vector<StreamingCoefficient>& coefficients, std::vector<double>& samples) {
+
+    // Perform checks.
+    if (!m_valid) {
+        WARNING("Inverse is not properly initialised.");
+        return false;
+    }
+
+    for (const StreamingCoefficient& c : coefficients) {
+
+        // Perform checks.
+        if (c.scale >= m_scales.size() || (c.lowpass && c.scale + 1 != m_scales.size())) {
+            WARNING("Coefficient at scale %d (%s) is not valid for %d levels.", c.scale, (c.lowpass ? "low-pass" : "high-pass"), m_scales.size());
+            return false;
+        }
+
+        Scale& scale = m_scales[c.scale];
+        std::deque<double>& queue = (c.lowpass ? scale.low : scale.high);
+        if (c.index != scale.next + (long) queue.size()) {
+            WARNING("Coefficient %ld at scale %d is out of order (expected %ld).", c.index, c.scale, scale.next + (long) queue.size());
+            return false;
+        }
+
+        // Queue the coefficient, and process the scale.
+        queue.push_back(c.value);
+        process_(c.scale, samples);
+    }
+
+    return true;
+}
+
+bool StreamingInverse::flush (std::vector<double>& samples, const long& numSamples) {
+
+    // Perform checks.
+    if (!m_valid) {
+        WARNING("Inverse is not properly initialised.");
+        return false;
+    }
+
+    // Since no further coefficients will be received, all partially
+    // reconstructed outputs are complete. Emit these from the coarsest to the
+    // finest scale, processing the finer scales as their inputs are completed.
+    m_maxSamples = numSamples;
+    for (unsigned s = m_scales.size(); s --> 0; ) {
+        Scale& scale = m_scales[s];
+        while (!scale.accumulated.empty()) {
+            const double value = scale.accumulated.front();
+            scale.accumulated.pop_front();
+            emit_(s, scale.accumulatedStart++, value, samples);
+        }
+    }
+
+    // Append the sample held back, if any.
+    if (m_hasPending && (m_maxSamples < 0 || m_numSamples < m_maxSamples)) {
+        samples.push_back(m_pending);
+        m_numSamples++;
+    }
+
+    reset();
+    return true;
+}
+
+void StreamingInverse::process_ (const unsigned& s, std::vector<double>& samples) {
+
+    Scale& scale = m_scales[s];
+    const long N    = m_lowpass.size();
+    const long half = N / 2;
+
+    while (!scale.low.empty() && !scale.high.empty()) {
+
+        // Get the next pair of low- and high-pass inputs.
+        const long r = scale.next++;
+        const double low  = scale.low .front();
+        const double high = scale.high.front();
+        scale.low .pop_front();
+        scale.high.pop_front();
+
+        // Add the contributions to the outputs 2r + N/2 - k, for k in [0, N),
+        // i.e. apply the transposed filters.
+        const long last = 2 * r + half;
+        while (scale.accumulatedStart + (long) scale.accumulated.size() <= last) {
+            scale.accumulated.push_back(0.);
+        }
+        for (long k = 0; k < N; k++) {
+            scale.accumulated[last - k - scale.accumulatedStart] += m_lowpass[k] * low + m_highpass[k] * high;
+        }
+
+        // Outputs before the first output receiving contributions from the next
+        // pair are complete.
+        const long complete = 2 * (r + 1) + half - N + 1;
+        while (scale.accumulatedStart < complete) {
+            const double value = scale.accumulated.front();
+            scale.accumulated.pop_front();
+            emit_(s, scale.accumulatedStart++, value, samples);
+        }
+    }
+
+    return;
+}
+
+void StreamingInverse::emit_ (const unsigned& s, const long& index, const double& value, std::vector<double>& samples) {
+
+    // Outputs before the start of the stream reconstruct the zeros preceding
+    // it, and are discarded.
+    if (index < m_scales[s].start) { return; }
+
+    // Append to the reconstructed samples at the finest scale. The latest
+    // sample is held back until the next one is completed, since it may
+    // reconstruct the zero padding of a flushed transform (@see flush).
+    if (s == 0) {
+        if (m_hasPending && (m_maxSamples < 0 || m_numSamples < m_maxSamples)) {
+            samples.push_back(m_pending);
+            m_numSamples++;
+        }
+        m_pending = value;
+        m_hasPending = true;
+        return;
+    }
+
+    // Otherwise, the output is a low-pass input to the finer scale.
+    m_scales[s - 1].low.push_back(value);
+    process_(s - 1, samples);
+
+    return;
+}
+
+} // namespace
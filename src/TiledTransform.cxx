@@ -0,0 +1,247 @@
+#include "Wavenet/TiledTransform.h"
+
+// STL include(s).
+#include <thread> /* std::thread */
+#include <atomic> /* std::atomic */
+
+namespace wavenet {
+
+constexpr unsigned long long TiledTransform::s_minWorkPerThread;
+
+namespace {
+
+    // Non-negative remainder of t modulo n.
+    inline long modulo (const long& t, const long& n) { return ((t % n) + n) % n; }
+
+} // namespace
+
+
+bool TiledTransform::init (const arma::Col<double>& filter, const unsigned& tileSize, const unsigned& tileLevels,
+                           const Boundary& boundary) {
+
+    // Perform checks.
+    m_valid = false;
+    if (filter.n_elem == 0 || filter.n_elem % 2 != 0) {
+        WARNING("Number of filter coefficients (%d) is not a positive multiple of 2.", filter.n_elem);
+        return false;
+    }
+
+    if (!isRadix2(tileSize) || tileSize < 2) {
+        WARNING("Tile size (%d) is not radix 2, or smaller than 2.", tileSize);
+        return false;
+    }
+
+    if (tileLevels == 0 || (1u << tileLevels) > tileSize) {
+        WARNING("Number of levels per tile (%d) must be positive, and at most log2(%d).", tileLevels, tileSize);
+        return false;
+    }
+
+    // Set configuration.
+    m_tileSize   = tileSize;
+    m_tileLevels = tileLevels;
+    m_boundary   = boundary;
+    m_numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Set the low- and high-pass filter coefficients, b_{k} = (-1)^k a_{N - k
+    // - 1} (@see HighpassOperator).
+    const unsigned N = filter.n_elem;
+    m_lowpass .resize(N);
+    m_highpass.resize(N);
+    for (unsigned k = 0; k < N; k++) {
+        m_lowpass [k] = filter(k);
+        m_highpass[k] = (k % 2 ? -1. : 1.) * filter(N - k - 1);
+    }
+
+    m_valid = true;
+    return true;
+}
+
+unsigned TiledTransform::halo () const {
+    return (m_lowpass.size() / 2 - 1) * ((1u << m_tileLevels) - 1);
+}
+
+bool TiledTransform::forward (const arma::Mat<double>& X, arma::Mat<double>& Y) const {
+
+    // Perform checks.
+    if (!m_valid) {
+        WARNING("Transform is not properly initialised.");
+        return false;
+    }
+
+    if (!isRadix2(X.n_rows) || !isRadix2(X.n_cols)) {
+        WARNING("Input of shape {%d, %d} is not radix 2.", X.n_rows, X.n_cols);
+        return false;
+    }
+
+    // Forward transform rows, then the resulting columns.
+    arma::Mat<double> partial (X.n_rows, X.n_cols);
+    transformAxis_(X, partial, true);
+
+    Y.set_size(X.n_rows, X.n_cols);
+    transformAxis_(partial, Y, false);
+
+    return true;
+}
+
+void TiledTransform::transformAxis_ (const arma::Mat<double>& in, arma::Mat<double>& out, const bool& alongRows) const {
+
+    // Initialise size variable(s). The tiles are 'width' long along the axis,
+    // and span 'block' lines across it.
+    const long n      = (alongRows ? in.n_cols : in.n_rows); // Length of each line.
+    const long nLines = (alongRows ? in.n_rows : in.n_cols); // Number of lines.
+    const long stride = (alongRows ? in.n_rows : 1);         // Stride along lines.
+    const long step   = (alongRows ? 1 : in.n_rows);         // Stride between lines.
+
+    const unsigned m      = log2(n);
+    const long     width  = std::min<long>(m_tileSize, n);
+    const unsigned levels = std::min<unsigned>(m_tileLevels, log2(width));
+    const long     block  = std::min<long>(m_tileSize, nLines);
+    const long     halo   = ((long) m_lowpass.size() / 2 - 1) * ((1L << levels) - 1);
+
+    const unsigned nSegments = n / width;
+    const unsigned nBlocks   = (nLines + block - 1) / block;
+
+    // Low-pass coefficients remaining after the levels performed on tiles, for
+    // each line.
+    const long nCoarse = n >> levels;
+    std::vector<double> coarse (nLines * nCoarse);
+
+    // Perform the first levels on each tile, with halo.
+    parallelFor_(nSegments * nBlocks, nLines * (width + 2 * halo) * nSegments, [&] (unsigned itile) {
+        const long begin = (itile % nSegments) * width;
+        const long first = (itile / nSegments) * block;
+        const long last  = std::min(first + block, nLines);
+        std::vector<double> ext, buffer;
+        for (long line = first; line < last; line++) {
+            gather_(in.memptr() + line * step, stride, n, begin - halo, width + 2 * halo, ext);
+            segment_(ext, buffer, n, begin, width, levels,
+                     out.memptr() + line * step, stride, coarse.data() + line * nCoarse, 1);
+        }
+    });
+
+    // Perform the remaining levels on the low-pass coefficients of each line,
+    // storing the final, lowest-scale coefficient at index 0.
+    const unsigned remaining = m - levels;
+    const long     haloCoarse = ((long) m_lowpass.size() / 2 - 1) * ((1L << remaining) - 1);
+    parallelFor_(nBlocks, nLines * (nCoarse + 2 * haloCoarse), [&] (unsigned iblock) {
+        const long first = iblock * block;
+        const long last  = std::min(first + block, nLines);
+        std::vector<double> ext, buffer;
+        for (long line = first; line < last; line++) {
+            double* coeffs = out.memptr() + line * step;
+            gather_(coarse.data() + line * nCoarse, 1, nCoarse, -haloCoarse, nCoarse + 2 * haloCoarse, ext);
+            segment_(ext, buffer, nCoarse, 0, nCoarse, remaining, coeffs, stride, coeffs, stride);
+        }
+    });
+
+    return;
+}
+
+void TiledTransform::gather_ (const double* line, const long& stride, const long& n,
+                              const long& begin, const long& length, std::vector<double>& ext) const {
+
+    ext.resize(length);
+    for (long i = 0; i < length; i++) {
+        const long t = begin + i;
+        if (m_boundary == Boundary::Periodic) {
+            ext[i] = line[modulo(t, n) * stride];
+        } else {
+            ext[i] = (t >= 0 && t < n ? line[t * stride] : 0.);
+        }
+    }
+    return;
+}
+
+void TiledTransform::segment_ (std::vector<double>& ext, std::vector<double>& buffer,
+                               const long& n, const long& begin, const long& width, const unsigned& levels,
+                               double* coeffs, const long& coeffStride, double* coarse, const long& coarseStride) const {
+
+    const long N    = m_lowpass.size();
+    const long half = N / 2;
+
+    // The inputs at the current level are 'ext', covering [lo, lo + ext.size()).
+    long lo = begin - (half - 1) * ((1L << levels) - 1);
+
+    for (unsigned d = 0; d < levels; d++) {
+
+        // Outputs of the tile at this level, [outBegin, outEnd), and the
+        // outputs in the halo needed by the remaining levels, on either side.
+        const long outBegin = begin >> (d + 1);
+        const long outEnd   = (begin + width) >> (d + 1);
+        const long outHalo  = (half - 1) * ((1L << (levels - d - 1)) - 1);
+        const long nOut     = n >> (d + 1); // Length of the level output.
+
+        // Output r is sum_k g_k u(2r + N/2 - k) (@see LowpassOperator).
+        buffer.resize(outEnd - outBegin + 2 * outHalo);
+        for (long r = outBegin - outHalo; r < outEnd + outHalo; r++) {
+            const double* u = ext.data() + (2 * r + half - lo);
+            double low = 0, high = 0;
+            for (long k = 0; k < N; k++) {
+                low += m_lowpass[k] * u[-k];
+            }
+            if (r >= outBegin && r < outEnd) {
+                for (long k = 0; k < N; k++) {
+                    high += m_highpass[k] * u[-k];
+                }
+                // High-pass coefficients at this level are stored at indices
+                // [nOut, 2 * nOut).
+                coeffs[(nOut + r) * coeffStride] = high;
+            }
+
+            // For zero boundaries, the low-pass outputs outside the boundary
+            // are zero, rather than the filtered inputs.
+            if (m_boundary == Boundary::Zero && (r < 0 || r >= nOut)) {
+                low = 0;
+            }
+            buffer[r - (outBegin - outHalo)] = low;
+        }
+
+        // Proceed with the low-pass outputs.
+        std::swap(ext, buffer);
+        lo = outBegin - outHalo;
+    }
+
+    // Store the low-pass outputs of the tile at the last level.
+    const long coarseBegin = begin >> levels;
+    const long coarseEnd   = (begin + width) >> levels;
+    for (long r = coarseBegin; r < coarseEnd; r++) {
+        coarse[r * coarseStride] = ext[r - lo];
+    }
+
+    return;
+}
+
+void TiledTransform::parallelFor_ (const unsigned& count, const unsigned long long& work,
+                                   const std::function<void(unsigned)>& fun) const {
+
+    // Distribute indices dynamically, such that threads finishing early
+    // proceed with the remaining tiles.
+    std::atomic<unsigned> next (0);
+    auto worker = [&] () {
+        for (unsigned i = next++; i < count; i = next++) {
+            fun(i);
+        }
+    };
+
+    // Only start as many threads as there is sufficient work for.
+    const unsigned long long maxThreads = std::max(work / s_minWorkPerThread, 1ULL);
+    const unsigned numThreads = (unsigned) std::min<unsigned long long>(std::min(m_numThreads, count), maxThreads);
+    if (numThreads <= 1) {
+        worker();
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (unsigned i = 1; i < numThreads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    return;
+}
+
+} // namespace
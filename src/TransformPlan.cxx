@@ -0,0 +1,660 @@
+#include "Wavenet/TransformPlan.h"
+
+// STL include(s).
+#include <algorithm> /* std::fill, std::copy, std::max */
+#include <cmath> /* std::fabs, std::isfinite */
+
+namespace wavenet {
+
+constexpr unsigned TransformPlan::s_inputOnly;
+constexpr unsigned TransformPlan::s_none;
+
+bool TransformPlan::init (const std::vector<unsigned>& shape, const unsigned& filterLength, const Mode& mode,
+                          const unsigned& checkpointInterval) {
+
+    // Reset configuration.
+    m_valid = false;
+    m_hasFilter = false;
+    m_hasActivations = false;
+
+    // Perform checks.
+    if (shape.size() < 1 || shape.size() > 2) {
+        WARNING("Only one- and two-dimensional shapes are supported.");
+        return false;
+    }
+
+    const unsigned nRows = shape[0];
+    const unsigned nCols = (shape.size() > 1 ? shape[1] : 1);
+    if (!isRadix2(nRows) || !isRadix2(nCols)) {
+        WARNING("Requested shape {%d, %d} is not radix 2.", nRows, nCols);
+        return false;
+    }
+
+    if (filterLength == 0 || filterLength % 2 != 0) {
+        WARNING("Number of filter coefficients (%d) is not a positive multiple of 2.", filterLength);
+        return false;
+    }
+
+    // Store configuration.
+    m_nRows = nRows;
+    m_nCols = nCols;
+    m_filterLength = filterLength;
+    m_mode = mode;
+    m_checkpointInterval = checkpointInterval;
+
+    // Precompute the levels along each axis. With checkpoint interval 0, only
+    // the inputs to the row transforms (i.e. the input matrix) are stored,
+    // unless there are no row transforms, in which case the inputs to the
+    // column transforms are stored instead.
+    const unsigned rowInterval = (checkpointInterval == 0 ? s_inputOnly : checkpointInterval);
+    const unsigned colInterval = (checkpointInterval == 0 && m_nCols > 1 ? s_none : rowInterval);
+    m_rowAxis = planAxis_(m_nCols, rowInterval);
+    m_colAxis = planAxis_(m_nRows, colInterval);
+
+    // Allocate scratch memory. In 'Invertible' mode, the memory for the
+    // activations is only allocated if the plan falls back to storing them.
+    const unsigned maxLength = std::max(m_nRows, m_nCols);
+    m_rowActivations.clear();
+    m_colActivations.clear();
+    m_restored      .clear();
+    if (m_mode == Mode::Train) { allocateActivations_(); }
+    m_matrix   .assign(m_nRows * m_nCols, 0.);
+    m_row      .assign(m_nCols, 0.);
+    m_rowOut   .assign(m_nCols, 0.);
+    m_buffer[0].assign(std::max(maxLength / 2, 1u), 0.);
+    m_buffer[1].assign(std::max(maxLength / 2, 1u), 0.);
+    if (m_mode == Mode::Invertible) {
+        m_partial         .assign(m_nRows * m_nCols, 0.);
+        m_partialRow      .assign(m_nCols, 0.);
+        m_reconstructed[0].assign(maxLength, 0.);
+        m_reconstructed[1].assign(maxLength, 0.);
+
+        // Fixed, pseudo-random probe input in [-1, 1], such that the measured
+        // reconstruction error is reproducible.
+        m_probe.resize(maxLength);
+        unsigned long long state = 88172645463325252ULL;
+        for (double& value : m_probe) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            value = 2. * double(state >> 11) / double(1ULL << 53) - 1.;
+        }
+    } else {
+        m_partial         .clear();
+        m_partialRow      .clear();
+        m_reconstructed[0].clear();
+        m_reconstructed[1].clear();
+        m_probe           .clear();
+    }
+    m_lowpass     .assign(m_filterLength, 0.);
+    m_highpass    .assign(m_filterLength, 0.);
+    m_corrLowpass .assign(m_filterLength, 0.);
+    m_corrHighpass.assign(m_filterLength, 0.);
+
+    m_fallback = false;
+    m_valid = true;
+    return true;
+}
+
+bool TransformPlan::matches (const std::vector<unsigned>& shape, const unsigned& filterLength, const Mode& mode,
+                             const unsigned& checkpointInterval) const {
+    if (!m_valid || shape.size() < 1 || shape.size() > 2) { return false; }
+    const unsigned nCols = (shape.size() > 1 ? shape[1] : 1);
+    return shape[0] == m_nRows && nCols == m_nCols && filterLength == m_filterLength && mode == m_mode &&
+        (mode == Mode::Transform || checkpointInterval == m_checkpointInterval);
+}
+
+bool TransformPlan::setFilter (const arma::Col<double>& filter) {
+
+    // Perform checks.
+    if (!m_valid) {
+        WARNING("Plan is not properly initialised.");
+        return false;
+    }
+
+    if (filter.n_elem != m_filterLength) {
+        WARNING("Number of filter coefficients (%d) doesn't match plan (%d).", filter.n_elem, m_filterLength);
+        return false;
+    }
+
+    // Set the low-pass coefficients directly, and the high-pass coefficients
+    // as b_{k} = (-1)^k a_{N - k - 1} (@see HighpassOperator).
+    const unsigned N = m_filterLength;
+    for (unsigned k = 0; k < N; k++) {
+        m_lowpass [k] = filter(k);
+        m_highpass[k] = (k % 2 ? -1. : 1.) * filter(N - k - 1);
+    }
+
+    // In 'Invertible' mode, measure the actual error of reconstructing the 
+    // probe input from its wavelet coefficients along each axis, and fall back
+    // to storing activations if the reconstruction is not sufficiently exact.
+    m_drift = 0;
+    if (m_mode == Mode::Invertible) {
+        m_drift = std::max(reconstructionError_(m_rowAxis), reconstructionError_(m_colAxis));
+        const bool fallback = (m_drift > m_tolerance);
+        if (fallback != m_fallback) {
+            DEBUG("%s stored activations (drift: %.2e, tolerance: %.2e).", (fallback ? "Falling back to" : "No longer using"), m_drift, m_tolerance);
+        }
+        m_fallback = fallback;
+        if (m_fallback && m_rowActivations.empty() && m_colActivations.empty()) { allocateActivations_(); }
+    }
+
+    // Stored activations (if any) were computed with the previous filter.
+    m_hasFilter = true;
+    m_hasActivations = false;
+
+    return true;
+}
+
+unsigned long long TransformPlan::activationBytes () const {
+    return (m_rowActivations.size() + m_colActivations.size()) * sizeof(double);
+}
+
+unsigned long long TransformPlan::scratchBytes () const {
+    const unsigned long long entries = m_rowActivations.size() + m_colActivations.size() +
+                                       m_matrix.size() + m_row.size() + m_rowOut.size() +
+                                       m_buffer[0].size() + m_buffer[1].size() + m_restored.size() +
+                                       m_partial.size() + m_partialRow.size() +
+                                       m_reconstructed[0].size() + m_reconstructed[1].size() + m_probe.size() +
+                                       m_lowpass.size() + m_highpass.size() +
+                                       m_corrLowpass.size() + m_corrHighpass.size();
+    return entries * sizeof(double);
+}
+
+
+/// Execution method(s).
+// -----------------------------------------------------------------------------
+
+bool TransformPlan::forward (const arma::Mat<double>& X, arma::Mat<double>& Y) {
+
+    PROFILE("TransformPlan::forward");
+
+    // Perform checks.
+    if (!m_valid || !m_hasFilter) {
+        WARNING("Plan is not properly initialised, or filter is not set.");
+        return false;
+    }
+
+    if (X.n_rows != m_nRows || X.n_cols != m_nCols) {
+        WARNING("Input shape {%d, %d} doesn't match plan {%d, %d}.", X.n_rows, X.n_cols, m_nRows, m_nCols);
+        return false;
+    }
+
+    // Initialise output. (No allocation if Y already has the right shape.)
+    Y.set_size(m_nRows, m_nCols);
+
+    const bool store = (m_mode == Mode::Train || (m_mode == Mode::Invertible && m_fallback));
+    const bool storeRows = store && m_rowAxis.activationSize > 0;
+    const bool storeCols = store && m_colAxis.activationSize > 0;
+    const double* x = X.memptr();
+    const unsigned mRow = m_rowAxis.levels.size();
+
+    // Forward transform rows, storing the resulting coefficients in the
+    // partially transformed matrix.
+    for (unsigned irow = 0; irow < m_nRows; irow++) {
+
+        // Gather the irow'th row directly into the stored activations, if
+        // applicable, to avoid an additional copy.
+        double* activations = (storeRows ? m_rowActivations.data() + irow * m_rowAxis.activationSize : nullptr);
+        double* row = (storeRows ? activations + m_rowAxis.levels[mRow - 1].storedOffset : m_row.data());
+        for (unsigned icol = 0; icol < m_nCols; icol++) {
+            row[icol] = x[irow + icol * m_nRows];
+        }
+
+        forward1D_(m_rowAxis, row, m_rowOut.data(), activations);
+
+        for (unsigned icol = 0; icol < m_nCols; icol++) {
+            m_matrix[irow + icol * m_nRows] = m_rowOut[icol];
+        }
+    }
+
+    // Forward transform resulting columns, directly into the output.
+    for (unsigned icol = 0; icol < m_nCols; icol++) {
+        double* activations = (storeCols ? m_colActivations.data() + icol * m_colAxis.activationSize : nullptr);
+        forward1D_(m_colAxis, m_matrix.data() + icol * m_nRows, Y.colptr(icol), activations);
+    }
+
+    m_hasActivations = (m_mode != Mode::Transform);
+
+    return true;
+}
+
+bool TransformPlan::inverse (const arma::Mat<double>& Y, arma::Mat<double>& X) {
+
+    PROFILE("TransformPlan::inverse");
+
+    // Perform checks.
+    if (!m_valid || !m_hasFilter) {
+        WARNING("Plan is not properly initialised, or filter is not set.");
+        return false;
+    }
+
+    if (Y.n_rows != m_nRows || Y.n_cols != m_nCols) {
+        WARNING("Input shape {%d, %d} doesn't match plan {%d, %d}.", Y.n_rows, Y.n_cols, m_nRows, m_nCols);
+        return false;
+    }
+
+    // Initialise output.
+    X.set_size(m_nRows, m_nCols);
+    double* x = X.memptr();
+
+    // Inverse transform columns (in reverse order of the forward transform).
+    for (unsigned icol = 0; icol < m_nCols; icol++) {
+        inverse1D_(m_colAxis, Y.colptr(icol), m_matrix.data() + icol * m_nRows);
+    }
+
+    // Inverse transform resulting rows, directly into the output.
+    for (unsigned irow = 0; irow < m_nRows; irow++) {
+        for (unsigned icol = 0; icol < m_nCols; icol++) {
+            m_row[icol] = m_matrix[irow + icol * m_nRows];
+        }
+
+        inverse1D_(m_rowAxis, m_row.data(), m_rowOut.data());
+
+        for (unsigned icol = 0; icol < m_nCols; icol++) {
+            x[irow + icol * m_nRows] = m_rowOut[icol];
+        }
+    }
+
+    return true;
+}
+
+bool TransformPlan::backward (const arma::Mat<double>& Delta, arma::Col<double>& gradient) {
+
+    PROFILE("TransformPlan::backward");
+
+    // Perform checks.
+    if (m_mode == Mode::Transform) {
+        WARNING("Backward pass is not available in 'Transform' mode.");
+        return false;
+    }
+
+    if (reconstructs()) {
+        WARNING("Backward pass in 'Invertible' mode requires the wavelet coefficients.");
+        return false;
+    }
+
+    if (!m_hasActivations) {
+        WARNING("No activations from a forward pass with the current filter.");
+        return false;
+    }
+
+    if (Delta.n_rows != m_nRows || Delta.n_cols != m_nCols) {
+        WARNING("Input shape {%d, %d} doesn't match plan {%d, %d}.", Delta.n_rows, Delta.n_cols, m_nRows, m_nCols);
+        return false;
+    }
+
+    // Reset correlations.
+    std::fill(m_corrLowpass .begin(), m_corrLowpass .end(), 0.);
+    std::fill(m_corrHighpass.begin(), m_corrHighpass.end(), 0.);
+
+    // If the inputs to the column transforms are not stored (checkpoint
+    // interval 0), recompute the partially transformed matrix from the stored
+    // input matrix.
+    const unsigned mRow = m_rowAxis.levels.size();
+    const unsigned mCol = m_colAxis.levels.size();
+    const bool recomputeCols = (mCol > 0 && m_colAxis.activationSize == 0);
+    if (recomputeCols) {
+        for (unsigned irow = 0; irow < m_nRows; irow++) {
+            const double* row = m_rowActivations.data() + irow * m_rowAxis.activationSize + m_rowAxis.levels[mRow - 1].storedOffset;
+            forward1D_(m_rowAxis, row, m_rowOut.data(), nullptr);
+            for (unsigned icol = 0; icol < m_nCols; icol++) {
+                m_matrix[irow + icol * m_nRows] = m_rowOut[icol];
+            }
+        }
+    }
+
+    // Backpropagate columns (in reverse order of the forward transform),
+    // storing the errors on the inputs in the partially transformed matrix.
+    for (unsigned icol = 0; icol < m_nCols; icol++) {
+        double* error = m_matrix.data() + icol * m_nRows;
+        if (recomputeCols) {
+            std::copy(error, error + m_nRows, m_restored.data() + m_colAxis.levels[mCol - 1].offset);
+        }
+        const double* activations = restore1D_(m_colAxis, m_colActivations.data() + icol * m_colAxis.activationSize, m_restored.data());
+        backward1D_(m_colAxis, Delta.colptr(icol), activations, error);
+    }
+
+    // Backpropagate resulting rows. The errors on the inputs are not needed.
+    for (unsigned irow = 0; irow < m_nRows; irow++) {
+        for (unsigned icol = 0; icol < m_nCols; icol++) {
+            m_row[icol] = m_matrix[irow + icol * m_nRows];
+        }
+
+        const double* activations = restore1D_(m_rowAxis, m_rowActivations.data() + irow * m_rowAxis.activationSize, m_restored.data());
+        backward1D_(m_rowAxis, m_row.data(), activations, m_rowOut.data());
+    }
+
+    // Combine correlations into the gradient.
+    gradient_(gradient);
+
+    return true;
+}
+
+bool TransformPlan::backward (const arma::Mat<double>& Y, const arma::Mat<double>& Delta, arma::Col<double>& gradient) {
+
+    // Use the stored activations, if applicable.
+    if (!reconstructs()) { return backward(Delta, gradient); }
+
+    PROFILE("TransformPlan::backward");
+
+    // Perform checks.
+    if (!m_hasActivations) {
+        WARNING("No forward pass with the current filter.");
+        return false;
+    }
+
+    if (Y.n_rows != m_nRows || Y.n_cols != m_nCols || Delta.n_rows != m_nRows || Delta.n_cols != m_nCols) {
+        WARNING("Input shapes {%d, %d} and {%d, %d} don't match plan {%d, %d}.", Y.n_rows, Y.n_cols, Delta.n_rows, Delta.n_cols, m_nRows, m_nCols);
+        return false;
+    }
+
+    // Reset correlations.
+    std::fill(m_corrLowpass .begin(), m_corrLowpass .end(), 0.);
+    std::fill(m_corrHighpass.begin(), m_corrHighpass.end(), 0.);
+
+    // Backpropagate columns (in reverse order of the forward transform),
+    // reconstructing the partially transformed matrix from the wavelet
+    // coefficients, and storing the errors on the inputs.
+    for (unsigned icol = 0; icol < m_nCols; icol++) {
+        backwardInvertible1D_(m_colAxis, Delta.colptr(icol), Y.colptr(icol),
+                              m_partial.data() + icol * m_nRows,
+                              m_matrix .data() + icol * m_nRows);
+    }
+
+    // Backpropagate resulting rows, reconstructing the activations from the
+    // rows of the partially transformed matrix. Neither the errors on the
+    // inputs, nor the reconstructed inputs, are needed.
+    for (unsigned irow = 0; irow < m_nRows; irow++) {
+        for (unsigned icol = 0; icol < m_nCols; icol++) {
+            m_row       [icol] = m_matrix [irow + icol * m_nRows];
+            m_partialRow[icol] = m_partial[irow + icol * m_nRows];
+        }
+
+        backwardInvertible1D_(m_rowAxis, m_row.data(), m_partialRow.data(), nullptr, m_rowOut.data());
+    }
+
+    // Combine correlations into the gradient.
+    gradient_(gradient);
+
+    return true;
+}
+
+
+/// Internal planning method(s).
+// -----------------------------------------------------------------------------
+
+TransformPlan::Axis TransformPlan::planAxis_ (const unsigned& length, const unsigned& interval) const {
+
+    Axis axis;
+    axis.length = length;
+
+    // Initialise number of levels and half filter length.
+    const unsigned m = (unsigned) log2(length);
+    const int half = m_filterLength / 2;
+
+    for (unsigned i = 0; i < m; i++) {
+        Level level;
+        level.rows   = 1u << i;
+        level.cols   = 1u << (i + 1);
+        level.mask   = level.cols - 1;
+        level.offset = level.cols - 2; // = 2 + 4 + ... + 2^{i}
+
+        // The inputs to level i are stored if i is a multiple of the interval
+        // below the top level, m - 1.
+        level.stored = (interval != s_none && (m - 1 - i) % interval == 0);
+        level.storedOffset = axis.activationSize;
+        if (level.stored) { axis.activationSize += level.cols; }
+
+        // Row r uses the input indices 2r + N/2 - k, for k in [0, N). These
+        // don't wrap around if 2r + N/2 - (N - 1) >= 0 and 2r + N/2 < cols.
+        const int begin = half / 2;
+        const int end   = ((int) level.cols - 1 - half >= 0 ? ((int) level.cols - 1 - half) / 2 + 1 : 0);
+        level.end   = (unsigned) std::min(end, (int) level.rows);
+        level.begin = (unsigned) std::min(begin, (int) level.end);
+
+        axis.levels.push_back(level);
+    }
+    axis.fullSize = (m > 0 ? 2 * length - 2 : 0);
+
+    return axis;
+}
+
+void TransformPlan::allocateActivations_ () {
+    m_rowActivations.assign(m_nRows * m_rowAxis.activationSize, 0.);
+    m_colActivations.assign(m_nCols * m_colAxis.activationSize, 0.);
+    if (m_rowAxis.activationSize < m_rowAxis.fullSize || m_colAxis.activationSize < m_colAxis.fullSize) {
+        m_restored.assign(std::max(m_rowAxis.fullSize, m_colAxis.fullSize), 0.);
+    }
+    return;
+}
+
+
+/// Internal kernel method(s).
+// -----------------------------------------------------------------------------
+
+void TransformPlan::apply_ (const Level& level, const double* g, const double* in, double* out) const {
+    const unsigned N = m_filterLength;
+    const unsigned half = N / 2;
+    for (unsigned r = 0; r < level.rows; r++) {
+        const unsigned base = half + 2 * r;
+        double sum = 0;
+        if (r >= level.begin && r < level.end) {
+            // Interior rows: contiguous band.
+            const double* p = in + base;
+            for (unsigned k = 0; k < N; k++) { sum += g[k] * *(p - k); }
+        } else {
+            // Edge rows: wrap around.
+            for (unsigned k = 0; k < N; k++) { sum += g[k] * in[(base - k) & level.mask]; }
+        }
+        out[r] = sum;
+    }
+    return;
+}
+
+void TransformPlan::applyTransposed_ (const Level& level, const double* g, const double* in, double* out) const {
+    const unsigned N = m_filterLength;
+    const unsigned half = N / 2;
+    for (unsigned r = 0; r < level.rows; r++) {
+        const unsigned base = half + 2 * r;
+        const double value = in[r];
+        if (r >= level.begin && r < level.end) {
+            double* p = out + base;
+            for (unsigned k = 0; k < N; k++) { *(p - k) += g[k] * value; }
+        } else {
+            for (unsigned k = 0; k < N; k++) { out[(base - k) & level.mask] += g[k] * value; }
+        }
+    }
+    return;
+}
+
+void TransformPlan::correlate_ (const Level& level, const double* delta, const double* in, double* corr) const {
+    const unsigned N = m_filterLength;
+    const unsigned half = N / 2;
+    for (unsigned r = 0; r < level.rows; r++) {
+        const unsigned base = half + 2 * r;
+        const double value = delta[r];
+        if (r >= level.begin && r < level.end) {
+            const double* p = in + base;
+            for (unsigned k = 0; k < N; k++) { corr[k] += value * *(p - k); }
+        } else {
+            for (unsigned k = 0; k < N; k++) { corr[k] += value * in[(base - k) & level.mask]; }
+        }
+    }
+    return;
+}
+
+void TransformPlan::forward1D_ (const Axis& axis, const double* x, double* y, double* activations) {
+
+    const unsigned m = axis.levels.size();
+    if (m == 0) { y[0] = x[0]; return; }
+
+    // Store the input as the highest-level low-pass activations, if requested.
+    const double* current = x;
+    if (activations) {
+        double* top = activations + axis.levels[m - 1].storedOffset;
+        if (x != top) { std::copy(x, x + axis.length, top); }
+        current = top;
+    }
+
+    // Loop levels, from finest to coarsest. The high-pass outputs at level i
+    // are the wavelet coefficients [2^{i}, 2^{i + 1}), and the low-pass
+    // outputs are the inputs to the next level (stored, if requested and the
+    // next level is checkpointed).
+    for (unsigned i = m; i --> 0; ) {
+        const Level& level = axis.levels[i];
+        double* low = (i == 0 ? y : (activations && axis.levels[i - 1].stored ?
+                                     activations + axis.levels[i - 1].storedOffset :
+                                     m_buffer[(m - 1 - i) % 2].data()));
+        apply_(level, m_highpass.data(), current, y + level.rows);
+        apply_(level, m_lowpass .data(), current, low);
+        current = low;
+    }
+
+    return;
+}
+
+const double* TransformPlan::restore1D_ (const Axis& axis, const double* stored, double* full) {
+
+    // All levels are stored: Use the stored activations directly.
+    if (axis.activationSize == axis.fullSize) { return stored; }
+
+    // Loop levels, from finest to coarsest, copying the stored inputs and
+    // recomputing the remaining ones as the low-pass outputs of the level
+    // above.
+    const unsigned m = axis.levels.size();
+    for (unsigned i = m; i --> 0; ) {
+        const Level& level = axis.levels[i];
+        if (level.stored) {
+            std::copy(stored + level.storedOffset, stored + level.storedOffset + level.cols, full + level.offset);
+        } else if (i + 1 < m) {
+            const Level& above = axis.levels[i + 1];
+            apply_(above, m_lowpass.data(), full + above.offset, full + level.offset);
+        }
+    }
+
+    return full;
+}
+
+void TransformPlan::inverse1D_ (const Axis& axis, const double* y, double* x) {
+
+    const unsigned m = axis.levels.size();
+    if (m == 0) { x[0] = y[0]; return; }
+
+    // Loop levels, from coarsest to finest, starting from the "average"
+    // coefficient.
+    const double* current = y;
+    for (unsigned i = 0; i < m; i++) {
+        const Level& level = axis.levels[i];
+        double* out = (i + 1 == m ? x : m_buffer[i % 2].data());
+        std::fill(out, out + level.cols, 0.);
+        applyTransposed_(level, m_lowpass .data(), current, out);
+        applyTransposed_(level, m_highpass.data(), y + level.rows, out);
+        current = out;
+    }
+
+    return;
+}
+
+void TransformPlan::backward1D_ (const Axis& axis, const double* delta, const double* activations, double* error) {
+
+    const unsigned m = axis.levels.size();
+    if (m == 0) { error[0] = delta[0]; return; }
+
+    // Loop levels, from coarsest to finest, starting from the error on the
+    // "average" coefficient.
+    const double* current = delta;
+    for (unsigned i = 0; i < m; i++) {
+        const Level& level = axis.levels[i];
+        const double* deltaHP = delta + level.rows;
+        const double* input   = activations + level.offset;
+
+        // Accumulate the gradient contributions from this level.
+        correlate_(level, current, input, m_corrLowpass .data());
+        correlate_(level, deltaHP, input, m_corrHighpass.data());
+
+        // Propagate errors to the inputs of this level.
+        double* out = (i + 1 == m ? error : m_buffer[i % 2].data());
+        std::fill(out, out + level.cols, 0.);
+        applyTransposed_(level, m_lowpass .data(), current, out);
+        applyTransposed_(level, m_highpass.data(), deltaHP, out);
+        current = out;
+    }
+
+    return;
+}
+
+void TransformPlan::backwardInvertible1D_ (const Axis& axis, const double* delta, const double* y, double* input, double* error) {
+
+    const unsigned m = axis.levels.size();
+    if (m == 0) {
+        error[0] = delta[0];
+        if (input) { input[0] = y[0]; }
+        return;
+    }
+
+    // Loop levels, from coarsest to finest, starting from the error on, and
+    // the value of, the "average" coefficient.
+    const double* current = delta;
+    const double* low     = y;
+    for (unsigned i = 0; i < m; i++) {
+        const Level& level = axis.levels[i];
+        const double* deltaHP = delta + level.rows;
+
+        // Reconstruct the inputs to this level as the inverse transform of
+        // its low- and high-pass outputs.
+        double* rec = (i + 1 == m && input ? input : m_reconstructed[i % 2].data());
+        std::fill(rec, rec + level.cols, 0.);
+        applyTransposed_(level, m_lowpass .data(), low,            rec);
+        applyTransposed_(level, m_highpass.data(), y + level.rows, rec);
+        low = rec;
+
+        // Accumulate the gradient contributions from this level.
+        correlate_(level, current, rec, m_corrLowpass .data());
+        correlate_(level, deltaHP, rec, m_corrHighpass.data());
+
+        // Propagate errors to the inputs of this level.
+        double* out = (i + 1 == m ? error : m_buffer[i % 2].data());
+        std::fill(out, out + level.cols, 0.);
+        applyTransposed_(level, m_lowpass .data(), current, out);
+        applyTransposed_(level, m_highpass.data(), deltaHP, out);
+        current = out;
+    }
+
+    return;
+}
+
+void TransformPlan::gradient_ (arma::Col<double>& gradient) const {
+
+    // Combine correlations into the gradient of the low-pass filter
+    // coefficients. Since b_{j} = (-1)^j a_{N - j - 1}, the high-pass
+    // correlation at j contributes to the gradient for a_{N - j - 1}.
+    const unsigned N = m_filterLength;
+    gradient.set_size(N);
+    for (unsigned k = 0; k < N; k++) {
+        const unsigned j = N - k - 1;
+        gradient(k) = m_corrLowpass[k] + (j % 2 ? -1. : 1.) * m_corrHighpass[j];
+    }
+
+    return;
+}
+
+double TransformPlan::reconstructionError_ (const Axis& axis) {
+
+    if (axis.levels.empty()) { return 0.; }
+
+    // Forward and inverse transform the probe, using the reconstruction
+    // buffers, which are not in use while the filter is set.
+    double* y = m_reconstructed[0].data();
+    double* x = m_reconstructed[1].data();
+    forward1D_(axis, m_probe.data(), y, nullptr);
+    inverse1D_(axis, y, x);
+
+    double error = 0;
+    for (unsigned i = 0; i < axis.length; i++) {
+        const double difference = std::fabs(x[i] - m_probe[i]);
+        if (!std::isfinite(difference)) { return std::numeric_limits<double>::infinity(); }
+        error = std::max(error, difference);
+    }
+    return error;
+}
+
+} // namespace
@@ -1,8 +1,35 @@
 #include "Wavenet/Utilities.h"
 #include "Wavenet/Wavenet.h" /* To create Wavenet instance. */ 
 
+// STL include(s).
+#include <vector> /* std::vector */
+#include <limits> /* std::numeric_limits */
+
 namespace wavenet {
 
+namespace {
+
+    // Returns all filters equivalent to 'filter' under sign flip and time
+    // reversal. (Cyclic shifts are not included, since these don't preserve
+    // the orthonormality of the filter for N >= 6.)
+    std::vector< arma::Col<double> > equivalentFilters (const arma::Col<double>& filter) {
+        const unsigned N = filter.n_elem;
+        std::vector< arma::Col<double> > filters;
+        filters.reserve(4);
+        for (unsigned reverse = 0; reverse < 2; reverse++) {
+            arma::Col<double> variant (N);
+            for (unsigned k = 0; k < N; k++) {
+                variant(k) = filter(reverse ? N - k - 1 : k);
+            }
+            filters.push_back(variant);
+            filters.push_back(-variant);
+        }
+        return filters;
+    }
+
+} // namespace
+
+
 /// Armadillo-specific functions.
 arma::Col<double> PointOnNSphere (const unsigned& N, const double& rho) {
     
@@ -21,6 +48,35 @@ arma::Col<double> PointOnNSphere (const unsigned& N, const double& rho) {
     return coords;
 }
 
+arma::Col<double> CanonicalFilter (const arma::Col<double>& filter, const double& tolerance) {
+
+    // Select the lexicographically largest equivalent filter.
+    arma::Col<double> canonical = filter;
+    for (const arma::Col<double>& variant : equivalentFilters(filter)) {
+        for (unsigned k = 0; k < variant.n_elem; k++) {
+            if (std::fabs(variant(k) - canonical(k)) < tolerance) { continue; }
+            if (variant(k) > canonical(k)) { canonical = variant; }
+            break;
+        }
+    }
+
+    return canonical;
+}
+
+double FilterDistance (const arma::Col<double>& a, const arma::Col<double>& b) {
+
+    // Perform checks.
+    if (a.n_elem != b.n_elem) { return std::numeric_limits<double>::infinity(); }
+
+    // Compute the smallest distance to any filter equivalent to 'b'.
+    double distance = std::numeric_limits<double>::infinity();
+    for (const arma::Col<double>& variant : equivalentFilters(b)) {
+        distance = std::min(distance, arma::norm(a - variant));
+    }
+
+    return distance;
+}
+
 arma::Col<double> coeffsFromActivations (const arma::field< arma::Col<double> >& activations) {
     
     // Initialise number of wavenet layers.
@@ -1,12 +1,40 @@
 #include "Wavenet/Wavenet.h"
 
+// STL include(s).
+#include <thread> /* std::thread */
+#include <atomic> /* std::atomic */
+#include <mutex> /* std::mutex, std::lock_guard */
+#include <limits> /* std::numeric_limits */
+
 namespace wavenet {
 
+namespace {
+
+    // Atomically replace the value by 'f(value)', without locking, and return
+    // the new value.
+    template<class F>
+    inline double atomicUpdate (std::atomic<double>& value, const F& f) {
+        double expected = value.load(std::memory_order_relaxed);
+        double desired  = f(expected);
+        while (!value.compare_exchange_weak(expected, desired, std::memory_order_relaxed)) {
+            desired = f(expected);
+        }
+        return desired;
+    }
+
+} // namespace
+
 /// Set method(s).
 // -----------------------------------------------------------------------------
 
 bool Wavenet::setFilter (const arma::Col<double>& filter) {
 
+    // Copy once, and move the copy into place.
+    return setFilter(arma::Col<double>(filter));
+}
+
+bool Wavenet::setFilter (arma::Col<double>&& filter) {
+
     // Perform checks.
     if (filter.is_empty()) {
         WARNING("Input filter is empty.");
@@ -19,13 +47,11 @@ bool Wavenet::setFilter (const arma::Col<double>& filter) {
     }
 
     // Set wavenet filter coeffients.
-    m_filter = filter;
+    m_filter = std::move(filter);
+    resetFilterState_();
 
     // Add to filter coefficent log.
     m_filterLog.push_back(m_filter);
-
-    // Clear operators cached with the previous filter.
-    clearCachedOperators_();
     
     // If the filter size is changes, resize the momentum vector accordingly.
     if (m_momentum.n_elem != m_filter.n_elem) {
@@ -57,11 +83,11 @@ double Wavenet::lastCost () const  {
         // If the last entry is non-zero, use this.
         if (m_costLog.back() > 0) {
             
-            if (m_batchQueue.size() > 0) {
+            if (!m_batchAccumulator.empty()) {
 
-                // If the batch queue is non-empty, scale the last cost by 
-                // number of entries in the batch queue.
-                return m_costLog.back() / float(m_batchQueue.size());
+                // If the batch is non-empty, scale the last cost by number of
+                // examples in the batch.
+                return m_costLog.back() / float(m_batchAccumulator.count());
 
             } else {
 
@@ -114,14 +140,14 @@ void Wavenet::print () const {
     
     // Batch queue:
     INFO("  batch size : %u", m_batchSize);
-    INFO("  batch queue : %s", (m_batchQueue.size() == 0 ? "(empty)" : ""));
-    for (unsigned j = 0; j < m_batchQueue.size(); j++) {
+    INFO("  batch examples : %u", m_batchAccumulator.count());
+    if (!m_batchAccumulator.empty()) {
         std::string batchString = "";
-        for (unsigned i = 0; i < m_batchQueue.at(j).n_elem; i++) {
+        for (unsigned i = 0; i < m_batchAccumulator.mean().n_elem; i++) {
             if (i > 0) { batchString += ", "; }
-            batchString += std::to_string(m_batchQueue.at(j)(i));
+            batchString += std::to_string(m_batchAccumulator.mean()(i));
         }
-        INFO("         : [%s]", batchString.c_str());
+        INFO("  batch gradient : [%s]", batchString.c_str());
     }
     INFO("- - - - - - - - - - - - - - - - - - - - - - - - - -");
     INFO("");
@@ -135,6 +161,8 @@ void Wavenet::print () const {
 
 void Wavenet::save (Snapshot snap) const {
 
+    PROFILE("Wavenet::save");
+
     DEBUG("Saving snapshot '%s'.", snap.file().c_str());
 
     // Perform checks.
@@ -151,19 +179,24 @@ void Wavenet::save (Snapshot snap) const {
         std::string dir = snap.file().substr(0,snap.file().find_last_of("/"));
         if (!dirExists(dir)) {
             WARNING("Directory '%s' does not exist. Creating it.", dir.c_str());
-            system(("mkdir -p " + dir).c_str());
+            if (!makeDir(dir)) {
+                ERROR("Failed to create directory '%s': %s.", dir.c_str(), strerror(errno));
+                return;
+            }
         }
     }
 
     // Stream the instance to file.
+    const unsigned long long start = Profiler::instance().now();
     snap << *this;
+    m_metrics.addSnapshotWrite(Profiler::instance().now() - start);
 
     return;
 }
 
 void Wavenet::load (Snapshot snap) {
 
-    DEBUG("Loading snapshot '%s'.", snap.file().c_str())
+    DEBUG("Loading snapshot '%s'.", snap.file().c_str());
 
     // Perform checks.
     if (!fileExists(snap.file())) {
@@ -181,7 +214,9 @@ void Wavenet::load (Snapshot snap) {
 /// High-level learning method(s).
 // -----------------------------------------------------------------------------
 
-bool Wavenet::train (arma::Mat<double> X) {
+bool Wavenet::train (const arma::Mat<double>& X) {
+
+    PROFILE("Wavenet::train");
     
     // Impose guard against exections, chiefly from NaN due to diverging
     // solutions.
@@ -191,58 +226,337 @@ bool Wavenet::train (arma::Mat<double> X) {
         const unsigned nRows = size(X, 0); // Number of rows.
         const unsigned nCols = size(X, 1); // Number of columns.
 
-        // Perform forward transform of input X and get activations of all nodes in 
-        // wavenet.
-        Activations2D_t Activations = forward_(X);
+        // Get the transform plan for the shape of the input.
+        if (!preparePlan_(nRows, nCols)) { return false; }
 
-        // Given the complete set of node activations, get the corresponding 
-        // (nRows x nCols) set of wavelet coefficients.
-        arma::Mat<double> Y (size(X)); // Matrix of wavelet coefficients.
-        for (unsigned icol = 0; icol < nCols; icol++) {
-            Y.col(icol) = coeffsFromActivations( Activations.at(1).at(icol) );
-        }
+        // Perform forward transform of input X to get the corresponding 
+        // (nRows x nCols) set of wavelet coefficients. The activations of the
+        // nodes in the wavenet are stored in the plan, according to the 
+        // checkpoint interval.
+        arma::Mat<double> Y; // Matrix of wavelet coefficients.
+        m_plan.forward(X, Y);
+
+        // Register the memory held in activations.
+        m_metrics.setActivationBytes(m_plan.activationBytes());
 
         // Compute the gradient of the sparsity error on the wavelet (NB: not 
         // filter) coefficents corresponding to the input X.
         arma::Mat<double> delta = SparseTermDeriv(Y);
         
         // Given these errors, and the activations from forward transforming the 
-        // input X, perform the complete, 2D backpropagation to get the resulting
-        // error gradient for the filter coefficients.
-        arma::Col<double> gradientSparsity = backpropagate_(delta, Activations);
-        
-        // Compute the gradient of the regularisation error on filter coefficients 
-        // of the wavenet object.
-        arma::Col<double> gradientRegularisation = lambda() * RegTermDeriv(m_filter, m_wavelet);
-        
-        // Compute the combined error on the filter coefficients.
-        arma::Col<double> gradientCombined = gradientSparsity + gradientRegularisation;
+        // input X (stored, or reconstructed from Y), perform the complete, 2D 
+        // backpropagation to get the resulting error gradient for the filter 
+        // coefficients.
+        arma::Col<double> gradientSparsity;
+        m_plan.backward(Y, delta, gradientSparsity);
 
-        // Add current combined (back-propagated sparsity and regularisation) 
-        // gradient to the batch queue.
-        m_batchQueue.push_back(gradientCombined);
+        // Add the gradient, and the cost of the wavelet coefficients Y, to the
+        // batch accumulator and cost log, resp.
+        return accumulateGradient_(gradientSparsity, SparseTerm(Y));
 
-        // Add the combined (sparsity and regularisation) cost of the wavelet 
-        // coefficients Y to the latest entry in the cost log.
-        m_costLog.back() += cost(Y);
+    } catch (const std::exception& e) {
 
-        // If batch queue has reached batch size, flush the queue.
-        if (m_batchQueue.size() >= m_batchSize) { flushBatchQueue_(); }
-        
-        return true;
+        // If an error occured, print it, and count the example as non-finite,
+        // such that the batch is rolled back when flushed (on all ranks, in 
+        // distributed training).
+        ERROR("%s", e.what());
+        WARNING("Most likely due to diverging solution.");
+        arma::Col<double> nan (m_filter.n_elem);
+        nan.fill(std::numeric_limits<double>::quiet_NaN());
+        return accumulateGradient_(nan, std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+bool Wavenet::train (const arma::Cube<double>& X) {
+
+    PROFILE("Wavenet::train");
+    
+    // Impose guard against exections, chiefly from NaN due to diverging
+    // solutions.
+    try {
+
+        // Initialise size variable(s).
+        const unsigned nRows     = X.n_rows;   // Number of rows.
+        const unsigned nCols     = X.n_cols;   // Number of columns.
+        const unsigned nChannels = X.n_slices; // Number of channels.
+
+        // Perform checks.
+        if (nChannels == 0) {
+            WARNING("Multi-channel example has no channels.");
+            return false;
+        }
+
+        // Get the transform plan for the shape of the input, shared by all
+        // channels.
+        if (!preparePlan_(nRows, nCols)) { return false; }
+
+        // Sum of the backpropagated sparsity gradients, and of the sparsity
+        // terms, for all channels.
+        arma::Col<double> gradientSparsity (m_filter.n_elem, arma::fill::zeros);
+        arma::Col<double> gradientChannel;
+        double sparsity = 0;
+
+        if (!m_jointSparsity || nChannels == 1) {
+
+            // Forward and backward transform each channel in turn, such that
+            // the activations stored in the plan are those of the current 
+            // channel.
+            arma::Mat<double> Y;
+            for (unsigned c = 0; c < nChannels; c++) {
+                m_plan.forward(X.slice(c), Y);
+                arma::Mat<double> delta = SparseTermDeriv(Y);
+                m_plan.backward(Y, delta, gradientChannel);
+                gradientSparsity += gradientChannel;
+                sparsity += SparseTerm(Y);
+            }
+
+        } else {
+
+            // Forward transform all channels, and compute the sparsity term
+            // and gradient of the combined wavelet coefficients.
+            arma::Cube<double> Y (nRows, nCols, nChannels);
+            for (unsigned c = 0; c < nChannels; c++) {
+                m_plan.forward(X.slice(c), Y.slice(c));
+            }
+            const arma::Col<double> y (Y.memptr(), Y.n_elem);
+            const arma::Col<double> d = SparseTermDeriv(y);
+            const arma::Cube<double> delta (d.memptr(), nRows, nCols, nChannels);
+            sparsity = SparseTerm(y);
+
+            // Backpropagate each channel, starting from the last, for which 
+            // the activations are still stored in the plan. The remaining 
+            // channels are transformed again, unless the activations are 
+            // reconstructed from the wavelet coefficients.
+            arma::Mat<double> Yc;
+            for (unsigned c = nChannels; c --> 0; ) {
+                if (c + 1 < nChannels && !m_plan.reconstructs()) {
+                    m_plan.forward(X.slice(c), Yc);
+                }
+                m_plan.backward(Y.slice(c), delta.slice(c), gradientChannel);
+                gradientSparsity += gradientChannel;
+            }
+        }
+
+        // Register the memory held in activations.
+        m_metrics.setActivationBytes(m_plan.activationBytes());
+
+        // Add the gradient, and the cost of the wavelet coefficients, to the
+        // batch accumulator and cost log, resp., as a single example.
+        return accumulateGradient_(gradientSparsity, sparsity);
 
     } catch (const std::exception& e) {
 
-        // If an error occured, print it.
+        // If an error occured, print it, and count the example as non-finite,
+        // such that the batch is rolled back when flushed (on all ranks, in 
+        // distributed training).
         ERROR("%s", e.what());
-        ERROR("Most likely due to diverging solution. Try lowering the learning rate (alpha) or the regularisation term (lambda). Exiting.");
+        WARNING("Most likely due to diverging solution.");
+        arma::Col<double> nan (m_filter.n_elem);
+        nan.fill(std::numeric_limits<double>::quiet_NaN());
+        return accumulateGradient_(nan, std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+bool Wavenet::trainAsync (const std::function<bool(arma::Mat<double>&)>& next, const unsigned& numThreads) {
 
+    PROFILE("Wavenet::trainAsync");
+
+    // Perform checks.
+    if (numThreads == 0) {
+        WARNING("Number of threads must be positive.");
+        return false;
     }
-    return false;
+
+    if (m_lattice || m_projection) {
+        WARNING("Asynchronous training doesn't support the lattice parameterisation, or projection.");
+        return false;
+    }
+
+    if (m_filter.n_elem == 0) {
+        WARNING("Filter coefficients not set.");
+        return false;
+    }
+
+    // Initialise the filter coefficients and momentum shared by all workers.
+    const unsigned N = m_filter.n_elem;
+    std::vector< std::atomic<double> > filter (N), momentum (N);
+    for (unsigned k = 0; k < N; k++) {
+        filter  [k].store(m_filter(k));
+        momentum[k].store(m_momentum.n_elem == N ? m_momentum(k) : 0.);
+    }
+
+    // Number of updates applied, and the total staleness of the gradients in
+    // these, i.e. the number of updates applied by other workers between the
+    // snapshot and the update of each worker.
+    const unsigned long long steps = m_costLog.size() - 1;
+    std::atomic<unsigned long long> updates   (0);
+    std::atomic<unsigned long long> staleness (0);
+    std::atomic<bool> failed (false);
+    std::atomic<double> alpha (m_alpha);
+    std::mutex logMutex;
+
+    // State to roll back to if an update diverges.
+    m_goodFilter    = m_filter;
+    m_goodAngles.reset();
+    m_goodOnLattice = false;
+
+    const TransformPlan::Mode mode = (m_invertible ? TransformPlan::Mode::Invertible : TransformPlan::Mode::Train);
+
+    // Roll back the shared filter coefficients and momentum (@see rollback_).
+    // Returns false if training should stop. Called with 'logMutex' locked.
+    auto rollback = [&] (const std::string& reason, const unsigned& discarded) {
+        if (!rollback_(reason, discarded)) { return false; }
+        for (unsigned k = 0; k < N; k++) {
+            filter  [k].store(m_filter(k));
+            momentum[k].store(0.);
+        }
+        alpha.store(m_alpha);
+        return true;
+    };
+
+    // Apply the batch-averaged gradient of a worker to the shared momentum and
+    // filter coefficients, one coefficient at a time, using the effective 
+    // inertia (@see update_), and clear the batch.
+    auto update = [&] (GradientAccumulator& batch, double& cost, const unsigned long long& version) {
+
+        // Check for divergence.
+        if (!batch.mean().is_finite() || !std::isfinite(cost)) {
+            std::lock_guard<std::mutex> lock (logMutex);
+            if (!rollback("Non-finite batch gradient", batch.count())) { failed = true; }
+            cost = 0;
+            batch.clear();
+            return;
+        }
+
+        const unsigned long long step = updates++;
+        const double inertia = (m_inertiaTimeScale > 0. ? m_inertia * (1. - exp( - float(steps + step) / m_inertiaTimeScale )) : m_inertia);
+        const double rate    = alpha.load();
+        for (unsigned k = 0; k < N; k++) {
+            const double g = batch.mean()(k);
+            const double m = atomicUpdate(momentum[k], [&] (const double& v) { return inertia * v - rate * g; });
+            atomicUpdate(filter[k], [&] (const double& v) { return v + m; });
+        }
+        staleness += step - version;
+
+        // Log the cost of the batch, and the filter coefficients after the
+        // update, unless these diverged.
+        {
+            arma::Col<double> updated (N);
+            for (unsigned k = 0; k < N; k++) { updated(k) = filter[k].load(std::memory_order_relaxed); }
+            std::lock_guard<std::mutex> lock (logMutex);
+            if (!updated.is_finite()) {
+                if (!rollback("Non-finite filter coefficients after update", batch.count())) { failed = true; }
+            } else {
+                m_costLog.back() = cost / float(batch.count());
+                m_costLog.push_back(0);
+                m_filterLog.push_back(updated);
+                m_goodFilter   = std::move(updated);
+                m_numRollbacks = 0;
+                m_metrics.addUpdate();
+            }
+        }
+
+        cost = 0;
+        batch.clear();
+        return;
+    };
+
+    auto worker = [&] () {
+        TransformPlan plan;
+        arma::Mat<double> X, Y;
+        arma::Col<double> local (N), gradientSparsity;
+        GradientAccumulator batch;
+        unsigned long long version = 0;
+        double cost = 0;
+
+        while (!failed && next(X)) {
+
+            try {
+                // Get the transform plan for the shape of the input.
+                bool replanned = false;
+                if (!plan.matches({(unsigned) X.n_rows, (unsigned) X.n_cols}, N, mode, m_checkpointInterval)) {
+                    if (!plan.init({(unsigned) X.n_rows, (unsigned) X.n_cols}, N, mode, m_checkpointInterval)) {
+                        ERROR("Could not create transform plan for input of shape {%d, %d}.", X.n_rows, X.n_cols);
+                        failed = true;
+                        break;
+                    }
+                    m_metrics.addCacheRebuild();
+                    replanned = true;
+                }
+
+                // Take a snapshot of the shared filter coefficients at the 
+                // start of each batch, and set it on the plan. Re-planning 
+                // within a batch resets the filter, which is then set again.
+                if (batch.empty()) {
+                    version = updates.load();
+                    for (unsigned k = 0; k < N; k++) { local(k) = filter[k].load(std::memory_order_relaxed); }
+                }
+                if (batch.empty() || replanned) {
+                    plan.setTolerance(m_invertibleTolerance);
+                    plan.setFilter(local);
+                }
+
+                // Accumulate the combined gradient and cost of the example, 
+                // with respect to the snapshot.
+                plan.forward(X, Y);
+                arma::Mat<double> delta = SparseTermDeriv(Y);
+                plan.backward(Y, delta, gradientSparsity);
+                batch.add(gradientSparsity + m_lambda * RegTermDeriv(local, m_wavelet));
+                cost     += SparseTerm(Y)    + m_lambda * RegTerm    (local, m_wavelet);
+
+            } catch (const std::exception& e) {
+
+                // If an error occured, print it, and count the example as 
+                // non-finite, such that the batch is rolled back when applied,
+                // as in synchronous training (@see train).
+                ERROR("%s", e.what());
+                WARNING("Most likely due to diverging solution.");
+                arma::Col<double> nan (N);
+                nan.fill(std::numeric_limits<double>::quiet_NaN());
+                batch.add(nan);
+                cost = std::numeric_limits<double>::quiet_NaN();
+            }
+            m_metrics.addExample();
+
+            if (batch.count() >= m_batchSize) { update(batch, cost, version); }
+        }
+
+        // Use the incomplete batch remaining when the examples run out.
+        if (!failed && !batch.empty()) { update(batch, cost, version); }
+    };
+
+    // Run the workers.
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (unsigned i = 1; i < numThreads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Copy the shared filter coefficients and momentum back. The filter log
+    // already holds the updated filter coefficients.
+    for (unsigned k = 0; k < N; k++) {
+        m_filter(k) = filter[k].load();
+    }
+    m_momentum.set_size(N);
+    for (unsigned k = 0; k < N; k++) {
+        m_momentum(k) = momentum[k].load();
+    }
+    clearCachedOperators_();
+
+    if (updates > 0) {
+        DEBUG("Applied %llu updates, with a mean staleness of %.2f updates.", updates.load(), staleness / double(updates));
+    }
+
+    return !failed;
 }
 
 void Wavenet::clear () {
     scaleMomentum_(0.);
+    resetRollbackState_();
     clearFilterLog();
     clearCostLog();
     clearCachedOperators_();
@@ -323,6 +637,140 @@ std::vector< arma::Mat<double> > Wavenet::costMap (const std::vector< arma::Mat<
 }
 
 
+/// Second-order method(s).
+// -----------------------------------------------------------------------------
+
+bool Wavenet::gradient (const std::vector< arma::Mat<double> >& examples, arma::Col<double>& gradient, double& cost) {
+
+    PROFILE("Wavenet::gradient");
+
+    // Compute the sparsity gradient and term.
+    if (!sparsityGradient_(examples, m_filter, gradient, cost)) { return false; }
+
+    // Add the regularisation gradient and term, consistently with the 
+    // gradient used in training.
+    gradient += lambda() * RegTermDeriv(m_filter, m_wavelet);
+    cost     += 2. * lambda() * RegTerm(m_filter, m_wavelet);
+
+    return true;
+}
+
+bool Wavenet::hessianVectorProduct (const std::vector< arma::Mat<double> >& examples, const arma::Col<double>& v, arma::Col<double>& Hv) {
+
+    PROFILE("Wavenet::hessianVectorProduct");
+
+    // Perform checks.
+    if (v.n_elem != m_filter.n_elem) {
+        WARNING("Vector size (%d) doesn't match the number of filter coefficients (%d).", v.n_elem, m_filter.n_elem);
+        return false;
+    }
+
+    const double vNorm = arma::norm(v);
+    if (vNorm == 0) {
+        Hv.zeros(v.n_elem);
+        return true;
+    }
+
+    // Compute the directional derivative of the sparsity gradient using 
+    // central differences, with a step relative to the scale of the filter 
+    // coefficients.
+    const double epsilon = std::cbrt(std::numeric_limits<double>::epsilon()) * std::max(1., arma::norm(m_filter)) / vNorm;
+    arma::Col<double> gradientPlus, gradientMinus;
+    double sparsity;
+    if (!sparsityGradient_(examples, m_filter + epsilon * v, gradientPlus,  sparsity) ||
+        !sparsityGradient_(examples, m_filter - epsilon * v, gradientMinus, sparsity)) {
+        return false;
+    }
+    Hv = (gradientPlus - gradientMinus) / (2. * epsilon);
+
+    // Add the exact regularisation term.
+    Hv += lambda() * RegTermHessian(m_filter, m_wavelet) * v;
+
+    return true;
+}
+
+bool Wavenet::hessian (const std::vector< arma::Mat<double> >& examples, arma::Mat<double>& H) {
+
+    PROFILE("Wavenet::hessian");
+
+    // Compute the Hessian column by column.
+    const unsigned N = m_filter.n_elem;
+    H.set_size(N, N);
+    arma::Col<double> unit (N, arma::fill::zeros), column;
+    for (unsigned i = 0; i < N; i++) {
+        unit(i) = 1.;
+        if (!hessianVectorProduct(examples, unit, column)) { return false; }
+        H.col(i) = column;
+        unit(i) = 0.;
+    }
+
+    // Symmetrise, to remove the asymmetric part of the truncation and 
+    // rounding errors.
+    H = (H + H.t()) / 2.;
+
+    return true;
+}
+
+bool Wavenet::curvature (const std::vector< arma::Mat<double> >& examples, const arma::Col<double>& v, double& curvature) {
+
+    arma::Col<double> Hv;
+    if (!hessianVectorProduct(examples, v, Hv)) { return false; }
+
+    const double vv = arma::dot(v, v);
+    curvature = (vv > 0 ? arma::dot(v, Hv) / vv : 0.);
+
+    return true;
+}
+
+bool Wavenet::newtonStep (const std::vector< arma::Mat<double> >& examples, const double& damping) {
+
+    PROFILE("Wavenet::newtonStep");
+
+    // Compute the gradient and Hessian at the current filter coefficients.
+    arma::Col<double> g;
+    arma::Mat<double> H;
+    double cost;
+    if (!gradient(examples, g, cost) || !hessian(examples, H)) { return false; }
+
+    // Decompose the Hessian.
+    arma::Col<double> eigval;
+    arma::Mat<double> eigvec;
+    if (!arma::eig_sym(eigval, eigvec, H)) {
+        WARNING("Could not decompose the Hessian.");
+        return false;
+    }
+
+    // Shift the Hessian to be positive definite, and try damped Newton steps,
+    // increasing the damping until the cost decreases.
+    double mu = std::max(damping, damping - eigval.min());
+    const arma::Col<double> gProjected = eigvec.t() * g;
+    for (unsigned attempt = 0; attempt < 10; attempt++, mu *= 10.) {
+        const arma::Col<double> filter = m_filter - eigvec * (gProjected / (eigval + mu));
+
+        arma::Col<double> gradientSparsity;
+        double trialCost;
+        if (!sparsityGradient_(examples, filter, gradientSparsity, trialCost)) { return false; }
+        trialCost += 2. * lambda() * RegTerm(filter, m_wavelet);
+
+        if (std::isfinite(trialCost) && trialCost < cost) {
+            DEBUG("Newton step with damping %.2e decreased the cost from %f to %f.", mu, cost, trialCost);
+
+            // Log the cost at the filter coefficients before the step, as in 
+            // training (@see accumulateGradient_), ahead of the entry of the
+            // current batch, such that the cost log stays aligned with the 
+            // filter log.
+            m_costLog.insert(m_costLog.end() - 1, cost - lambda() * RegTerm(m_filter, m_wavelet));
+            setFilter(filter);
+            m_momentum.zeros();
+            return true;
+        }
+    }
+
+    DEBUG("No damped Newton step decreased the cost.");
+    return false;
+}
+
+
 /// Basis function method(s).
 // -----------------------------------------------------------------------------
 
@@ -415,22 +863,22 @@ Activations1D_t Wavenet::forward_ (const arma::Col<double>& x) {
      *   (m, 1) = High-pass coeffs. at level m
      */
     
-    // Make a mutable copy of the input, position space vector, to be forward 
-    // transformed.
-    arma::Col<double> x_current = x;
+    // Point to the input, position space vector, to be forward transformed.
+    // The intermediate vectors are referenced in place, rather than copied.
+    const arma::Col<double>* x_current = &x;
 
     // Loop wavenet layers.
     for (unsigned i = m; i --> 0; ) {
 
         // Store low-pass filter activations.
-        activations(i, 0) = lowpassfilter_ (x_current);
+        activations(i, 0) = lowpassfilter_ (*x_current);
 
         // Store high-pass filter activations.
-        activations(i, 1) = highpassfilter_(x_current);
+        activations(i, 1) = highpassfilter_(*x_current);
 
         // Update vector as the low-pass filtered version, and proceed to the 
         // next level.
-        x_current = activations(i, 0);
+        x_current = &activations(i, 0);
     }
 
     // Add highest-level low-pass activations: the original position space
@@ -471,7 +919,7 @@ arma::Col<double> Wavenet::inverse_ (const arma::Col<double>& y) {
     return x;
 }
 
-std::vector< arma::Col<double> > Wavenet::backpropagate_ (const arma::Col<double>& delta, Activations1D_t activations) {
+std::vector< arma::Col<double> > Wavenet::backpropagate_ (const arma::Col<double>& delta, const Activations1D_t& activations) {
 
     // Initialise size variable(s).
     const unsigned N = m_filter.n_elem; // Number of filter coefficients.
@@ -488,7 +936,6 @@ std::vector< arma::Col<double> > Wavenet::backpropagate_ (const arma::Col<double
     arma::Col<double> delta_HP (1); // Error on current high-pass nodes.
     arma::Col<double> delta_new_LP; // Error on next layer's low-pass nodes.
     arma::Col<double> delta_new_HP; // Error on next layer's high-pass nodes.
-    arma::Col<double> activ_LP;     // Activations of current low-pass nodes.
 
     // Initialise the error on the last low-pass node as the error on the 
     // lowest-scale wavelet coefficient.
@@ -509,7 +956,7 @@ std::vector< arma::Col<double> > Wavenet::backpropagate_ (const arma::Col<double
     for (unsigned i = 0; i < m; i++) {
         
         // Get activations at current layer.
-        activ_LP = activations(i + 1, 0);
+        const arma::Col<double>& activ_LP = activations(i + 1, 0);
 
         // Compute error on low-pass matrix operator.
         error_LP = outerProduct(delta_LP, activ_LP);
@@ -549,8 +996,8 @@ std::vector< arma::Col<double> > Wavenet::backpropagate_ (const arma::Col<double
 
     // Store (1) erorrs on filter coefficients and (2) "errors on input", for 
     // use in 2D backprogation.
-    output.at(0) = gradient;
-    output.at(1) = delta_LP;
+    output.at(0) = std::move(gradient);
+    output.at(1) = std::move(delta_LP);
 
     return output;
 }
@@ -560,6 +1007,8 @@ std::vector< arma::Col<double> > Wavenet::backpropagate_ (const arma::Col<double
 // -----------------------------------------------------------------------------
 
 Activations2D_t Wavenet::forward_ (const arma::Mat<double>& X) {
+
+    PROFILE("Wavenet::forward_");
     
     // Initialise size variable(s).
     const unsigned nRows = size(X,0); // Number of rows.
@@ -622,6 +1071,8 @@ Activations2D_t Wavenet::forward_ (const arma::Mat<double>& X) {
 }
 
 arma::Mat<double> Wavenet::inverse_ (const arma::Mat<double>& Y) {
+
+    PROFILE("Wavenet::inverse_");
     
     // Initialise size variable(s).
     const unsigned nRows = size(Y, 0); // Number of rows.
@@ -662,7 +1113,9 @@ arma::Mat<double> Wavenet::inverse_ (const arma::Mat<double>& Y) {
     return X;
 }
 
-arma::Col<double> Wavenet::backpropagate_ (const arma::Mat<double>& Delta, Activations2D_t Activations) {
+arma::Col<double> Wavenet::backpropagate_ (const arma::Mat<double>& Delta, const Activations2D_t& Activations) {
+
+    PROFILE("Wavenet::backpropagate_");
 
     // Initialise size variable(s).
     const unsigned nRows = Activations.at(0).size(); // Number of rows;
@@ -714,29 +1167,237 @@ arma::Col<double> Wavenet::backpropagate_ (const arma::Mat<double>& Delta, Activ
 /// Low-level learnings method(s).
 // -----------------------------------------------------------------------------
 
-void Wavenet::flushBatchQueue_ () {
+bool Wavenet::sparsityGradient_ (const std::vector< arma::Mat<double> >& examples, const arma::Col<double>& filter,
+                                 arma::Col<double>& gradient, double& sparsity) {
+
+    // Perform checks.
+    if (examples.empty()) {
+        WARNING("No examples given.");
+        return false;
+    }
+
+    if (m_lattice || m_projection) {
+        WARNING("Second-order methods don't support the lattice parameterisation, or projection.");
+        return false;
+    }
+
+    if (filter.n_elem == 0) {
+        WARNING("Filter coefficients not set.");
+        return false;
+    }
+
+    // Accumulate the back-propagated sparsity gradient and the sparsity term
+    // of each example.
+    const unsigned N = filter.n_elem;
+    gradient.zeros(N);
+    sparsity = 0;
+    arma::Mat<double> Y;
+    arma::Col<double> gradientSparsity;
+    try {
+        for (const arma::Mat<double>& X : examples) {
+            const std::vector<unsigned> shape = {(unsigned) X.n_rows, (unsigned) X.n_cols};
+            if (!m_curvaturePlan.matches(shape, N, TransformPlan::Mode::Train, m_checkpointInterval)) {
+                if (!m_curvaturePlan.init(shape, N, TransformPlan::Mode::Train, m_checkpointInterval)) {
+                    ERROR("Could not create transform plan for input of shape {%d, %d}.", X.n_rows, X.n_cols);
+                    return false;
+                }
+            }
+            m_curvaturePlan.setFilter(filter);
+            m_curvaturePlan.forward(X, Y);
+            arma::Mat<double> delta = SparseTermDeriv(Y);
+            m_curvaturePlan.backward(Y, delta, gradientSparsity);
+            gradient += gradientSparsity;
+            sparsity += SparseTerm(Y);
+        }
+    } catch (const std::exception& e) {
+        ERROR("%s", e.what());
+        return false;
+    }
+
+    // Average over the examples.
+    gradient /= double(examples.size());
+    sparsity /= double(examples.size());
+
+    return true;
+}
+
+bool Wavenet::preparePlan_ (const unsigned& nRows, const unsigned& nCols) {
+
+    // Project the filter coefficients onto the lattice, if necessary.
+    if (m_lattice && m_filter.n_elem >= 2 && !m_onLattice) {
+        setAngles_(LatticeAngles(m_filter));
+    }
+
+    // Project the filter coefficients onto the set of valid wavelets, if
+    // necessary.
+    if (m_projection && !m_projected && m_filter.n_elem > 0) {
+        arma::Col<double> filter = m_filter;
+        projectFilter_(filter);
+        setFilter(std::move(filter));
+        m_projected = true;
+    }
+
+    // Get the transform plan for the shape of the input. Since the input
+    // shape is usually fixed, the plan is only created once per run.
+    const TransformPlan::Mode mode = (m_invertible ? TransformPlan::Mode::Invertible : TransformPlan::Mode::Train);
+    if (!m_plan.matches({nRows, nCols}, m_filter.n_elem, mode, m_checkpointInterval)) {
+        if (!m_plan.init({nRows, nCols}, m_filter.n_elem, mode, m_checkpointInterval)) {
+            ERROR("Could not create transform plan for input of shape {%d, %d}.", nRows, nCols);
+            return false;
+        }
+        m_metrics.addCacheRebuild();
+    } else {
+        m_metrics.addCacheHit();
+    }
+    m_plan.setTolerance(m_invertibleTolerance);
+    m_plan.setFilter(m_filter);
+
+    return true;
+}
+
+bool Wavenet::accumulateGradient_ (const arma::Col<double>& gradientSparsity, const double& sparsity) {
+
+    // With the lattice parameterisation, or projection, the wavelet conditions
+    // are satisfied identically, such that the regularisation term vanishes.
+    if (m_lattice || m_projection) {
+        m_batchAccumulator.add(gradientSparsity);
+        m_costLog.back() += sparsity;
+    } else {
+
+        // Compute the gradient of the regularisation error on filter 
+        // coefficients of the wavenet object.
+        arma::Col<double> gradientRegularisation = lambda() * RegTermDeriv(m_filter, m_wavelet);
+        
+        // Compute the combined error on the filter coefficients.
+        arma::Col<double> gradientCombined = gradientSparsity + gradientRegularisation;
+
+        // Add current combined (back-propagated sparsity and regularisation) 
+        // gradient to the batch accumulator.
+        m_batchAccumulator.add(gradientCombined);
+
+        // Add the combined (sparsity and regularisation) cost to the latest 
+        // entry in the cost log.
+        m_costLog.back() += sparsity + lambda() * RegTerm(m_filter, m_wavelet);
+    }
+
+    // Count the example.
+    m_metrics.addExample();
+
+    // If the batch has reached batch size, flush it.
+    if (m_batchAccumulator.count() >= m_batchSize) { return flushBatch_(); }
+
+    return true;
+}
+
+bool Wavenet::flushBatch_ () {
+
+    PROFILE("Wavenet::flushBatch_");
 
     // If batch is empty, do nothing.
-    if (!m_batchQueue.size()) { return; }
+    if (m_batchAccumulator.empty()) { return true; }
+
+    // Get the batch-summed gradient, and the sum of squared deviations.
+    arma::Col<double> gradient = m_batchAccumulator.sum();
+    arma::Col<double> m2       = m_batchAccumulator.m2();
+    double cost  = m_costLog.back();
+    double count = m_batchAccumulator.count();
+
+    // In distributed training, sum the gradients, costs, and number of 
+    // examples over the batches of all ranks, such that all ranks apply the
+    // same update. The squared deviations are combined through the sums of 
+    // squares about zero, since the batch means differ between ranks.
+    if (m_communicator && m_communicator->size() > 1) {
+        const unsigned N = gradient.n_elem;
+        arma::Col<double> buffer (2 * N + 2);
+        buffer.head(N)            = gradient;
+        buffer.subvec(N, 2*N - 1) = m_batchAccumulator.squares();
+        buffer(2 * N)             = cost;
+        buffer(2 * N + 1)         = count;
+        if (m_communicator->allReduce(buffer)) {
+            gradient = buffer.head(N);
+            cost     = buffer(2 * N);
+            count    = buffer(2 * N + 1);
+            m2       = GradientAccumulator::deviations(count, gradient, buffer.subvec(N, 2*N - 1));
+        } else {
+            // The ranks can no longer apply the same update, so discard the
+            // batch and stop. The communicator is closed on failure, such that
+            // the other ranks fail their next collective call, too.
+            ERROR("Failed to all-reduce the batch gradient. Stopping.");
+            m_batchAccumulator.clear();
+            m_costLog.back() = 0;
+            return false;
+        }
+    }
 
-    // Compute batch-averaged gradient.
-    arma::Col<double> gradient (size(m_filter), arma::fill::zeros);
-    for (unsigned i = 0; i < m_batchQueue.size(); i++) {
-        gradient += m_batchQueue.at(i);
+    // Check for divergence. Since the sums are combined before the check, all
+    // ranks roll back together in distributed training.
+    if (!gradient.is_finite() || !std::isfinite(cost)) {
+        return rollback_("Non-finite batch gradient", m_batchAccumulator.count());
     }
-    gradient /= float(m_batchQueue.size());
-    
-    // Update with batch-averaged gradient.
+
+    // Update with batch-averaged gradient, keeping the current state, to roll 
+    // back to if this, or the following, update diverges.
+    gradient /= count;
+    m_goodFilter    = m_filter;
+    m_goodAngles    = m_angles;
+    m_goodOnLattice = m_onLattice;
     this->update_(gradient);
+    if (!m_filter.is_finite() || !m_momentum.is_finite()) {
+        m_filterLog.pop_back();
+        return rollback_("Non-finite filter coefficients after update", m_batchAccumulator.count());
+    }
+    m_numRollbacks = 0;
+    m_metrics.addUpdate();
+
+    // Store the statistics of the batch.
+    m_batchCount    = (unsigned) count;
+    if (count > 1) { m_batchVariance = m2 / (count - 1.); }
+    else           { m_batchVariance.zeros(gradient.n_elem); }
+    m_batchGradient = std::move(gradient);
 
     // Update cost log.
-    m_costLog.back() /= float(m_batchQueue.size());
+    m_costLog.back() = cost / count;
     m_costLog.push_back(0);
     
-    // Clear batch queue.
-    m_batchQueue.clear();
+    // Clear batch accumulator.
+    m_batchAccumulator.clear();
     
-    return;
+    return true;
+}
+
+bool Wavenet::rollback_ (const std::string& reason, const unsigned& discarded) {
+
+    // Discard the current batch.
+    m_metrics.addRollback(discarded);
+    m_batchAccumulator.clear();
+    m_costLog.back() = 0;
+
+    // Give up after too many consecutive roll-backs.
+    if (++m_numRollbacks > m_maxRollbacks) {
+        ERROR("%s, after %d consecutive roll-back(s).", reason.c_str(), m_maxRollbacks);
+        ERROR("Try lowering the learning rate (alpha) or the regularisation term (lambda). Exiting.");
+        return false;
+    }
+
+    WARNING("%s. Rolling back, and reducing the learning rate (alpha) from %f to %f.", reason.c_str(), m_alpha, m_alpha * m_rollbackFactor);
+
+    // Restore the state before the last update, if any, and reset the 
+    // momentum, which carried the diverging steps (and may itself be 
+    // non-finite).
+    // The filter coefficients are restored without being added to the filter
+    // log, such that it stays aligned with the cost log, which only receives 
+    // entries for successful updates.
+    if (m_goodFilter.n_elem > 0) {
+        m_filter    = m_goodFilter;
+        m_angles    = m_goodAngles;
+        m_onLattice = m_goodOnLattice;
+        clearCachedOperators_();
+    }
+    m_momentum     .zeros();
+    m_angleMomentum.zeros();
+    m_alpha *= m_rollbackFactor;
+
+    return true;
 }
 
 void Wavenet::addMomentum_ (const arma::Col<double>& gradient) {
@@ -746,7 +1407,40 @@ void Wavenet::addMomentum_ (const arma::Col<double>& gradient) {
 }
 
 void Wavenet::scaleMomentum_ (const double& factor) {
-    m_momentum = m_momentum * factor;
+    m_momentum      *= factor;
+    m_angleMomentum *= factor;
+    return;
+}
+
+void Wavenet::projectFilter_ (arma::Col<double>& filter) const {
+    if (!ProjectFilter(filter, m_wavelet)) {
+        WARNING("Projection of %d filter coefficients onto the set of valid wavelets did not converge. Using the last iterate.", filter.n_elem);
+    }
+    return;
+}
+
+void Wavenet::setAngles_ (arma::Col<double>&& angles) {
+    // Setting the filter coefficients resets the angles, so these are set 
+    // afterwards.
+    setFilter(LatticeFilter(angles));
+    m_angles = std::move(angles);
+    m_onLattice = true;
+    return;
+}
+
+void Wavenet::resetFilterState_ () {
+    m_angles.reset();
+    m_onLattice = false;
+    m_projected = false;
+    clearCachedOperators_();
+    return;
+}
+
+void Wavenet::resetRollbackState_ () {
+    m_numRollbacks = 0;
+    m_goodFilter.reset();
+    m_goodAngles.reset();
+    m_goodOnLattice = false;
     return;
 }
 
@@ -756,15 +1450,46 @@ void Wavenet::update_ (const arma::Col<double>& gradient) {
     const unsigned steps = m_costLog.size() - 1;
     double effectiveInertita = (m_inertiaTimeScale > 0. ? m_inertia * (1. - exp( - float(steps) / m_inertiaTimeScale )) : m_inertia);
     
+    // With the lattice parameterisation, update the lattice angles, using the 
+    // gradient mapped onto these, and set the corresponding filter 
+    // coefficients.
+    if (m_lattice) {
+        if (!m_onLattice) {
+            setAngles_(LatticeAngles(m_filter));
+        }
+        if (m_angleMomentum.n_elem != m_angles.n_elem) {
+            m_angleMomentum.zeros(size(m_angles));
+        }
+        m_angleMomentum *= effectiveInertita;
+        m_angleMomentum -= m_alpha * LatticeGradient(m_angles, gradient);
+        arma::Col<double> angles = m_angles + m_angleMomentum;
+        setAngles_( std::move(angles) );
+        return;
+    }
+
     // Update.
     scaleMomentum_( effectiveInertita ); 
     addMomentum_( - m_alpha * gradient);
-    setFilter( m_filter + m_momentum );
+    arma::Col<double> filter = m_filter + m_momentum;
+
+    // Project the updated filter coefficients onto the set of valid wavelets, 
+    // and use the projected step as momentum.
+    if (m_projection) {
+        projectFilter_(filter);
+        m_momentum = filter - m_filter;
+        setFilter( std::move(filter) );
+        m_projected = true;
+        return;
+    }
+
+    setFilter( std::move(filter) );
 
     return;
 }
 
 void Wavenet::cacheOperators_ (const unsigned& m) {
+
+    PROFILE("Wavenet::cacheOperators_");
     
     // Clear existing cache.
     clearCachedOperators_();
@@ -781,6 +1506,7 @@ void Wavenet::cacheOperators_ (const unsigned& m) {
 
     // Switch flag.
     m_hasCachedOperators = true;
+    m_metrics.addCacheRebuild();
 
     return;
 }
@@ -798,6 +1524,8 @@ void Wavenet::clearCachedOperators_ () {
 }
 
 void Wavenet::cacheWeights_ (const unsigned& m) {
+
+    PROFILE("Wavenet::cacheWeights_");
     
     DEBUG("Caching matrix weights (%d).", m);
     
@@ -856,7 +1584,7 @@ arma::Col<double> Wavenet::lowpassfilter_ (const arma::Col<double>& x) {
     const unsigned m = log2(x.n_elem);
 
     // Make sure that operators are cached at least up to level m.
-    if (!m_hasCachedOperators || size(m_cachedLowpassOperators, 0) < m) { cacheOperators_(m); }
+    if (!m_hasCachedOperators || size(m_cachedLowpassOperators, 0) < m) { cacheOperators_(m); } else { m_metrics.addCacheHit(); }
 
     // Apply low-pass filter using cached operator.
     return m_cachedLowpassOperators(m - 1, 0) * x;
@@ -868,7 +1596,7 @@ arma::Col<double> Wavenet::highpassfilter_ (const arma::Col<double>& x) {
     const unsigned m = log2(x.n_elem);
     
     // Make sure that operators are cached at least up to level m.
-    if (!m_hasCachedOperators || size(m_cachedHighpassOperators, 0) < m) { cacheOperators_(m); }
+    if (!m_hasCachedOperators || size(m_cachedHighpassOperators, 0) < m) { cacheOperators_(m); } else { m_metrics.addCacheHit(); }
 
     // Apply high-pass filter using cached operator.
     return m_cachedHighpassOperators(m - 1, 0) * x;
@@ -880,7 +1608,7 @@ arma::Col<double> Wavenet::inv_lowpassfilter_ (const arma::Col<double>& y) {
     const unsigned m = log2(y.n_elem);
     
     // Make sure that operators are cached at least up to level m.
-    if (!m_hasCachedOperators || size(m_cachedLowpassOperators, 0) <= m) { cacheOperators_(m); }
+    if (!m_hasCachedOperators || size(m_cachedLowpassOperators, 0) <= m) { cacheOperators_(m); } else { m_metrics.addCacheHit(); }
     
     // Apply inverse low-pass filter using cached operator.
     return m_cachedLowpassOperators(m, 0).t() * y;
@@ -892,7 +1620,7 @@ arma::Col<double> Wavenet::inv_highpassfilter_ (const arma::Col<double>& y) {
     const unsigned m = log2(y.n_elem);
     
     // Make sure that operators are cached at least up to level m.
-    if (!m_hasCachedOperators || size(m_cachedHighpassOperators, 0) <= m) { cacheOperators_(m); }
+    if (!m_hasCachedOperators || size(m_cachedHighpassOperators, 0) <= m) { cacheOperators_(m); } else { m_metrics.addCacheHit(); }
     
     // Apply inverse high-pass filter using cached operator.
     return m_cachedHighpassOperators(m, 0).t() * y;
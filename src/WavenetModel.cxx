@@ -0,0 +1,112 @@
+#include "Wavenet/WavenetModel.h"
+
+// STL include(s).
+#include <algorithm> /* std::max */
+
+namespace wavenet {
+
+bool WavenetModel::supports (const unsigned& nRows, const unsigned& nCols) const {
+    return m_valid &&
+        isRadix2(nRows) && nRows <= maxSize() &&
+        isRadix2(nCols) && nCols <= maxSize();
+}
+
+arma::Mat<double> WavenetModel::transform (const arma::Mat<double>& X) const {
+
+    // Plan the transform for the shape of the input.
+    TransformPlan plan;
+    if (!plan_(X.n_rows, X.n_cols, plan)) { return arma::Mat<double>(); }
+
+    // Forward transform rows and columns.
+    arma::Mat<double> Y;
+    if (!plan.forward(X, Y)) { return arma::Mat<double>(); }
+
+    return Y;
+}
+
+arma::Mat<double> WavenetModel::inverse (const arma::Mat<double>& Y) const {
+
+    // Plan the transform for the shape of the input.
+    TransformPlan plan;
+    if (!plan_(Y.n_rows, Y.n_cols, plan)) { return arma::Mat<double>(); }
+
+    // Inverse transform columns and rows.
+    arma::Mat<double> X;
+    if (!plan.inverse(Y, X)) { return arma::Mat<double>(); }
+
+    return X;
+}
+
+arma::Mat<double> WavenetModel::compress (const arma::Mat<double>& X, const unsigned& nCoeffs) const {
+
+    // Plan the transform for the shape of the input, shared by the forward
+    // and inverse transforms.
+    TransformPlan plan;
+    if (!plan_(X.n_rows, X.n_cols, plan)) { return arma::Mat<double>(); }
+
+    // Forward transform.
+    arma::Mat<double> Y;
+    if (!plan.forward(X, Y)) { return arma::Mat<double>(); }
+
+    // Zero all but the 'nCoeffs' coefficients with the largest magnitude.
+    if (nCoeffs < Y.n_elem) {
+        const arma::uvec indices = arma::sort_index(arma::abs(arma::vectorise(Y)), "descend");
+        for (unsigned i = nCoeffs; i < indices.n_elem; i++) {
+            Y(indices(i)) = 0;
+        }
+    }
+
+    // Inverse transform.
+    arma::Mat<double> Xc;
+    if (!plan.inverse(Y, Xc)) { return arma::Mat<double>(); }
+
+    return Xc;
+}
+
+bool WavenetModel::init_ (const arma::Col<double>& filter, const std::vector<unsigned>& shape) {
+
+    // Reset configuration.
+    m_valid = false;
+
+    // Perform checks.
+    if (filter.n_elem == 0 || filter.n_elem % 2 != 0) {
+        WARNING("Number of filter coefficients (%d) is not a positive multiple of 2.", filter.n_elem);
+        return false;
+    }
+
+    if (shape.size() < 1 || shape.size() > 2) {
+        WARNING("Only one- and two-dimensional shapes are supported.");
+        return false;
+    }
+
+    unsigned maxSize = 1;
+    for (const unsigned& size : shape) {
+        if (!isRadix2(size)) {
+            WARNING("Requested size %d is not radix 2.", size);
+            return false;
+        }
+        maxSize = std::max(maxSize, size);
+    }
+
+    // Freeze filter coefficients.
+    m_filter   = filter;
+    m_maxLevel = log2(maxSize);
+
+    m_valid = true;
+    return true;
+}
+
+bool WavenetModel::plan_ (const unsigned& nRows, const unsigned& nCols, TransformPlan& plan) const {
+
+    // Perform checks.
+    if (!supports(nRows, nCols)) {
+        WARNING("Input of shape {%d, %d} is not supported by the model (max. size: %d).", nRows, nCols, (m_valid ? maxSize() : 0));
+        return false;
+    }
+
+    // Plan the transform, without storing activations.
+    if (!plan.init({nRows, nCols}, m_filter.n_elem, TransformPlan::Mode::Transform)) { return false; }
+    return plan.setFilter(m_filter);
+}
+
+} // namespace
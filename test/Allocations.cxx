@@ -0,0 +1,167 @@
+/**
+ * @file   Allocations.cxx
+ * @brief  Test of the number of heap allocations per training step.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <cstdlib> /* size_t */
+#include <cerrno> /* ENOMEM, EINVAL */
+#include <atomic> /* std::atomic */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h" /* FCTINFO, wavenet::Logger */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+
+// Test include(s).
+#include "Test.h"
+
+/**
+ * Allocation count test.
+ *
+ * Counts the number of heap allocations, and the number of bytes allocated, in
+ * each call to Wavenet::train, for a range of input shapes and batch sizes,
+ * after a number of warm-up steps in which the transform plan and the cached
+ * operators are created. Allocations are counted by interposing the C
+ * allocation functions, through which both operator new and Armadillo
+ * allocate, and are only available with glibc. Since the allocation functions
+ * are called from all threads, including the log writer, the counters are
+ * atomic. The test fails if any case exceeds s_maxAllocations per step.
+ */
+
+
+/// Allocation counting.
+namespace {
+    std::atomic<bool>               g_counting    (false);
+    std::atomic<unsigned long long> g_allocations (0);
+    std::atomic<unsigned long long> g_bytes       (0);
+
+    inline void count (const size_t& size) {
+        if (g_counting.load(std::memory_order_relaxed)) {
+            g_allocations.fetch_add(1,    std::memory_order_relaxed);
+            g_bytes      .fetch_add(size, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    // Maximal number of allocations per training step. The training step only
+    // allocates a few matrices of wavelet coefficients and their gradients
+    // (vectors of at most 16 filter coefficients use Armadillo's local 
+    // storage), such that any per-example or per-row copy of the input in the
+    // larger cases exceeds this.
+    const unsigned long long s_maxAllocations = 32;
+}
+
+#ifdef __GLIBC__
+extern "C" {
+    void* __libc_malloc   (size_t size);
+    void* __libc_calloc   (size_t num, size_t size);
+    void* __libc_realloc  (void* ptr, size_t size);
+    void* __libc_memalign (size_t alignment, size_t size);
+    void  __libc_free     (void* ptr);
+
+    void* malloc (size_t size) {
+        count(size);
+        return __libc_malloc(size);
+    }
+
+    void* calloc (size_t num, size_t size) {
+        count(num * size);
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc (void* ptr, size_t size) {
+        count(size);
+        return __libc_realloc(ptr, size);
+    }
+
+    int posix_memalign (void** ptr, size_t alignment, size_t size) {
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) { return EINVAL; }
+        count(size);
+        *ptr = __libc_memalign(alignment, size);
+        return (*ptr ? 0 : ENOMEM);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size) {
+        count(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    void free (void* ptr) {
+        __libc_free(ptr);
+        return;
+    }
+}
+#endif
+
+
+/// Test configuration(s).
+struct Case {
+    std::vector<unsigned> shape;
+    unsigned batchSize;
+};
+
+
+// The number of allocations per training step doesn't exceed the maximum, for
+// any shape or batch size.
+void trainingAllocations () {
+
+#ifndef __GLIBC__
+    FCTINFO("Allocation counting requires glibc. Skipping.");
+    return;
+#endif
+
+    // Define cases.
+    const std::vector<Case> cases = {
+        {{ 16,  1},  1},
+        {{ 64,  1},  1},
+        {{ 64,  1}, 10},
+        {{ 16, 16},  1},
+        {{ 64, 64},  1},
+        {{ 64, 64}, 10},
+    };
+    const unsigned numCoeffs = 4;
+    const unsigned warmup    = 3;
+    const unsigned steps     = 20;
+
+    // Run cases.
+    arma::arma_rng::set_seed(1);
+    for (const Case& c : cases) {
+
+        // Configure wavenet.
+        wavenet::Wavenet wn (10.);
+        wn.setBatchSize(c.batchSize);
+        wn.setFilter(arma::Col<double>(numCoeffs, arma::fill::randn));
+
+        arma::Mat<double> X (c.shape[0], c.shape[1], arma::fill::randn);
+
+        // Warm up, creating the plan and the cached operators.
+        for (unsigned i = 0; i < warmup * c.batchSize; i++) { wn.train(X); }
+
+        // Count allocations in the timed steps. The log writer is flushed 
+        // first, such that it doesn't allocate while writing earlier output.
+        wavenet::Logger::flush();
+        g_allocations.store(0);
+        g_bytes      .store(0);
+        g_counting   .store(true);
+        for (unsigned i = 0; i < steps; i++) { wn.train(X); }
+        g_counting   .store(false);
+
+        const double allocations = double(g_allocations.load()) / steps;
+        const double bytes       = double(g_bytes      .load()) / steps;
+        FCTINFO("shape: %3u x %-3u  batch: %2u  %8.1f allocations/step  %10.0f bytes/step",
+                c.shape[0], c.shape[1], c.batchSize, allocations, bytes);
+        CHECK(allocations <= s_maxAllocations);
+    }
+    return;
+}
+TEST(trainingAllocations);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file   Communicator.cxx
+ * @brief  Correctness tests of the collective communication between processes.
+ */
+
+// STL include(s).
+#include <string> /* std::string, std::to_string */
+#include <vector> /* std::vector */
+#include <functional> /* std::function */
+
+// POSIX include(s).
+#include <unistd.h> /* fork, getpid, _exit */
+#include <sys/wait.h> /* waitpid */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Communicator.h" /* wavenet::Communicator */
+#include "Wavenet/Logger.h" /* wavenet::Logger */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Unix domain socket addresses of a ring of the given size, unique to this
+// process and test.
+std::vector<std::string> addresses (const unsigned& size, const std::string& name) {
+    std::vector<std::string> result;
+    for (unsigned i = 0; i < size; i++) {
+        result.push_back("unix:/tmp/wavenet-test-" + std::to_string(getpid()) + "-" + name + "-" + std::to_string(i));
+    }
+    return result;
+}
+
+// Run 'fun' for each rank in its own, forked process, and check that all of
+// them succeed. A child fails if any of its checks fail.
+void forEachRank (const unsigned& size, const std::function<void(const unsigned&)>& fun) {
+    wavenet::Logger::flush();
+    std::vector<pid_t> children;
+    for (unsigned rank = 0; rank < size; rank++) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            test::failures() = 0;
+            fun(rank);
+            wavenet::Logger::flush();
+            _exit(test::failures() ? 1 : 0);
+        }
+        if (!CHECK(pid > 0)) { continue; }
+        children.push_back(pid);
+    }
+    for (const pid_t& pid : children) {
+        int status = 0;
+        CHECK(waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    return;
+}
+
+
+// The vectors of all ranks are reduced element-wise, to identical results on
+// all ranks, also for vectors with fewer entries than there are ranks, which
+// leaves some chunks of the ring all-reduce empty.
+void allReduce () {
+    for (unsigned size : {2u, 3u, 4u}) {
+        const std::vector<std::string> ring = addresses(size, "allreduce");
+        forEachRank(size, [&] (const unsigned& rank) {
+            wavenet::Communicator communicator (rank, ring, 10.);
+            if (!CHECK(communicator.initialised())) { return; }
+            for (unsigned n : {0u, 1u, size - 1, size, 7u, 100u}) {
+                arma::Col<double> sum (n), min (n), max (n);
+                for (unsigned i = 0; i < n; i++) { sum(i) = min(i) = max(i) = double((rank + 1) * (i + 1)); }
+                CHECK(communicator.allReduce(sum));
+                CHECK(communicator.allReduce(min, wavenet::Communicator::Reduction::Min));
+                CHECK(communicator.allReduce(max, wavenet::Communicator::Reduction::Max));
+                for (unsigned i = 0; i < n; i++) {
+                    CHECK(sum(i) == double(size * (size + 1) / 2 * (i + 1)));
+                    CHECK(min(i) == double(i + 1));
+                    CHECK(max(i) == double(size * (i + 1)));
+                }
+            }
+        });
+    }
+    return;
+}
+TEST(allReduce);
+
+
+// The vector of the root rank is copied to all ranks, which are resized
+// accordingly, for any root.
+void broadcast () {
+    const unsigned size = 3;
+    const std::vector<std::string> ring = addresses(size, "broadcast");
+    forEachRank(size, [&] (const unsigned& rank) {
+        wavenet::Communicator communicator (rank, ring, 10.);
+        if (!CHECK(communicator.initialised())) { return; }
+        for (unsigned root = 0; root < size; root++) {
+            for (unsigned n : {0u, 1u, 2u, 100u}) {
+                arma::Col<double> values;
+                if (rank == root) { values = arma::linspace< arma::Col<double> >(1, n, n) + root; }
+                CHECK(communicator.broadcast(values, root));
+                if (!CHECK(values.n_elem == n)) { continue; }
+                for (unsigned i = 0; i < n; i++) { CHECK(values(i) == double(i + 1 + root)); }
+            }
+        }
+    });
+    return;
+}
+TEST(broadcast);
+
+
+// Processes which connect to each other, but which were started with lists
+// of addresses of different sizes, don't form a ring: Rank 0 of {a, b} and
+// rank 2 of {a, c, b} listen on a and b, resp., and connect to each other, but
+// each rejects the handshake of the other and times out.
+void handshakeMismatch () {
+    const std::vector<std::string> ring = addresses(3, "handshake");
+    forEachRank(2, [&] (const unsigned& process) {
+        const std::vector<std::string> own = (process == 0 ? std::vector<std::string>{ring[0], ring[1]} :
+                                                             std::vector<std::string>{ring[0], ring[2], ring[1]});
+        wavenet::Communicator communicator ((process == 0 ? 0 : 2), own, 1.);
+        CHECK(!communicator.initialised());
+    });
+    return;
+}
+TEST(handshakeMismatch);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
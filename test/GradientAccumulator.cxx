@@ -0,0 +1,191 @@
+/**
+ * @file   GradientAccumulator.cxx
+ * @brief  Correctness tests of the accumulation of batch gradients.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <string> /* std::string */
+#include <fstream> /* std::ifstream, std::ofstream */
+#include <cstdio> /* std::remove */
+#include <cmath> /* std::abs */
+#include <limits> /* std::numeric_limits */
+#include <algorithm> /* std::max */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/GradientAccumulator.h" /* wavenet::GradientAccumulator */
+#include "Wavenet/Snapshot.h" /* wavenet::Snapshot */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Random gradients with N components, with a common offset, for which naive
+// summation, and the naive computation of the variance, lose precision.
+std::vector< arma::Col<double> > randomGradients (const unsigned& count, const unsigned& N, const double& offset) {
+    std::vector< arma::Col<double> > gradients;
+    for (unsigned i = 0; i < count; i++) {
+        gradients.push_back(arma::randn< arma::Col<double> >(N) + offset);
+    }
+    return gradients;
+}
+
+// Sum, mean, and sum of squared deviations from the mean, computed in two
+// passes in extended precision.
+void twoPass (const std::vector< arma::Col<double> >& gradients, arma::Col<double>& sum, arma::Col<double>& mean,
+              arma::Col<double>& m2) {
+    const unsigned N = gradients.front().n_elem;
+    sum.zeros(N);
+    mean.zeros(N);
+    m2.zeros(N);
+    for (unsigned k = 0; k < N; k++) {
+        long double s = 0, d = 0;
+        for (const arma::Col<double>& g : gradients) { s += g(k); }
+        const long double m = s / gradients.size();
+        for (const arma::Col<double>& g : gradients) { d += (g(k) - m) * (g(k) - m); }
+        sum(k)  = s;
+        mean(k) = m;
+        m2(k)   = d;
+    }
+    return;
+}
+
+// Largest difference between two vectors, relative to the largest entry of
+// the second.
+double relativeDifference (const arma::Col<double>& a, const arma::Col<double>& b) {
+    return arma::max(arma::abs(a - b)) / std::max(arma::max(arma::abs(b)), 1.0e-300);
+}
+
+// Read the state of the batch accumulator from a snapshot.
+bool readBatchStatistics (const std::string& filename, unsigned& count, std::vector< arma::Col<double> >& vecs) {
+    std::ifstream stream (filename);
+    std::string tmp;
+    while (stream >> tmp && tmp != "BATCHSTATISTICS") {}
+    if (!(stream >> count)) { return false; }
+    vecs.assign(3, arma::Col<double>()); // Sum, mean, and squared deviations.
+    for (arma::Col<double>& vec : vecs) {
+        std::vector<double> values;
+        while (stream >> tmp && tmp != "#") { values.push_back(std::stod(tmp)); }
+        vec = arma::Col<double>(values);
+    }
+    return true;
+}
+
+
+// The compensated sum, and Welford's running mean and squared deviations, agree
+// with the two-pass computation to (nearly) the precision of the result.
+void accumulatorMatchesTwoPass () {
+    arma::arma_rng::set_seed(1);
+    const double eps = std::numeric_limits<double>::epsilon();
+    for (unsigned count : {1u, 2u, 10u, 1000u}) {
+        const std::vector< arma::Col<double> > gradients = randomGradients(count, 5, 1.0e+04);
+        wavenet::GradientAccumulator accumulator;
+        for (const arma::Col<double>& g : gradients) { CHECK(accumulator.add(g)); }
+
+        arma::Col<double> sum, mean, m2;
+        twoPass(gradients, sum, mean, m2);
+        if (!CHECK(accumulator.count() == count)) { continue; }
+        CHECK_CLOSE(relativeDifference(accumulator.sum(),  sum),  0., 4. * eps);
+        CHECK_CLOSE(relativeDifference(accumulator.mean(), mean), 0., 1.0e-12);
+        if (count > 1) {
+            CHECK_CLOSE(relativeDifference(accumulator.m2(),       m2),              0., 1.0e-08);
+            CHECK_CLOSE(relativeDifference(accumulator.variance(), m2 / (count - 1.)), 0., 1.0e-08);
+        } else {
+            CHECK(arma::max(arma::abs(accumulator.m2()))       == 0.);
+            CHECK(arma::max(arma::abs(accumulator.variance())) == 0.);
+        }
+    }
+
+    // Gradients of a different size are rejected.
+    wavenet::GradientAccumulator accumulator;
+    CHECK(accumulator.add(arma::zeros< arma::Col<double> >(4)));
+    CHECK(!accumulator.add(arma::zeros< arma::Col<double> >(5)));
+    CHECK(accumulator.count() == 1);
+    return;
+}
+TEST(accumulatorMatchesTwoPass);
+
+
+// The squared deviations of batches combined across processes (@see
+// Wavenet::flushBatch_), through the sums of squares about zero, equal those
+// of the concatenated batches, also for batches of different sizes and means.
+void combinedMatchesConcatenated () {
+    arma::arma_rng::set_seed(2);
+    const std::vector<unsigned> sizes = {1, 7, 300, 692};
+    std::vector< arma::Col<double> > all;
+    arma::Col<double> sum (5, arma::fill::zeros), squares (5, arma::fill::zeros);
+    double count = 0;
+    for (unsigned i = 0; i < sizes.size(); i++) {
+        const std::vector< arma::Col<double> > gradients = randomGradients(sizes[i], 5, 10. * i);
+        wavenet::GradientAccumulator accumulator;
+        for (const arma::Col<double>& g : gradients) { accumulator.add(g); }
+        all.insert(all.end(), gradients.begin(), gradients.end());
+        sum     += accumulator.sum();
+        squares += accumulator.squares();
+        count   += accumulator.count();
+    }
+
+    arma::Col<double> referenceSum, referenceMean, referenceM2;
+    twoPass(all, referenceSum, referenceMean, referenceM2);
+    const arma::Col<double> m2 = wavenet::GradientAccumulator::deviations(count, sum, squares);
+    CHECK(count == all.size());
+    CHECK_CLOSE(relativeDifference(sum, referenceSum), 0., 1.0e-14);
+    CHECK_CLOSE(relativeDifference(m2,  referenceM2),  0., 1.0e-10);
+    CHECK_CLOSE(relativeDifference(m2 / (count - 1.), referenceM2 / (count - 1.)), 0., 1.0e-10);
+    return;
+}
+TEST(combinedMatchesConcatenated);
+
+
+// Snapshots written before the batch accumulator was introduced, which store
+// the gradients of the current batch in a BATCHQUEUE section, are loaded into
+// the accumulator. The state is checked through a snapshot in the current
+// format.
+void batchQueueSnapshot () {
+    const std::string oldFile = "test_batchqueue_old.snap", newFile = "test_batchqueue_new.snap";
+    {
+        std::ofstream stream (oldFile);
+        stream << "0.5\n0.01\n0\n0\n";
+        stream << "  0.7071067811865476\n  0.7071067811865476\n#\n";
+        stream << "  0\n  0\n#\n";
+        stream << "10\n";
+        stream << "BATCHQUEUE\n";
+        stream << "  1\n  2\n#\n  4\n  5\n#\n  7\n  8\n#\n";
+        stream << "FILTERLOG\n";
+        stream << "  0.7071067811865476\n  0.7071067811865476\n#\n";
+        stream << "COSTLOG\n0\n";
+    }
+
+    wavenet::Wavenet wn;
+    wn.load(wavenet::Snapshot(oldFile));
+    wn.save(wavenet::Snapshot(newFile));
+    CHECK(wn.batchSize() == 10);
+    CHECK(wn.filter().n_elem == 2);
+    CHECK(wn.filterLog().size() == 1);
+
+    unsigned count = 0;
+    std::vector< arma::Col<double> > vecs;
+    if (CHECK(readBatchStatistics(newFile, count, vecs))) {
+        CHECK(count == 3);
+        const std::vector< arma::Col<double> > expected = {{12., 15.}, {4., 5.}, {18., 18.}};
+        for (unsigned i = 0; i < vecs.size(); i++) {
+            if (!CHECK(vecs[i].n_elem == 2)) { continue; }
+            CHECK_CLOSE(relativeDifference(vecs[i], expected[i]), 0., 1.0e-12);
+        }
+    }
+
+    std::remove(oldFile.c_str());
+    std::remove(newFile.c_str());
+    return;
+}
+TEST(batchQueueSnapshot);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
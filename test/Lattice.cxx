@@ -0,0 +1,90 @@
+/**
+ * @file   Lattice.cxx
+ * @brief  Correctness tests of the orthonormal lattice parameterisation.
+ */
+
+// STL include(s).
+#include <cmath> /* std::sqrt */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Lattice.h" /* wavenet::LatticeFilter, wavenet::LatticeAngles */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Check the conditions for the filter coefficients to define an orthonormal
+// wavelet: the coefficients sum to sqrt(2), and are orthonormal to their even
+// shifts.
+void checkOrthonormal (const arma::Col<double>& filter) {
+    const unsigned N = filter.n_elem;
+    CHECK_CLOSE(arma::accu(filter), std::sqrt(2.), 1.0e-12);
+    for (unsigned m = 0; m < N; m += 2) {
+        double product = 0;
+        for (unsigned k = 0; k + m < N; k++) {
+            product += filter(k) * filter(k + m);
+        }
+        CHECK_CLOSE(product, (m == 0 ? 1. : 0.), 1.0e-12);
+    }
+    return;
+}
+
+
+// Any angles yield a valid wavelet, from which the angles are recovered.
+void latticeRoundTrip () {
+    arma::arma_rng::set_seed(1);
+    for (unsigned N = 2; N <= 12; N += 2) {
+        const arma::Col<double> angles = (arma::randu< arma::Col<double> >(N / 2 - 1) - 0.5) * arma::datum::pi;
+        const arma::Col<double> filter = wavenet::LatticeFilter(angles);
+        if (!CHECK(filter.n_elem == N)) { continue; }
+        checkOrthonormal(filter);
+        const arma::Col<double> recovered = wavenet::LatticeAngles(filter);
+        if (!CHECK(recovered.n_elem == angles.n_elem)) { continue; }
+        for (unsigned j = 0; j < angles.n_elem; j++) {
+            CHECK_CLOSE(recovered(j), angles(j), 1.0e-10);
+        }
+    }
+    return;
+}
+TEST(latticeRoundTrip);
+
+
+// With N = 2, there are no free angles, and the lattice only contains the Haar
+// wavelet.
+void latticeHaar () {
+    const arma::Col<double> filter = wavenet::LatticeFilter(arma::Col<double>());
+    if (!CHECK(filter.n_elem == 2)) { return; }
+    CHECK_CLOSE(filter(0), 1. / std::sqrt(2.), 1.0e-12);
+    CHECK_CLOSE(filter(1), 1. / std::sqrt(2.), 1.0e-12);
+    CHECK(wavenet::LatticeAngles(arma::Col<double>({1., 0.5})).n_elem == 0);
+    return;
+}
+TEST(latticeHaar);
+
+
+// The filter coefficients of a wavenet using the lattice parameterisation are
+// projected onto the lattice before the first example is used, also for N = 2
+// where there are no angles to tell whether this has happened.
+void wavenetProjectsOntoLattice () {
+    arma::arma_rng::set_seed(2);
+    for (unsigned N : {2u, 4u, 8u}) {
+        wavenet::Wavenet wn (0., 0.01);
+        wn.setLattice(true);
+        wn.setBatchSize(10);
+        CHECK(wn.setFilter(arma::randu< arma::Col<double> >(N) + 0.1));
+        CHECK(wn.train(arma::randn< arma::Mat<double> >(16, 16)));
+        checkOrthonormal(wn.filter());
+    }
+    return;
+}
+TEST(wavenetProjectsOntoLattice);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
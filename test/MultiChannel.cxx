@@ -0,0 +1,134 @@
+/**
+ * @file   MultiChannel.cxx
+ * @brief  Correctness tests of training on multi-channel examples.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <algorithm> /* std::max */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/TransformPlan.h" /* wavenet::TransformPlan */
+#include "Wavenet/CostFunctions.h" /* wavenet::SparseTerm */
+#include "Wavenet/Lattice.h" /* wavenet::LatticeFilter */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Orthonormal filter with N coefficients, from random lattice angles.
+arma::Col<double> orthonormalFilter (const unsigned& N) {
+    return wavenet::LatticeFilter(arma::randu< arma::Col<double> >(N / 2 - 1) * 2 * arma::datum::pi);
+}
+
+// Batch gradient and cost of training on the single example X, without
+// regularisation.
+template<class T>
+bool trainOnce (const arma::Col<double>& filter, const T& X, const bool& joint, const bool& invertible,
+                arma::Col<double>& gradient, double& cost) {
+    wavenet::Wavenet wn (0.);
+    wn.setBatchSize(1);
+    wn.setJointSparsity(joint);
+    wn.setInvertible(invertible);
+    if (!wn.setFilter(filter) || !wn.train(X) || wn.costLog().size() != 2) { return false; }
+    gradient = wn.batchGradient();
+    cost     = wn.costLog().front();
+    return true;
+}
+
+// Sparsity term of the wavelet coefficients of all channels of X combined.
+double jointSparsity (const arma::Col<double>& filter, const arma::Cube<double>& X) {
+    wavenet::TransformPlan plan ({(unsigned) X.n_rows, (unsigned) X.n_cols}, filter.n_elem,
+                                 wavenet::TransformPlan::Mode::Transform);
+    plan.setFilter(filter);
+    arma::Cube<double> Y (X.n_rows, X.n_cols, X.n_slices);
+    arma::Mat<double> Yc;
+    for (unsigned c = 0; c < X.n_slices; c++) {
+        plan.forward(X.slice(c), Yc);
+        Y.slice(c) = Yc;
+    }
+    return wavenet::SparseTerm(arma::Col<double>(Y.memptr(), Y.n_elem));
+}
+
+
+// A single-channel example is trained on exactly like the corresponding
+// matrix, with or without joint sparsity.
+void singleChannelMatchesMatrix () {
+    arma::arma_rng::set_seed(1);
+    for (unsigned N : {2u, 6u, 12u}) {
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+        const arma::Mat<double> X = arma::randn< arma::Mat<double> >(16, 32);
+        const arma::Cube<double> cube (X.memptr(), X.n_rows, X.n_cols, 1);
+        arma::Col<double> gradientMatrix, gradientCube;
+        double costMatrix = 0, costCube = 0;
+        if (!CHECK(trainOnce(filter, X, false, false, gradientMatrix, costMatrix))) { continue; }
+        for (const bool joint : {false, true}) {
+            if (!CHECK(trainOnce(filter, cube, joint, false, gradientCube, costCube))) { continue; }
+            CHECK_CLOSE(arma::norm(gradientCube - gradientMatrix), 0., 1.0e-12 * arma::norm(gradientMatrix));
+            CHECK_CLOSE(costCube, costMatrix, 1.0e-12);
+        }
+    }
+    return;
+}
+TEST(singleChannelMatchesMatrix);
+
+
+// With per-channel sparsity, the gradient and cost of a multi-channel example
+// are the sums of those of the channels.
+void perChannelIsSum () {
+    arma::arma_rng::set_seed(2);
+    for (unsigned N : {2u, 6u, 12u}) {
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+        const arma::Cube<double> X = arma::randn< arma::Cube<double> >(16, 32, 3);
+        arma::Col<double> gradient, gradientChannel, gradientSum (N, arma::fill::zeros);
+        double cost = 0, costChannel = 0, costSum = 0;
+        if (!CHECK(trainOnce(filter, X, false, false, gradient, cost))) { continue; }
+        for (unsigned c = 0; c < X.n_slices; c++) {
+            if (!CHECK(trainOnce(filter, arma::Mat<double>(X.slice(c)), false, false, gradientChannel, costChannel))) { continue; }
+            gradientSum += gradientChannel;
+            costSum     += costChannel;
+        }
+        CHECK_CLOSE(arma::norm(gradient - gradientSum), 0., 1.0e-12 * arma::norm(gradientSum));
+        CHECK_CLOSE(cost, costSum, 1.0e-12);
+    }
+    return;
+}
+TEST(perChannelIsSum);
+
+
+// With joint sparsity, the gradient is that of the sparsity term of the
+// stacked wavelet coefficients of all channels, both when re-transforming the
+// channels, and when reconstructing their activations.
+void jointMatchesDifferences () {
+    arma::arma_rng::set_seed(3);
+    const double epsilon = 1.0e-6;
+    for (unsigned N : {2u, 6u, 12u}) {
+        const arma::Col<double> filter = orthonormalFilter(N);
+        const arma::Cube<double> X = arma::randn< arma::Cube<double> >(16, 32, 3);
+        arma::Col<double> difference (N), step (N, arma::fill::zeros);
+        for (unsigned k = 0; k < N; k++) {
+            step(k) = epsilon;
+            difference(k) = (jointSparsity(filter + step, X) - jointSparsity(filter - step, X)) / (2. * epsilon);
+            step(k) = 0;
+        }
+        for (const bool invertible : {false, true}) {
+            arma::Col<double> gradient;
+            double cost = 0;
+            if (!CHECK(trainOnce(filter, X, true, invertible, gradient, cost))) { continue; }
+            CHECK_CLOSE(cost, jointSparsity(filter, X), 1.0e-12);
+            CHECK_CLOSE(arma::norm(gradient - difference), 0., 1.0e-6 * std::max(arma::norm(difference), 1.));
+        }
+    }
+    return;
+}
+TEST(jointMatchesDifferences);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
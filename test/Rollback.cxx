@@ -0,0 +1,94 @@
+/**
+ * @file   Rollback.cxx
+ * @brief  Correctness tests of the roll-back of diverging updates.
+ */
+
+// STL include(s).
+#include <limits> /* std::numeric_limits */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Example for which the gradient isn't finite.
+arma::Mat<double> nonFiniteExample () {
+    arma::Mat<double> X = arma::randn< arma::Mat<double> >(16, 16);
+    X(3, 5) = std::numeric_limits<double>::quiet_NaN();
+    return X;
+}
+
+// Whether the updates in the filter log, following the initial filter
+// coefficients, match the completed entries in the cost log, i.e. all but the
+// entry of the current batch.
+bool logsAligned (wavenet::Wavenet& wn) {
+    return wn.filterLog().size() == wn.costLog().size();
+}
+
+
+// A batch with a non-finite example restores the filter coefficients from
+// before the last update, without logging them, zeros the momentum, and
+// reduces the learning rate by the roll-back factor.
+void rollbackRestoresState () {
+    arma::arma_rng::set_seed(1);
+    wavenet::Wavenet wn (0., 0.1);
+    wn.setBatchSize(2);
+    wn.setRollback(0.5, 2);
+    const arma::Col<double> initial = arma::randn< arma::Col<double> >(4);
+    CHECK(wn.setFilter(initial));
+
+    // A successful update.
+    CHECK(wn.train(arma::randn< arma::Mat<double> >(16, 16)));
+    CHECK(wn.train(arma::randn< arma::Mat<double> >(16, 16)));
+    if (!CHECK(wn.costLog().size() == 2)) { return; }
+    CHECK(logsAligned(wn));
+    CHECK(arma::norm(wn.momentum()) > 0.);
+    CHECK(arma::norm(wn.filter() - initial) > 0.);
+    const double alpha = wn.alpha();
+
+    // A batch with a non-finite example.
+    CHECK(wn.train(arma::randn< arma::Mat<double> >(16, 16)));
+    CHECK(wn.train(nonFiniteExample()));
+    CHECK(wn.costLog().size() == 2);
+    CHECK(wn.costLog().back() == 0.);
+    CHECK(logsAligned(wn));
+    CHECK(arma::norm(wn.filter() - initial) == 0.);
+    CHECK(arma::norm(wn.momentum()) == 0.);
+    CHECK_CLOSE(wn.alpha(), alpha * wn.rollbackFactor(), 1.0e-15);
+    CHECK(wn.metrics().rollbacks() == 1);
+    return;
+}
+TEST(rollbackRestoresState);
+
+
+// Training stops after more than the maximal number of consecutive roll-backs,
+// and a successful update resets the count.
+void rollbackLimit () {
+    arma::arma_rng::set_seed(2);
+    wavenet::Wavenet wn (0., 0.1);
+    wn.setBatchSize(1);
+    wn.setRollback(0.5, 2);
+    CHECK(wn.setFilter(arma::randn< arma::Col<double> >(4)));
+
+    CHECK(wn.train(nonFiniteExample()));
+    CHECK(wn.train(arma::randn< arma::Mat<double> >(16, 16)));
+    for (unsigned i = 0; i < wn.maxRollbacks(); i++) {
+        CHECK(wn.train(nonFiniteExample()));
+        CHECK(logsAligned(wn));
+    }
+    CHECK(!wn.train(nonFiniteExample()));
+    CHECK(logsAligned(wn));
+    return;
+}
+TEST(rollbackLimit);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
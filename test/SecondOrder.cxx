@@ -0,0 +1,152 @@
+/**
+ * @file   SecondOrder.cxx
+ * @brief  Correctness tests of the second-order methods.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <algorithm> /* std::max */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/CostFunctions.h" /* wavenet::RegTerm, wavenet::RegTermDeriv, wavenet::RegTermHessian */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Random examples, for which the wavelet coefficients are away from the kinks
+// of the sparsity term, i.e. coefficients of equal magnitude, or zero.
+std::vector< arma::Mat<double> > randomExamples (const unsigned& count) {
+    std::vector< arma::Mat<double> > examples;
+    for (unsigned i = 0; i < count; i++) {
+        examples.push_back(arma::randn< arma::Mat<double> >(16, 16));
+    }
+    return examples;
+}
+
+// Cost returned by 'gradient' with the given filter coefficients.
+double cost (wavenet::Wavenet& wn, const std::vector< arma::Mat<double> >& examples, const arma::Col<double>& filter) {
+    arma::Col<double> gradient;
+    double cost = 0;
+    wn.setFilter(filter);
+    wn.gradient(examples, gradient, cost);
+    return cost;
+}
+
+
+// The exact Hessian of the regularisation term, which is a polynomial in the
+// filter coefficients, is the Jacobian of its gradient.
+void regTermHessianMatchesGradient () {
+    arma::arma_rng::set_seed(1);
+    const double epsilon = 1.0e-5;
+    for (unsigned N : {2u, 4u, 8u}) {
+        for (const bool doWavelet : {false, true}) {
+            const arma::Col<double> a = arma::randn< arma::Col<double> >(N);
+            const arma::Col<double> v = arma::randn< arma::Col<double> >(N);
+            const arma::Col<double> exact      = wavenet::RegTermHessian(a, doWavelet) * v;
+            const arma::Col<double> difference = (wavenet::RegTermDeriv(a + epsilon * v, doWavelet) -
+                                                  wavenet::RegTermDeriv(a - epsilon * v, doWavelet)) / (2. * epsilon);
+            CHECK_CLOSE(arma::norm(exact - difference), 0., 1.0e-6 * arma::norm(exact));
+        }
+    }
+    return;
+}
+TEST(regTermHessianMatchesGradient);
+
+
+// The regularisation part of the Hessian-vector product, which is smooth, is
+// the exact product with RegTermHessian: the products for two values of the
+// regularisation constant, on the same examples, differ by exactly that. (The
+// finite-difference estimate of the sparsity part is identical in both.)
+void hessianVectorProductRegularisation () {
+    arma::arma_rng::set_seed(2);
+    const double lambda = 10.;
+    for (unsigned N : {4u, 8u}) {
+        std::vector< arma::Mat<double> > examples;
+        for (unsigned i = 0; i < 4; i++) {
+            examples.push_back(arma::randn< arma::Mat<double> >(16, 16));
+        }
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+        const arma::Col<double> v      = arma::randn< arma::Col<double> >(N);
+
+        wavenet::Wavenet bare (0.), regularised (lambda);
+        arma::Col<double> HvBare, HvRegularised;
+        CHECK(bare       .setFilter(filter));
+        CHECK(regularised.setFilter(filter));
+        CHECK(bare       .hessianVectorProduct(examples, v, HvBare));
+        CHECK(regularised.hessianVectorProduct(examples, v, HvRegularised));
+
+        const arma::Col<double> exact = lambda * wavenet::RegTermHessian(filter, true) * v;
+        CHECK_CLOSE(arma::norm(HvRegularised - HvBare - exact), 0., 1.0e-10 * arma::norm(exact));
+    }
+    return;
+}
+TEST(hessianVectorProductRegularisation);
+
+
+// The gradient is that of the returned cost, with regularisation.
+void gradientMatchesDifferences () {
+    arma::arma_rng::set_seed(3);
+    const double epsilon = 1.0e-6;
+    for (unsigned N : {4u, 8u}) {
+        const std::vector< arma::Mat<double> > examples = randomExamples(4);
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+
+        wavenet::Wavenet wn (1.);
+        arma::Col<double> gradient;
+        double value = 0;
+        CHECK(wn.setFilter(filter));
+        if (!CHECK(wn.gradient(examples, gradient, value))) { continue; }
+
+        arma::Col<double> difference (N), step (N, arma::fill::zeros);
+        for (unsigned k = 0; k < N; k++) {
+            step(k) = epsilon;
+            difference(k) = (cost(wn, examples, filter + step) - cost(wn, examples, filter - step)) / (2. * epsilon);
+            step(k) = 0;
+        }
+        CHECK_CLOSE(cost(wn, examples, filter), value, 1.0e-12 * std::max(value, 1.));
+        CHECK_CLOSE(arma::norm(gradient - difference), 0., 1.0e-6 * std::max(arma::norm(difference), 1.));
+    }
+    return;
+}
+TEST(gradientMatchesDifferences);
+
+
+// An accepted Newton step lowers the cost, and is logged like an update in
+// training: the new filter coefficients in the filter log, and the cost before
+// the step in the cost log, ahead of the entry of the current batch.
+void newtonStepLowersCost () {
+    arma::arma_rng::set_seed(4);
+    const double lambda = 10.;
+    for (unsigned N : {4u, 8u}) {
+        const std::vector< arma::Mat<double> > examples = randomExamples(4);
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+
+        wavenet::Wavenet wn (lambda);
+        arma::Col<double> gradient;
+        double before = 0, after = 0;
+        CHECK(wn.setFilter(filter));
+        CHECK(wn.gradient(examples, gradient, before));
+        if (!CHECK(wn.newtonStep(examples))) { continue; }
+        CHECK(wn.gradient(examples, gradient, after));
+        CHECK(after < before);
+
+        CHECK(arma::norm(wn.momentum()) == 0.);
+        if (!CHECK(wn.filterLog().size() == 2 && wn.costLog().size() == 2)) { continue; }
+        CHECK(arma::norm(wn.filterLog().back() - wn.filter()) == 0.);
+        CHECK_CLOSE(wn.costLog().front(), before - lambda * wavenet::RegTerm(filter, true), 1.0e-12 * std::max(before, 1.));
+        CHECK(wn.costLog().back() == 0.);
+    }
+    return;
+}
+TEST(newtonStepLowersCost);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file   StreamingTransform.cxx
+ * @brief  Correctness tests of the streaming 1D transform and its inverse.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <algorithm> /* std::min, std::max */
+#include <cmath> /* std::abs */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Lattice.h" /* wavenet::LatticeFilter */
+#include "Wavenet/TransformPlan.h" /* wavenet::TransformPlan */
+#include "Wavenet/StreamingTransform.h" /* wavenet::StreamingTransform, ... */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Orthonormal filter with N coefficients, from random lattice angles.
+arma::Col<double> orthonormalFilter (const unsigned& N) {
+    return wavenet::LatticeFilter(arma::randu< arma::Col<double> >(N / 2 - 1) * 2 * arma::datum::pi);
+}
+
+// Whether the output r at scale s depends only on samples in [0, length),
+// i.e. whether its window wraps around in the periodic transform. Output r
+// depends on the inputs [2r + N/2 - N + 1, 2r + N/2] at its scale, each of
+// which is an output of the finer scale.
+bool interior (const unsigned& s, const long& r, const long& N, const long& length) {
+    long lo = 2 * r + N / 2 - N + 1;
+    long hi = 2 * r + N / 2;
+    for (unsigned i = 0; i < s; i++) {
+        lo = 2 * lo + N / 2 - N + 1;
+        hi = 2 * hi + N / 2;
+    }
+    return lo >= 0 && hi < length;
+}
+
+
+// Away from the boundaries, the streaming coefficients equal those of the
+// periodic transform of the same samples, for any filter.
+void streamingInteriorMatchesPeriodic () {
+    arma::arma_rng::set_seed(1);
+    const unsigned length = 256, numLevels = 8;
+    for (unsigned N : {2u, 4u, 6u, 8u}) {
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+        const arma::Mat<double> X = arma::randn< arma::Mat<double> >(length, 1);
+
+        // Periodic transform.
+        wavenet::TransformPlan plan ({length}, N, wavenet::TransformPlan::Mode::Transform);
+        arma::Mat<double> Y;
+        CHECK(plan.setFilter(filter));
+        CHECK(plan.forward(X, Y));
+
+        // Streaming transform, in uneven chunks.
+        wavenet::StreamingTransform transform (filter, numLevels);
+        std::vector<wavenet::StreamingCoefficient> coefficients;
+        for (unsigned first = 0; first < length; first += 37) {
+            const unsigned last = std::min(first + 37, length) - 1;
+            CHECK(transform.push(X.col(0).rows(first, last), coefficients));
+        }
+        CHECK(transform.flush(coefficients));
+
+        // Compare interior coefficients. The high-pass coefficients at scale s
+        // are stored in [length / 2^{s + 1}, length / 2^{s}), and the coarsest
+        // low-pass coefficient in 0.
+        unsigned numCompared = 0;
+        for (const wavenet::StreamingCoefficient& c : coefficients) {
+            if (!interior(c.scale, c.index, N, length)) { continue; }
+            const unsigned index = (c.lowpass ? 0 : (length >> (c.scale + 1)) + c.index);
+            CHECK_CLOSE(c.value, Y(index), 1.0e-12);
+            numCompared++;
+        }
+
+        // Most coefficients at the finer scales are away from the boundaries.
+        CHECK(numCompared >= length / 2);
+    }
+    return;
+}
+TEST(streamingInteriorMatchesPeriodic);
+
+
+// For orthonormal filters, the streaming inverse reconstructs the stream
+// exactly, independently of the chunks in which the samples and coefficients
+// are pushed.
+void streamingInverseRoundTrip () {
+    arma::arma_rng::set_seed(2);
+    const unsigned length = 1000;
+    for (unsigned N : {2u, 4u, 8u, 12u}) {
+        const arma::Col<double> filter = orthonormalFilter(N);
+        for (unsigned numLevels : {1u, 3u, 5u}) {
+            for (unsigned chunk : {1u, 3u, 16u, 100u, length}) {
+                const arma::Col<double> x = arma::randn< arma::Col<double> >(length);
+
+                // Transform, and pass the coefficients to the inverse as soon
+                // as they are emitted.
+                wavenet::StreamingTransform transform (filter, numLevels);
+                wavenet::StreamingInverse   inverse   (filter, numLevels);
+                std::vector<wavenet::StreamingCoefficient> coefficients;
+                std::vector<double> samples;
+                for (unsigned first = 0; first < length; first += chunk) {
+                    const unsigned last = std::min(first + chunk, length) - 1;
+                    coefficients.clear();
+                    CHECK(transform.push(x.rows(first, last), coefficients));
+                    CHECK(inverse.push(coefficients, samples));
+                }
+                coefficients.clear();
+                CHECK(transform.flush(coefficients));
+                CHECK(inverse.push(coefficients, samples));
+                CHECK(inverse.flush(samples, length));
+
+                // Compare.
+                if (!CHECK(samples.size() == length)) { continue; }
+                double maxError = 0;
+                for (unsigned i = 0; i < length; i++) {
+                    maxError = std::max(maxError, std::abs(samples[i] - x(i)));
+                }
+                CHECK_CLOSE(maxError, 0., 1.0e-10);
+            }
+        }
+    }
+    return;
+}
+TEST(streamingInverseRoundTrip);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
@@ -0,0 +1,140 @@
+#ifndef WAVENET_TEST_H
+#define WAVENET_TEST_H
+
+/**
+ * @file   Test.h
+ * @brief  Minimal, header-only harness for correctness tests.
+ */
+
+// STL include(s).
+#include <string> /* std::string */
+#include <vector> /* std::vector */
+#include <functional> /* std::function */
+#include <cmath> /* std::abs */
+
+// Wavenet include(s).
+#include "Wavenet/Logger.h" /* FCTINFO, FCTWARNING */
+
+/**
+ * Register a test function, with signature 'void ()', in which the 'CHECK'
+ * macros are used to test the results. E.g.
+ *
+ *   void myTest () {
+ *       CHECK(1 + 1 == 2);
+ *       CHECK_CLOSE(std::sqrt(2.) * std::sqrt(2.), 2., 1.0e-12);
+ *   }
+ *   TEST(myTest);
+ *
+ * A test fails if any of its checks fail, but is always run to completion.
+ */
+#define TEST(fun) static test::Registrar WAVENET_TEST_CONCAT(registrar_, __LINE__) (#fun, fun)
+#define WAVENET_TEST_CONCAT_(a, b) a ## b
+#define WAVENET_TEST_CONCAT(a, b)  WAVENET_TEST_CONCAT_(a, b)
+
+// Check that a condition holds.
+#define CHECK(cond) test::check((cond), #cond, __FILE__, __LINE__)
+
+// Check that |a - b| <= tol.
+#define CHECK_CLOSE(a, b, tol) test::checkClose((a), (b), (tol), #a, #b, __FILE__, __LINE__)
+
+
+namespace test {
+
+/**
+ * Single registered test.
+ */
+struct Test {
+    std::string name;
+    std::function<void()> fun;
+};
+
+/**
+ * Global list of registered tests.
+ */
+inline std::vector<Test>& registry () {
+    static std::vector<Test> tests;
+    return tests;
+}
+
+/**
+ * Number of failed checks in the current test.
+ */
+inline unsigned& failures () {
+    static unsigned count = 0;
+    return count;
+}
+
+/**
+ * Helper class, registering a test on construction.
+ */
+struct Registrar {
+    Registrar (const std::string& name, std::function<void()> fun) {
+        registry().push_back({name, fun});
+    }
+};
+
+/**
+ * Record the outcome of a single check. Returns whether the check passed.
+ */
+inline bool check (const bool& passed, const char* expr, const char* file, const int& line) {
+    if (!passed) {
+        FCTWARNING("%s:%d: Check '%s' failed.", file, line, expr);
+        failures()++;
+    }
+    return passed;
+}
+
+/**
+ * Record the outcome of a check that two numbers are equal within tolerance.
+ */
+inline bool checkClose (const double& a, const double& b, const double& tol, const char* exprA, const char* exprB,
+                        const char* file, const int& line) {
+    const bool passed = std::abs(a - b) <= tol;
+    if (!passed) {
+        FCTWARNING("%s:%d: Check '%s == %s' failed: %.6e vs. %.6e (tolerance %.1e).", file, line, exprA, exprB, a, b, tol);
+        failures()++;
+    }
+    return passed;
+}
+
+/**
+ * Main function of a test executable. Accepts the command-line option:
+ *   --filter=<substring>  Only run tests whose name contains the substring.
+ * Returns the number of failed tests.
+ */
+inline int main (int argc, char* argv[]) {
+
+    // Parse command-line options.
+    std::string filter = "";
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.find("--filter=") == 0) { filter = arg.substr(9); }
+        else {
+            FCTWARNING("Unknown option '%s'.", arg.c_str());
+            return 1;
+        }
+    }
+
+    // Run tests.
+    int numFailed = 0, numRun = 0;
+    for (const Test& t : registry()) {
+        if (t.name.find(filter) == std::string::npos) { continue; }
+        failures() = 0;
+        t.fun();
+        numRun++;
+        if (failures() > 0) {
+            FCTWARNING("%-48s FAILED (%d check(s))", t.name.c_str(), failures());
+            numFailed++;
+        } else {
+            FCTINFO("%-48s ok", t.name.c_str());
+        }
+    }
+    FCTINFO("%d of %d test(s) passed.", numRun - numFailed, numRun);
+    wavenet::Logger::flush();
+
+    return numFailed;
+}
+
+} // namespace
+
+#endif // WAVENET_TEST_H
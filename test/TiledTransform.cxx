@@ -0,0 +1,142 @@
+/**
+ * @file   TiledTransform.cxx
+ * @brief  Correctness tests of the tiled 2D transform.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <algorithm> /* std::max */
+#include <cmath> /* std::abs */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/TransformPlan.h" /* wavenet::TransformPlan */
+#include "Wavenet/TiledTransform.h" /* wavenet::TiledTransform */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Untiled 1D transform of the n entries of 'line', with the given stride, in
+// place. Output r of each level is sum_k g_k u(2r + N/2 - k), where the input u
+// wraps around at the boundary if 'periodic', and is zero outside it otherwise.
+void reference1D (const arma::Col<double>& filter, double* line, const unsigned& n, const unsigned& stride,
+                  const bool& periodic) {
+    const long N = filter.n_elem;
+    std::vector<double> u (n), y (n);
+    for (unsigned i = 0; i < n; i++) { u[i] = line[i * stride]; }
+    for (long length = n; length > 1; length /= 2) {
+        std::vector<double> low (length / 2);
+        for (long r = 0; r < length / 2; r++) {
+            double l = 0, h = 0;
+            for (long k = 0; k < N; k++) {
+                long t = 2 * r + N / 2 - k;
+                if (periodic) { t = ((t % length) + length) % length; }
+                else if (t < 0 || t >= length) { continue; }
+                l += filter(k) * u[t];
+                h += (k % 2 ? -1. : 1.) * filter(N - k - 1) * u[t];
+            }
+            low[r] = l;
+            y[length / 2 + r] = h;
+        }
+        u = low;
+    }
+    y[0] = u[0];
+    for (unsigned i = 0; i < n; i++) { line[i * stride] = y[i]; }
+    return;
+}
+
+// Untiled 2D transform: all rows, and then all columns of the result.
+arma::Mat<double> reference2D (const arma::Col<double>& filter, const arma::Mat<double>& X, const bool& periodic) {
+    arma::Mat<double> Y = X;
+    for (unsigned irow = 0; irow < Y.n_rows; irow++) {
+        reference1D(filter, Y.memptr() + irow, Y.n_cols, Y.n_rows, periodic);
+    }
+    for (unsigned icol = 0; icol < Y.n_cols; icol++) {
+        reference1D(filter, Y.colptr(icol), Y.n_rows, 1, periodic);
+    }
+    return Y;
+}
+
+// Largest absolute difference between two matrices of the same shape.
+double maxDifference (const arma::Mat<double>& A, const arma::Mat<double>& B) {
+    double difference = 0;
+    for (unsigned i = 0; i < A.n_elem; i++) {
+        difference = std::max(difference, std::abs(A(i) - B(i)));
+    }
+    return difference;
+}
+
+
+// The reference transform with periodic boundaries is the one of TransformPlan
+// (and Wavenet).
+void referenceMatchesPlan () {
+    arma::arma_rng::set_seed(1);
+    for (unsigned N : {2u, 4u, 8u}) {
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+        const arma::Mat<double> X = arma::randn< arma::Mat<double> >(32, 16);
+        wavenet::TransformPlan plan ({32, 16}, N, wavenet::TransformPlan::Mode::Transform);
+        arma::Mat<double> Y;
+        CHECK(plan.setFilter(filter));
+        CHECK(plan.forward(X, Y));
+        CHECK_CLOSE(maxDifference(Y, reference2D(filter, X, true)), 0., 1.0e-12);
+    }
+    return;
+}
+TEST(referenceMatchesPlan);
+
+
+// The stitched coefficients equal those of the untiled transform, for both
+// boundary modes, for tiles smaller than, equal to, and larger than the input
+// along each axis, and for any number of levels per tile.
+void tiledMatchesUntiled () {
+    arma::arma_rng::set_seed(2);
+    const arma::Mat<double> X = arma::randn< arma::Mat<double> >(64, 32);
+    for (unsigned N : {2u, 4u, 6u, 8u}) {
+        const arma::Col<double> filter = arma::randn< arma::Col<double> >(N);
+        for (const bool periodic : {true, false}) {
+            const arma::Mat<double> reference = reference2D(filter, X, periodic);
+            const wavenet::TiledTransform::Boundary boundary = (periodic ?
+                                                                wavenet::TiledTransform::Boundary::Periodic :
+                                                                wavenet::TiledTransform::Boundary::Zero);
+            for (unsigned tileSize : {4u, 16u, 32u, 64u}) {
+                for (unsigned tileLevels = 1; (1u << tileLevels) <= tileSize; tileLevels++) {
+                    wavenet::TiledTransform tiled (filter, tileSize, tileLevels, boundary);
+                    arma::Mat<double> Y;
+                    CHECK(tiled.valid());
+                    CHECK(tiled.forward(X, Y));
+                    CHECK_CLOSE(maxDifference(Y, reference), 0., 1.0e-12);
+                }
+            }
+        }
+    }
+    return;
+}
+TEST(tiledMatchesUntiled);
+
+
+// The result doesn't depend on the number of threads, for images large enough
+// for the tiles to be processed in parallel.
+void tiledThreads () {
+    arma::arma_rng::set_seed(3);
+    const arma::Col<double> filter = arma::randn< arma::Col<double> >(6);
+    const arma::Mat<double> X = arma::randn< arma::Mat<double> >(512, 512);
+    const arma::Mat<double> reference = reference2D(filter, X, true);
+    for (unsigned numThreads : {1u, 4u}) {
+        wavenet::TiledTransform tiled (filter, 64, 3);
+        tiled.setNumThreads(numThreads);
+        arma::Mat<double> Y;
+        CHECK(tiled.forward(X, Y));
+        CHECK_CLOSE(maxDifference(Y, reference), 0., 1.0e-12);
+    }
+    return;
+}
+TEST(tiledThreads);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
@@ -0,0 +1,282 @@
+/**
+ * @file   TransformPlan.cxx
+ * @brief  Correctness tests of the transform plan against the matrix operators.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <algorithm> /* std::max */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/TransformPlan.h" /* wavenet::TransformPlan */
+#include "Wavenet/CostFunctions.h" /* wavenet::SparseTerm, wavenet::SparseTermDeriv */
+#include "Wavenet/Utilities.h" /* wavenet::coeffsFromActivations */
+#include "Wavenet/Lattice.h" /* wavenet::LatticeFilter */
+#include "Wavenet/Wavenet.h" /* wavenet::Wavenet */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Wavenet exposing the reference transform methods, which use the cached
+// matrix operators.
+class ReferenceWavenet : public wavenet::Wavenet {
+public:
+    ReferenceWavenet (const arma::Col<double>& filter) : Wavenet(0.) { setFilter(filter); }
+    using Wavenet::forward_;
+    using Wavenet::inverse_;
+    using Wavenet::backpropagate_;
+};
+
+// Input shapes, 1D (as a single column) and 2D, and filter lengths tested.
+const std::vector< std::vector<unsigned> > s_shapes = {{64}, {16, 32}};
+const std::vector<unsigned> s_lengths = {2, 4, 6, 8, 10, 12, 14, 16, 18, 20};
+
+// Random input of the given shape.
+arma::Mat<double> randomInput (const std::vector<unsigned>& shape) {
+    return arma::randn< arma::Mat<double> >(shape[0], shape.size() > 1 ? shape[1] : 1);
+}
+
+// Random filter with N coefficients of unit norm, such that the coefficients
+// stay of order one through all levels.
+arma::Col<double> randomFilter (const unsigned& N) {
+    return arma::normalise(arma::randn< arma::Col<double> >(N));
+}
+
+// Orthonormal filter with N coefficients, from random lattice angles.
+arma::Col<double> orthonormalFilter (const unsigned& N) {
+    return wavenet::LatticeFilter(arma::randu< arma::Col<double> >(N / 2 - 1) * 2 * arma::datum::pi);
+}
+
+// Gradient of the errors Delta on the wavelet coefficients of X, using a plan
+// in the given mode.
+arma::Col<double> planGradient (const wavenet::TransformPlan::Mode& mode, const arma::Col<double>& filter,
+                                const arma::Mat<double>& X, const arma::Mat<double>& Delta, bool& reconstructs) {
+    wavenet::TransformPlan plan ({(unsigned) X.n_rows, (unsigned) X.n_cols}, filter.n_elem, mode);
+    arma::Mat<double> Y;
+    arma::Col<double> gradient;
+    CHECK(plan.setFilter(filter));
+    CHECK(plan.forward(X, Y));
+    CHECK(plan.backward(Y, Delta, gradient));
+    reconstructs = plan.reconstructs();
+    return gradient;
+}
+
+// Frobenius norm of the difference between two matrices, relative to the
+// norm of the second.
+double relativeDifference (const arma::Mat<double>& A, const arma::Mat<double>& B) {
+    return arma::norm(A - B, "fro") / std::max(arma::norm(B, "fro"), 1.0e-300);
+}
+
+// Wavelet coefficients of X using the reference transform: 1D if X has a
+// single column, 2D otherwise.
+arma::Mat<double> referenceForward (ReferenceWavenet& wn, const arma::Mat<double>& X) {
+    if (X.n_cols == 1) {
+        const arma::Col<double> x = X.col(0);
+        return wavenet::coeffsFromActivations(wn.forward_(x));
+    }
+    return wavenet::coeffsFromActivations(wn.forward_(X));
+}
+
+// Position space input from the wavelet coefficients Y using the reference
+// transform.
+arma::Mat<double> referenceInverse (ReferenceWavenet& wn, const arma::Mat<double>& Y) {
+    if (Y.n_cols == 1) {
+        const arma::Col<double> y = Y.col(0);
+        return wn.inverse_(y);
+    }
+    return wn.inverse_(Y);
+}
+
+// Gradient on the filter coefficients of the errors Delta on the wavelet
+// coefficients of X using the reference backpropagation.
+arma::Col<double> referenceBackward (ReferenceWavenet& wn, const arma::Mat<double>& X, const arma::Mat<double>& Delta) {
+    if (X.n_cols == 1) {
+        const arma::Col<double> x = X.col(0), delta = Delta.col(0);
+        return wn.backpropagate_(delta, wn.forward_(x)).at(0);
+    }
+    return wn.backpropagate_(Delta, wn.forward_(X));
+}
+
+// Sparsity term of the wavelet coefficients of X, with the given filter.
+double sparsity (wavenet::TransformPlan& plan, const arma::Col<double>& filter, const arma::Mat<double>& X) {
+    arma::Mat<double> Y;
+    plan.setFilter(filter);
+    plan.forward(X, Y);
+    return wavenet::SparseTerm(Y);
+}
+
+
+// The forward and inverse transforms of the plan equal those using the matrix
+// operators.
+void planMatchesReference () {
+    arma::arma_rng::set_seed(1);
+    for (const std::vector<unsigned>& shape : s_shapes) {
+        for (unsigned N : s_lengths) {
+            const arma::Col<double> filter = randomFilter(N);
+            const arma::Mat<double> X = randomInput(shape);
+            ReferenceWavenet wn (filter);
+            wavenet::TransformPlan plan (shape, N, wavenet::TransformPlan::Mode::Transform);
+            arma::Mat<double> Y, Xinv;
+            CHECK(plan.setFilter(filter));
+            if (!CHECK(plan.forward(X, Y))) { continue; }
+            CHECK_CLOSE(relativeDifference(Y, referenceForward(wn, X)), 0., 1.0e-12);
+            if (!CHECK(plan.inverse(Y, Xinv))) { continue; }
+            CHECK_CLOSE(relativeDifference(Xinv, referenceInverse(wn, Y)), 0., 1.0e-12);
+        }
+    }
+    return;
+}
+TEST(planMatchesReference);
+
+
+// The backward pass of the plan yields the gradient of the reference
+// backpropagation, for arbitrary errors on the wavelet coefficients.
+void backwardMatchesReference () {
+    arma::arma_rng::set_seed(2);
+    for (const std::vector<unsigned>& shape : s_shapes) {
+        for (unsigned N : s_lengths) {
+            const arma::Col<double> filter = randomFilter(N);
+            const arma::Mat<double> X = randomInput(shape);
+            const arma::Mat<double> Delta = randomInput(shape);
+            ReferenceWavenet wn (filter);
+            wavenet::TransformPlan plan (shape, N, wavenet::TransformPlan::Mode::Train);
+            arma::Mat<double> Y;
+            arma::Col<double> gradient;
+            CHECK(plan.setFilter(filter));
+            CHECK(plan.forward(X, Y));
+            if (!CHECK(plan.backward(Delta, gradient))) { continue; }
+            CHECK_CLOSE(relativeDifference(gradient, referenceBackward(wn, X, Delta)), 0., 1.0e-12);
+        }
+    }
+    return;
+}
+TEST(backwardMatchesReference);
+
+
+// Backpropagating the gradient of the sparsity term on the wavelet
+// coefficients yields the gradient of the sparsity term on the filter
+// coefficients. Random input is away from the kinks of the sparsity term,
+// i.e. coefficients of equal magnitude, or zero.
+void gradientMatchesDifferences () {
+    arma::arma_rng::set_seed(3);
+    const double epsilon = 1.0e-6;
+    for (const std::vector<unsigned>& shape : s_shapes) {
+        for (unsigned N : s_lengths) {
+            const arma::Col<double> filter = randomFilter(N);
+            const arma::Mat<double> X = randomInput(shape);
+            wavenet::TransformPlan plan (shape, N, wavenet::TransformPlan::Mode::Train);
+            arma::Mat<double> Y;
+            arma::Col<double> gradient;
+            CHECK(plan.setFilter(filter));
+            CHECK(plan.forward(X, Y));
+            if (!CHECK(plan.backward(wavenet::SparseTermDeriv(Y), gradient))) { continue; }
+
+            arma::Col<double> difference (N), step (N, arma::fill::zeros);
+            for (unsigned k = 0; k < N; k++) {
+                step(k) = epsilon;
+                difference(k) = (sparsity(plan, filter + step, X) - sparsity(plan, filter - step, X)) / (2. * epsilon);
+                step(k) = 0;
+            }
+            CHECK_CLOSE(arma::norm(gradient - difference), 0., 1.0e-6 * std::max(arma::norm(difference), 1.));
+        }
+    }
+    return;
+}
+TEST(gradientMatchesDifferences);
+
+
+// The gradient doesn't depend on the checkpoint interval: storing only the
+// input (0), all levels (1), every other level (2), or only the input to each
+// row and column transform (>= log2 of the larger axis, here 5). The memory
+// used for the activations shrinks as the interval grows up to log2, and is
+// smallest when storing only the input.
+void checkpointIntervals () {
+    arma::arma_rng::set_seed(4);
+    const std::vector<unsigned> shape = {16, 32};
+    const std::vector<unsigned> intervals = {1, 2, 5, 8, 0};
+    for (unsigned N : {2u, 6u, 20u}) {
+        const arma::Col<double> filter = randomFilter(N);
+        const arma::Mat<double> X = randomInput(shape);
+        const arma::Mat<double> Delta = randomInput(shape);
+        arma::Col<double> reference;
+        unsigned long long previousBytes = 0;
+        for (unsigned k : intervals) {
+            wavenet::TransformPlan plan (shape, N, wavenet::TransformPlan::Mode::Train, k);
+            arma::Mat<double> Y;
+            arma::Col<double> gradient;
+            CHECK(plan.setFilter(filter));
+            CHECK(plan.forward(X, Y));
+            if (!CHECK(plan.backward(Delta, gradient))) { continue; }
+            if (k == intervals.front()) {
+                reference = gradient;
+            } else {
+                CHECK_CLOSE(relativeDifference(gradient, reference), 0., 1.0e-13);
+                if (k == 8) {
+                    CHECK(plan.activationBytes() == previousBytes);
+                } else {
+                    CHECK(plan.activationBytes() < previousBytes);
+                }
+            }
+            previousBytes = plan.activationBytes();
+        }
+    }
+    return;
+}
+TEST(checkpointIntervals);
+
+
+// With an orthonormal filter, the activations reconstructed from the wavelet
+// coefficients in 'Invertible' mode yield the gradient using the stored
+// activations, up to the reconstruction error.
+void invertibleMatchesStored () {
+    arma::arma_rng::set_seed(5);
+    for (const std::vector<unsigned>& shape : s_shapes) {
+        for (unsigned N : s_lengths) {
+            const arma::Col<double> filter = orthonormalFilter(N);
+            const arma::Mat<double> X = randomInput(shape);
+            const arma::Mat<double> Delta = randomInput(shape);
+            bool reconstructs = false;
+            const arma::Col<double> stored = planGradient(wavenet::TransformPlan::Mode::Train, filter, X, Delta, reconstructs);
+            const arma::Col<double> reconstructed = planGradient(wavenet::TransformPlan::Mode::Invertible, filter, X, Delta, reconstructs);
+            CHECK(reconstructs);
+            CHECK_CLOSE(relativeDifference(reconstructed, stored), 0., 1.0e-10);
+        }
+    }
+    return;
+}
+TEST(invertibleMatchesStored);
+
+
+// With a filter which is not orthonormal, the reconstruction error exceeds the
+// tolerance, and 'Invertible' mode falls back to the stored activations,
+// yielding the correct gradient.
+void invertibleFallback () {
+    arma::arma_rng::set_seed(6);
+    for (const std::vector<unsigned>& shape : s_shapes) {
+        for (unsigned N : {2u, 6u, 20u}) {
+            const arma::Col<double> filter = 1.1 * orthonormalFilter(N);
+            const arma::Mat<double> X = randomInput(shape);
+            const arma::Mat<double> Delta = randomInput(shape);
+            wavenet::TransformPlan plan (shape, N, wavenet::TransformPlan::Mode::Invertible);
+            CHECK(plan.setFilter(filter));
+            CHECK(plan.drift() > plan.tolerance());
+            bool reconstructs = true;
+            const arma::Col<double> fallback = planGradient(wavenet::TransformPlan::Mode::Invertible, filter, X, Delta, reconstructs);
+            CHECK(!reconstructs);
+            ReferenceWavenet wn (filter);
+            CHECK_CLOSE(relativeDifference(fallback, referenceBackward(wn, X, Delta)), 0., 1.0e-12);
+        }
+    }
+    return;
+}
+TEST(invertibleFallback);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file   Utilities.cxx
+ * @brief  Correctness tests of the filter symmetries used for deduplication.
+ */
+
+// STL include(s).
+#include <vector> /* std::vector */
+#include <cmath> /* std::sqrt, std::abs */
+
+// Armadillo include(s).
+#include <armadillo>
+
+// Wavenet include(s).
+#include "Wavenet/Utilities.h" /* wavenet::CanonicalFilter, wavenet::FilterDistance */
+#include "Wavenet/Lattice.h" /* wavenet::LatticeFilter */
+
+// Test include(s).
+#include "Test.h"
+
+
+// Orthonormal filter with N coefficients, from random lattice angles.
+arma::Col<double> orthonormalFilter (const unsigned& N) {
+    return wavenet::LatticeFilter(arma::randu< arma::Col<double> >(N / 2 - 1) * 2 * arma::datum::pi);
+}
+
+// Whether the filter coefficients sum to \pm\sqrt{2}, and are orthonormal to
+// their even shifts.
+bool orthonormal (const arma::Col<double>& filter) {
+    const unsigned N = filter.n_elem;
+    if (std::abs(std::abs(arma::accu(filter)) - std::sqrt(2.)) > 1.0e-12) { return false; }
+    for (unsigned m = 0; m < N; m += 2) {
+        double product = 0;
+        for (unsigned k = 0; k + m < N; k++) {
+            product += filter(k) * filter(k + m);
+        }
+        if (std::abs(product - (m == 0 ? 1. : 0.)) > 1.0e-12) { return false; }
+    }
+    return true;
+}
+
+// Sign flips and time reversal of a filter.
+std::vector< arma::Col<double> > variants (const arma::Col<double>& filter) {
+    return {filter, -filter, arma::flipud(filter), -arma::flipud(filter)};
+}
+
+
+// Every filter equivalent to a valid filter is itself valid, and has the same
+// canonical representative, at vanishing distance.
+void variantsAreOrthonormal () {
+    arma::arma_rng::set_seed(1);
+    for (unsigned N = 2; N <= 12; N += 2) {
+        for (unsigned i = 0; i < 10; i++) {
+            const arma::Col<double> filter = orthonormalFilter(N);
+            const arma::Col<double> canonical = wavenet::CanonicalFilter(filter);
+            CHECK(orthonormal(filter));
+            CHECK(orthonormal(canonical));
+            for (const arma::Col<double>& variant : variants(filter)) {
+                CHECK(orthonormal(variant));
+                CHECK_CLOSE(arma::norm(wavenet::CanonicalFilter(variant) - canonical), 0., 1.0e-12);
+                CHECK_CLOSE(wavenet::FilterDistance(variant, filter), 0., 1.0e-12);
+            }
+        }
+    }
+    return;
+}
+TEST(variantsAreOrthonormal);
+
+
+// Cyclic even shifts are not symmetries for N >= 6: e.g. the shifted
+// Daubechies-6 filter is not orthonormal, and is at finite distance.
+void cyclicShiftsAreDistinct () {
+    const double s = std::sqrt(10.), t = std::sqrt(5. + 2. * s);
+    const arma::Col<double> d6 = arma::Col<double>({1. + s + t, 5. + s + 3. * t, 10. - 2. * s + 2. * t,
+                                                    10. - 2. * s - 2. * t, 5. + s - 3. * t, 1. + s - t}) / (16. * std::sqrt(2.));
+    CHECK(orthonormal(d6));
+    const arma::Col<double> shifted = arma::Col<double>({d6(4), d6(5), d6(0), d6(1), d6(2), d6(3)});
+    CHECK(!orthonormal(shifted));
+    CHECK(wavenet::FilterDistance(shifted, d6) > 0.1);
+    return;
+}
+TEST(cyclicShiftsAreDistinct);
+
+
+// Main function.
+int main (int argc, char* argv[]) {
+    return test::main(argc, argv);
+}